@@ -29,9 +29,15 @@
  */
 
 #include "ns3/ccfs-controller.h"
+#include "ns3/ccfs-params-profile.h"
 #include "ns3/nada-controller.h"
+#include "ns3/nada-params-profile.h"
+#include "ns3/gcc-controller.h"
+#include "ns3/scream-controller.h"
+#include "ns3/remb-controller.h"
 #include "ns3/rmcat-sender.h"
 #include "ns3/rmcat-ccfs-receiver.h"
+#include "ns3/rmcat-remb-receiver.h"
 #include "ns3/rmcat-receiver.h"
 #include "ns3/rmcat-constants.h"
 #include "ns3/rmcat-utils.h"
@@ -69,7 +75,8 @@ using namespace ns3;
 
 static NodeContainer BuildExampleTopo (uint64_t bps,
                                        uint32_t msDelay,
-                                       uint32_t msQdelay)
+                                       uint32_t msQdelay,
+                                       const std::string& linkTrace)
 {
     NodeContainer nodes;
     nodes.Create (2);
@@ -96,6 +103,19 @@ static NodeContainer BuildExampleTopo (uint64_t bps,
     TrafficControlHelper tch;
     tch.Uninstall (devices);
 
+    if (!linkTrace.empty ()) {
+        // Forward capacity follows the delivery trace: the queue builds up
+        // in the trace-driven queue disc rather than in the device queue
+        devices.Get (0)->SetAttribute ("DataRate", DataRateValue (DataRate (1u << 30))); // 1 Gbps
+        auto queue = DynamicCast<PointToPointNetDevice> (devices.Get (0))->GetQueue ();
+        queue->SetAttribute ("Mode", StringValue ("QUEUE_MODE_PACKETS"));
+        queue->SetAttribute ("MaxPackets", UintegerValue (1));
+        tch.SetRootQueueDisc ("ns3::TraceLinkQueueDisc",
+                              "TraceFile", StringValue (linkTrace),
+                              "MaxBytes", UintegerValue (bufSize));
+        tch.Install (devices.Get (0));
+    }
+
     return nodes;
 }
 
@@ -164,6 +184,30 @@ static void InstallUDP (Ptr<Node> sender,
     serverApps.Stop (Seconds (stopTime));
 }
 
+static std::shared_ptr<rmcat::SenderBasedController>
+CreateNadaController (const std::string& profile)
+{
+    if (profile == "lowlatency") {
+        return std::make_shared<rmcat::NadaControllerT<rmcat::NadaLowLatencyParams> > ();
+    }
+    if (profile == "throughput") {
+        return std::make_shared<rmcat::NadaControllerT<rmcat::NadaHighThroughputParams> > ();
+    }
+    if (profile == "wireless") {
+        return std::make_shared<rmcat::NadaControllerT<rmcat::NadaWirelessParams> > ();
+    }
+    if (profile == "runtime") {
+        // Tuned with --ns3::NadaParamsProfile::<Param>=<value>
+        auto nada = std::make_shared<rmcat::NadaControllerT<rmcat::NadaRuntimeParams> > ();
+        nada->setParams (CreateObject<NadaParamsProfile> ()->GetParams ());
+        return nada;
+    }
+    if (profile != "default") {
+        NS_FATAL_ERROR ("Unknown NADA profile: " << profile);
+    }
+    return std::make_shared<rmcat::NadaController> ();
+}
+
 static void InstallApps (std::string algo,
                          Ptr<Node> sender,
                          Ptr<Node> receiver,
@@ -173,7 +217,10 @@ static void InstallApps (std::string algo,
                          float maxBw,
                          float startTime,
                          float stopTime,
-                         uint32_t topoBw)
+                         uint32_t topoBw,
+                         const std::string& capture,
+                         const std::string& nadaProfile,
+                         bool traceCodec)
 {
     Ptr<RmcatSender> sendApp = CreateObject<RmcatSender> ();
     Ptr<RmcatReceiver> recvApp = NULL;
@@ -182,6 +229,9 @@ static void InstallApps (std::string algo,
       recvApp = CreateObject<RmcatCcfsReceiver> ();
       sendApp->SetControllerName(algo);
     }
+    else if (algo == "remb") {
+      recvApp = CreateObject<RmcatRembReceiver> ();
+    }
     else {
       recvApp = CreateObject<RmcatReceiver> ();
     }
@@ -190,12 +240,25 @@ static void InstallApps (std::string algo,
     receiver->AddApplication (recvApp);
 
     if (algo == "nada") {
-        sendApp->SetController (std::make_shared<rmcat::NadaController> ());
+        sendApp->SetController (CreateNadaController (nadaProfile));
+    }
+    else if (algo == "gcc") {
+        sendApp->SetController (std::make_shared<rmcat::GccController> ());
+    }
+    else if (algo == "scream") {
+        sendApp->SetController (std::make_shared<rmcat::ScreamController> ());
+    }
+    else if (algo == "remb") {
+        // Receiver-side estimation, which needs abs-send-time
+        sendApp->SetController (std::make_shared<rmcat::RembController> ());
+        sendApp->SetHeaderExtensionsEnabled (true);
     }
     else if(algo == "ccfs") {
         std::shared_ptr<rmcat::CcfsController> ccfs = std::make_shared<rmcat::CcfsController> ();
         sendApp->SetController (ccfs);
 
+        // Tuned with --ns3::CcfsParamsProfile::<Param>=<value>
+        ccfs->setParams( CreateObject<CcfsParamsProfile> ()->GetParams () );
         ccfs->setNetworkAttributes( topoBw );
 
         PointerValue ptrValue;
@@ -222,10 +285,20 @@ static void InstallApps (std::string algo,
     sendApp->SetRmin(minBw);
     sendApp->SetRmax(maxBw);
 
-    const auto fps = 25.;
-    auto innerCodec = new syncodecs::StatisticsCodec{fps};
-    auto codec = new syncodecs::ShapedPacketizer{innerCodec, DEFAULT_PACKET_SIZE};
-    sendApp->SetCodec (std::shared_ptr<syncodecs::Codec>{codec});
+    if (!capture.empty ()) {
+        std::ostringstream os;
+        os << capture << "-" << port << ".trace";
+        sendApp->EnableCapture (os.str ());
+    }
+
+    if (traceCodec) {
+        sendApp->SetCodecType (SYNCODEC_TYPE_TRACE);
+    } else {
+        const auto fps = 25.;
+        auto innerCodec = new syncodecs::StatisticsCodec{fps};
+        auto codec = new syncodecs::ShapedPacketizer{innerCodec, DEFAULT_PACKET_SIZE};
+        sendApp->SetCodec (std::shared_ptr<syncodecs::Codec>{codec});
+    }
 
     recvApp->Setup (port);
 
@@ -245,17 +318,29 @@ int main (int argc, char *argv[])
     std::string strArg  = "strArg default";
     uint32_t topoBwKbps = (TOPO_DEFAULT_BW / 1000);
     std::string algo = "ccfs";
+    std::string capture = "";
+    std::string nadaProfile = "default";
+    std::string linkTrace = "";
+    std::string traceDir = "";
 
 
     CommandLine cmd;
-    cmd.AddValue ("rmcat", "Number of RMCAT (NADA/CCFS) flows", nRmcat);
+    cmd.AddValue ("rmcat", "Number of RMCAT (NADA/GCC/SCReAM/CCFS/REMB) flows", nRmcat);
     cmd.AddValue ("tcp", "Number of TCP flows", nTcp);
     cmd.AddValue ("udp", "Number of UDP flows", nUdp);
     cmd.AddValue ("log", "Turn on logs", log);
-    cmd.AddValue ("algo", "Algorithm", algo);
+    cmd.AddValue ("algo", "Algorithm: nada, gcc, scream, ccfs or remb", algo);
     cmd.AddValue ("kbps", "Throughput", topoBwKbps);
+    cmd.AddValue ("nadaProfile", "NADA parameters: default, lowlatency, throughput, wireless or runtime", nadaProfile);
+    cmd.AddValue ("linkTrace", "Mahimahi delivery trace driving the forward link (kbps then only sizes the queue)", linkTrace);
+    cmd.AddValue ("capture", "Capture controller input of RMCAT flows to <capture>-<port>.trace", capture);
+    cmd.AddValue ("traceDir", "Directory of the video traces; RMCAT flows then use the trace-based codec", traceDir);
     cmd.Parse (argc, argv);
 
+    if (!traceDir.empty ()) {
+        RmcatSender::SetTraceDirectory (traceDir);
+    }
+
     if (log) {
         /// LogComponentEnable ("RmcatSender", LOG_INFO);
         /// LogComponentEnable ("RmcatReceiver", LOG_INFO);
@@ -277,7 +362,7 @@ int main (int argc, char *argv[])
 
     const float endTime = RMCAT_SIM_ENDTIME;
 
-    NodeContainer nodes = BuildExampleTopo (linkBw, msDelay, msQDelay);
+    NodeContainer nodes = BuildExampleTopo (linkBw, msDelay, msQDelay, linkTrace);
 
 
     int port = 8000;
@@ -285,7 +370,8 @@ int main (int argc, char *argv[])
         auto start = RMCAT_SIM_START_APP * i;
         auto end = std::max (start + 1., endTime - start);
         InstallApps (algo, nodes.Get (0), nodes.Get (1), port++,
-                     initBw, minBw, maxBw, start, end, linkBw);
+                     initBw, minBw, maxBw, start, end, linkBw, capture, nadaProfile,
+                     !traceDir.empty ());
     }
 
     for (size_t i = 0; i < nTcp; i++) {
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+/**
+ * @file
+ * Headless replay of recorded controller input against a congestion
+ * controller. The trace is fed directly into the controller, without
+ * building any topology nor running the simulator, and the resulting
+ * bandwidth decisions are printed to stdout, one line per feedback batch:
+ *
+ *    <feedback time in us> <bandwidth in bps>
+ *
+ * Traces can be either captured by RmcatSender or written by hand (see
+ * rmcat::ControllerTraceReader for the accepted formats).
+ *
+ * Example:
+ *    ./waf --run "rmcat-replay --trace=flow0.trace --algo=nada"
+ *
+ * @version 0.1.1
+ */
+
+#include "ns3/controller-trace.h"
+#include "ns3/dummy-controller.h"
+#include "ns3/nada-controller.h"
+#include "ns3/gcc-controller.h"
+#include "ns3/scream-controller.h"
+#include "ns3/ccfs-controller.h"
+#include "ns3/ccfs-params-profile.h"
+#include "ns3/rfb-header.h"
+#include "ns3/rmcat-constants.h"
+#include "ns3/core-module.h"
+
+#include <memory>
+#include <vector>
+#include <iostream>
+
+using namespace ns3;
+
+const uint32_t REPLAY_CCFS_SSRC = 1;    // traces carry a single flow
+
+static void LogFromController (const std::string& msg)
+{
+    std::cerr << "controller_log: " << msg << std::endl;
+}
+
+static void DiscardControllerLog (const std::string& msg) {}
+
+static bool ReplaySend (const std::string& algo,
+                        rmcat::SenderBasedController& controller,
+                        const rmcat::TraceRecord& record)
+{
+    if (algo == "ccfs") {
+        auto& ccfs = static_cast<rmcat::CcfsController&> (controller);
+        return ccfs.processSendPacket2 (REPLAY_CCFS_SSRC, record.timeUs,
+                                        record.sequence, record.size);
+    }
+    return controller.processSendPacket (record.timeUs, record.sequence, record.size);
+}
+
+static bool ReplayFeedback (const std::string& algo,
+                            rmcat::SenderBasedController& controller,
+                            uint64_t nowUs,
+                            uint64_t lastNowUs,
+                            const std::vector<rmcat::SenderBasedController::FeedbackItem>& batch)
+{
+    if (algo == "ccfs") {
+        // CCFS expects the feedback packet itself: rebuild it. The report
+        // time is not part of the trace, so the latest receive timestamp
+        // is taken instead
+        RfbHeader header{};
+        uint64_t reportMs = 0;
+        for (const auto& item : batch) {
+            const uint64_t rxMs = item.rxTimestampUs / 1000;
+            header.AddFeedback (REPLAY_CCFS_SSRC, item.sequence, rxMs, item.ecn);
+            reportMs = std::max (reportMs, rxMs);
+        }
+        const uint64_t periodUs = (lastNowUs == 0) ? RMCAT_FEEDBACK_PERIOD_US :
+                                                     nowUs - lastNowUs;
+        header.SetReportTime (reportMs);
+        header.SetMonitoredTime (uint16_t (std::max<uint64_t> (1, periodUs / 1000)));
+        auto& ccfs = static_cast<rmcat::CcfsController&> (controller);
+        return ccfs.processFeedback2 (nowUs, header);
+    }
+    return controller.processFeedbackBatch (nowUs, batch);
+}
+
+int main (int argc, char *argv[])
+{
+    std::string tracePath = "";
+    std::string algo = "nada";
+    float initBw = 150000.;
+    float minBw = 150000.;
+    float maxBw = 1500000.;
+    uint32_t netBw = 0;
+    bool log = false;
+
+    CommandLine cmd;
+    cmd.AddValue ("trace", "Controller trace to replay", tracePath);
+    cmd.AddValue ("algo", "Controller: nada, gcc, scream, ccfs or dummy", algo);
+    cmd.AddValue ("rinit", "Initial bandwidth (bps)", initBw);
+    cmd.AddValue ("rmin", "Minimum bandwidth (bps)", minBw);
+    cmd.AddValue ("rmax", "Maximum bandwidth (bps)", maxBw);
+    cmd.AddValue ("netbw", "Bottleneck bandwidth given to CCFS (bps)", netBw);
+    cmd.AddValue ("log", "Print controller logs to stderr", log);
+    cmd.Parse (argc, argv);
+
+    std::shared_ptr<rmcat::SenderBasedController> controller;
+    if (algo == "nada") {
+        controller = std::make_shared<rmcat::NadaController> ();
+    } else if (algo == "gcc") {
+        controller = std::make_shared<rmcat::GccController> ();
+    } else if (algo == "scream") {
+        controller = std::make_shared<rmcat::ScreamController> ();
+    } else if (algo == "ccfs") {
+        auto ccfs = std::make_shared<rmcat::CcfsController> ();
+        ccfs->setParams (CreateObject<CcfsParamsProfile> ()->GetParams ());
+        ccfs->setNetworkAttributes (netBw);
+        controller = ccfs;
+    } else if (algo == "dummy") {
+        controller = std::make_shared<rmcat::DummyController> ();
+    } else {
+        std::cerr << "Unknown controller: " << algo << std::endl;
+        return 1;
+    }
+
+    controller->setInitBw (initBw);
+    controller->setMinBw (minBw);
+    controller->setMaxBw (maxBw);
+    controller->setId ("replay");
+    controller->setLogCallback (log ? &LogFromController : &DiscardControllerLog);
+
+    rmcat::ControllerTraceReader reader;
+    if (!reader.open (tracePath)) {
+        std::cerr << "Error: " << reader.getError () << std::endl;
+        return 1;
+    }
+
+    std::vector<rmcat::SenderBasedController::FeedbackItem> batch{};
+    uint64_t batchUs = 0;
+    uint64_t lastBatchUs = 0;
+    uint64_t nSent = 0;
+    uint64_t nBatches = 0;
+
+    // Feedback items of the same batch are consecutive and share the time
+    // at which they were processed. Flush them as soon as the batch ends
+    auto flushBatch = [&] () {
+        if (batch.empty ()) {
+            return;
+        }
+        if (!ReplayFeedback (algo, *controller, batchUs, lastBatchUs, batch)) {
+            std::cerr << "Warning: feedback batch at " << batchUs
+                      << " us rejected by controller" << std::endl;
+        }
+        std::cout << batchUs << " " << controller->getBandwidth (batchUs) << std::endl;
+        lastBatchUs = batchUs;
+        batch.clear ();
+        ++nBatches;
+    };
+
+    rmcat::TraceRecord record;
+    while (reader.next (record)) {
+        if (record.type == rmcat::TraceRecord::TRACE_RECORD_FEEDBACK) {
+            if (!batch.empty () && record.timeUs != batchUs) {
+                flushBatch ();
+            }
+            batchUs = record.timeUs;
+            const rmcat::SenderBasedController::FeedbackItem item{
+                .sequence = record.sequence,
+                .rxTimestampUs = record.rxTimestampUs,
+                .ecn = record.ecn
+            };
+            batch.push_back (item);
+            continue;
+        }
+
+        flushBatch ();
+        if (!ReplaySend (algo, *controller, record)) {
+            std::cerr << "Warning: send record with sequence " << record.sequence
+                      << " rejected by controller" << std::endl;
+        }
+        ++nSent;
+    }
+    flushBatch ();
+
+    if (!reader.getError ().empty ()) {
+        std::cerr << "Error: " << reader.getError () << std::endl;
+        return 1;
+    }
+
+    std::cerr << "Replayed " << nSent << " sent packets and "
+              << nBatches << " feedback batches" << std::endl;
+    return 0;
+}
@@ -35,6 +35,7 @@ NS_LOG_COMPONENT_DEFINE ("RmcatCcfsReceiver");
 namespace ns3 {
 RmcatCcfsReceiver::RmcatCcfsReceiver ()
   : m_fbPeriodMs(100)
+  , m_curFbPeriodMs(100)
   , m_fbEvent{}
   , m_fbHeader{}
   , m_refPointUs(0)
@@ -50,7 +51,10 @@ void RmcatCcfsReceiver::StartApplication ()
             << m_fbPeriodMs );
 
     RmcatReceiver::StartApplication();
-
+    // Feedback is sent in RFB messages by FbTimerHandler, which starts upon
+    // the first packet. The base class's timer would only cut the feedback
+    // budget's measurement short
+    Simulator::Cancel (m_sendEvent);
 }
 
 void RmcatCcfsReceiver::StopApplication ()
@@ -70,7 +74,9 @@ void RmcatCcfsReceiver::RecvPacket (Ptr<Socket> socket)
 
     if(m_refPointUs == 0) {
         m_refPointUs = Simulator::Now ().GetMicroSeconds ();
-        m_fbEvent = Simulator::Schedule(MilliSeconds(m_fbPeriodMs), &RmcatCcfsReceiver::FbTimerHandler, this);
+        m_curFbPeriodMs = m_fbPeriodMs;
+        m_fbRateStartUs = m_refPointUs;
+        m_fbEvent = Simulator::Schedule(MilliSeconds(m_curFbPeriodMs), &RmcatCcfsReceiver::FbTimerHandler, this);
         NS_LOG_INFO("SyncTime for RX:localTimestampUs=" << m_refPointUs);
     }
 
@@ -79,6 +85,8 @@ void RmcatCcfsReceiver::RecvPacket (Ptr<Socket> socket)
 
     RtpHeader header{};
     packet->RemoveHeader(header);
+    const auto ecn = GetEcn (packet);
+    AccountFeedbackRate (packet->GetSize () + header.GetSerializedSize ());
 
     if (m_waiting) {
         m_waiting = false;
@@ -97,7 +105,8 @@ void RmcatCcfsReceiver::RecvPacket (Ptr<Socket> socket)
     auto recvTimestampMs = GetCurrElapsedTimeMs(); 
     auto res = m_fbHeader.AddFeedback (m_remoteSsrc, 
                                         header.GetSequence(), 
-                                        recvTimestampMs);
+                                        recvTimestampMs,
+                                        ecn);
 
     auto countEndseq = m_fbHeader.GetCountEndSeq(m_remoteSsrc);
 
@@ -122,17 +131,23 @@ void RmcatCcfsReceiver::FbTimerHandler()
 
     m_fbHeader.IncreaseFbSeq();
     m_fbHeader.SetReportTime( GetCurrElapsedTimeMs() );
-    m_fbHeader.SetMonitoredTime( uint16_t(m_fbPeriodMs) );
+    m_fbHeader.SetMonitoredTime( uint16_t(m_curFbPeriodMs) );
 
     m_fbHeader.Print(ss);
 
-    NS_LOG_INFO("FB period(ms)="<< m_fbPeriodMs << "\n" << ss.rdbuf() );
+    NS_LOG_INFO("FB period(ms)="<< m_curFbPeriodMs << "\n" << ss.rdbuf() );
 
     auto packet = Create<Packet> ();
     packet->AddHeader(m_fbHeader);
     m_socket->SendTo(packet, 0, InetSocketAddress{m_srcIp, m_srcPort});
 
-    m_fbEvent = Simulator::Schedule(MilliSeconds(m_fbPeriodMs), &RmcatCcfsReceiver::FbTimerHandler, this);
+    // Fixed period, unless a feedback budget is set (see SetFeedbackBudget)
+    const uint64_t periodUs = GetFeedbackPeriodUs (Simulator::Now ().GetMicroSeconds (),
+                                                   uint64_t (m_fbPeriodMs) * 1000,
+                                                   RMCAT_RFB_OVERHEAD_SIZE,
+                                                   RMCAT_FB_METRIC_SIZE);
+    m_curFbPeriodMs = uint32_t (periodUs / 1000);
+    m_fbEvent = Simulator::Schedule(MilliSeconds(m_curFbPeriodMs), &RmcatCcfsReceiver::FbTimerHandler, this);
     m_fbHeader.CleanReportBlocks();
 }
 
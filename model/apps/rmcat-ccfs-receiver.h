@@ -51,6 +51,7 @@ private:
 
 private:
     uint32_t    m_fbPeriodMs;
+    uint32_t    m_curFbPeriodMs;  /**< period of the feedback being built */
     EventId     m_fbEvent;
     RfbHeader   m_fbHeader;
     uint64_t    m_refPointUs;
@@ -36,6 +36,70 @@ const uint32_t IPV4_HEADER_SIZE = 20;
 const uint32_t UDP_HEADER_SIZE = 8;
 const uint32_t IPV4_UDP_OVERHEAD = IPV4_HEADER_SIZE + UDP_HEADER_SIZE;
 const uint64_t RMCAT_FEEDBACK_PERIOD_US = 100 * 1000;
+// adaptive feedback period (see RmcatReceiver::SetFeedbackBudget): bounds
+const uint64_t RMCAT_FEEDBACK_MIN_PERIOD_US = 20 * 1000;
+const uint64_t RMCAT_FEEDBACK_MAX_PERIOD_US = 250 * 1000;
+// size of a feedback message with a single report block, including IP/UDP
+// headers, plus the size of each packet's metric block
+const uint32_t RMCAT_CCFB_OVERHEAD_SIZE = 48;
+const uint32_t RMCAT_RFB_OVERHEAD_SIZE = 56;
+const uint32_t RMCAT_FB_METRIC_SIZE = 2;
+// retry period while a window-based controller holds packets back
+const uint64_t RMCAT_WINDOW_RETRY_US = 5 * 1000;
+// IP TOS byte of rmcat media packets: ECT(1), i.e., L4S-capable (RFC 9331)
+const uint8_t RMCAT_IP_TOS = 0x01;
+const uint8_t IP_TOS_ECN_MASK = 0x03;
+
+// NACK-based retransmission (RFC 4585, RFC 4588)
+const uint8_t RMCAT_RTX_PAYLOAD_TYPE = 97;  // dynamic payload type of retransmissions
+const uint32_t RMCAT_RTX_OSN_SIZE = 2;      // original sequence number, in front of the payload
+const uint64_t RMCAT_NACK_PERIOD_US = 20 * 1000;   // receiver's NACK timer
+// the receiver has no RTT estimate: wait this long before NACKing a packet again
+const uint64_t RMCAT_NACK_RESEND_US = 100 * 1000;
+const uint32_t RMCAT_NACK_MAX_RETRIES = 10;
+const uint32_t RMCAT_NACK_MAX_LIST_SIZE = 1000;    // missing packets tracked at most
+// retransmission cache: packets are kept this many RTTs, and at least RMCAT_RTX_MIN_HISTORY_US
+const uint32_t RMCAT_RTX_HISTORY_RTTS = 3;
+const uint64_t RMCAT_RTX_MIN_HISTORY_US = 200 * 1000;
+
+// a media packet neither received nor recovered by then counts as lost
+const uint64_t RMCAT_RESIDUAL_LOSS_DELAY_US = 2000 * 1000;
+
+// Forward error correction: XOR parity over groups of media packets,
+// along the lines of FlexFEC (RFC 8627)
+const uint8_t RMCAT_FEC_PAYLOAD_TYPE = 98;  // dynamic payload type of parity packets
+const uint32_t RMCAT_FEC_HEADER_SIZE = 8;   // SN base, length recovery, 32-bit mask
+const uint32_t RMCAT_FEC_MASK_BITS = 32;
+const uint32_t RMCAT_FEC_MIN_GROUP = 2;     // media packets per parity packet
+const uint32_t RMCAT_FEC_MAX_GROUP = 16;
+// adaptive protection: one parity packet per 1 / (factor * loss rate) media
+// packets, none below the minimum loss rate
+const float RMCAT_FEC_LOSS_FACTOR = 2.f;
+const float RMCAT_FEC_MIN_LOSS = 0.005f;
+// the receiver keeps media and parity packets this long for recovery
+const uint64_t RMCAT_FEC_RECOVERY_WINDOW_US = 1000 * 1000;
+
+// Bandwidth probing: probe clusters carry retransmissions of recent media
+// packets if available, or else padding-only packets (RFC 3550), whose
+// padding length must fit in one octet
+const uint32_t RMCAT_PROBE_PADDING_SIZE = 255;
+
+// Layered sources: a dropped layer comes back once the rate left for it
+// exceeds its minimum rate by this factor, to avoid flapping
+const float RMCAT_LAYER_ON_FACTOR = 1.1f;
+
+// Receiver-side estimation (REMB): the receiver runs GCC's delay-based
+// estimator, and sends its estimate periodically, and right away when it
+// drops below the last one sent by the given ratio
+const uint64_t RMCAT_REMB_PERIOD_US = 1000 * 1000;
+const float RMCAT_REMB_DECREASE_RATIO = 0.97f;
+const uint64_t RMCAT_REMB_UPDATE_US = 100 * 1000;  // estimate update period, unless overusing
+const uint64_t RMCAT_REMB_INIT_US = 500 * 1000;    // incoming rate measured before the first estimate
+const int64_t RMCAT_REMB_RATE_WINDOW_MS = 1000;    // incoming rate averaging window
+// the receiver has no RTT estimate: AIMD assumes this one
+const uint64_t RMCAT_REMB_DEFAULT_RTT_US = 200 * 1000;
+const float RMCAT_REMB_MIN_BPS = 10000.f;          // the sender applies its own bounds
+const float RMCAT_REMB_MAX_BPS = 100e6f;
 
 // syncodec parameters
 const uint32_t SYNCODEC_DEFAULT_FPS = 30;
@@ -65,6 +129,15 @@ const uint32_t MAX_QUEUE_SIZE_SANITY = 80 * 1000 * 1000; //bytes
 const uint32_t T_MAX_S = 500;  // maximum simulation duration  in seconds
 const double T_TCP_LOG = 2;  // sample interval for log TCP flows
 
+/* queue types at the bottleneck of the wired topology */
+enum BottleneckQueueType {
+    BOTTLENECK_QUEUE_DROPTAIL = 0,
+    BOTTLENECK_QUEUE_ECN_STEP,
+    BOTTLENECK_QUEUE_CODEL,
+    BOTTLENECK_QUEUE_FQCODEL,
+    BOTTLENECK_QUEUE_PIE
+};
+
 /* Default topology setting parameters */
 const uint32_t WIFI_TOPO_MACQUEUE_MAXNPKTS = 1000;
 const uint32_t WIFI_TOPO_ARPCACHE_ALIVE_TIMEOUT = 24 * 60 * 60; // 24 hours
@@ -31,6 +31,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("RmcatReceiver");
 
@@ -46,6 +47,27 @@ RmcatReceiver::RmcatReceiver ()
 , m_header{}
 , m_sendEvent{}
 , m_periodUs{RMCAT_FEEDBACK_PERIOD_US}
+, m_fbRateFraction{0.}
+, m_fbMinPeriodUs{RMCAT_FEEDBACK_MIN_PERIOD_US}
+, m_fbMaxPeriodUs{RMCAT_FEEDBACK_MAX_PERIOD_US}
+, m_fbRateStartUs{0}
+, m_fbRateBytes{0}
+, m_fbRatePackets{0}
+, m_nackEnabled{false}
+, m_highestSeqValid{false}
+, m_highestSeq{0}
+, m_nackList{}
+, m_nackEvent{}
+, m_fecMedia{}
+, m_fecMediaOrder{}
+, m_fecParities{}
+, m_fecRecovered{0}
+, m_highestIndexValid{false}
+, m_highestIndex{0}
+, m_missingMedia{}
+, m_missingOrder{}
+, m_mediaExpected{0}
+, m_mediaLost{0}
 {
   NS_LOG_FUNCTION(this);
 }
@@ -59,6 +81,8 @@ void RmcatReceiver::Setup (uint16_t port)
     auto local = InetSocketAddress{Ipv4Address::GetAny (), port};
     auto ret = m_socket->Bind (local);
     NS_ASSERT (ret == 0);
+    // Needed to report the ECN codepoint of each media packet
+    m_socket->SetIpRecvTos (true);
     m_socket->SetRecvCallback (MakeCallback (&RmcatReceiver::RecvPacket, this));
     NS_LOG_INFO(local<<" "<<port);
 
@@ -66,10 +90,29 @@ void RmcatReceiver::Setup (uint16_t port)
     m_waiting = true;
 }
 
+void RmcatReceiver::SetNackEnabled (bool enable)
+{
+    m_nackEnabled = enable;
+}
+
+void RmcatReceiver::SetFeedbackBudget (double rateFraction,
+                                       uint64_t minPeriodUs,
+                                       uint64_t maxPeriodUs)
+{
+    NS_ASSERT (rateFraction >= 0.);
+    NS_ASSERT (minPeriodUs > 0 && minPeriodUs <= maxPeriodUs);
+    m_fbRateFraction = rateFraction;
+    m_fbMinPeriodUs = minPeriodUs;
+    m_fbMaxPeriodUs = maxPeriodUs;
+}
+
 void RmcatReceiver::StartApplication ()
 {
     NS_LOG_FUNCTION(this);
     m_running = true;
+    m_fbRateStartUs = Simulator::Now ().GetMicroSeconds ();
+    m_fbRateBytes = 0;
+    m_fbRatePackets = 0;
     m_ssrc = rand ();
     m_header.SetSendSsrc (m_ssrc);
     Time tFirst {MicroSeconds (m_periodUs)};
@@ -82,6 +125,29 @@ void RmcatReceiver::StopApplication ()
     m_waiting = true;
     m_header.Clear ();
     Simulator::Cancel (m_sendEvent);
+    Simulator::Cancel (m_nackEvent);
+    m_nackList.clear ();
+    m_highestSeqValid = false;
+
+    // Packets still missing will not make it
+    m_mediaLost += m_missingMedia.size ();
+    m_missingMedia.clear ();
+    m_missingOrder.clear ();
+    NS_LOG_INFO ("RmcatReceiver::StopApplication, residual_loss: ssrc " << m_remoteSsrc
+                 << " lost " << m_mediaLost
+                 << " expected " << m_mediaExpected
+                 << " fec_recovered " << m_fecRecovered);
+    m_fecMedia.clear ();
+    m_fecMediaOrder.clear ();
+    m_fecParities.clear ();
+}
+
+double RmcatReceiver::GetResidualLossRate () const
+{
+    if (m_mediaExpected == 0) {
+        return 0.;
+    }
+    return double (m_mediaLost) / double (m_mediaExpected);
 }
 
 void RmcatReceiver::RecvPacket (Ptr<Socket> socket)
@@ -105,27 +171,337 @@ void RmcatReceiver::RecvPacket (Ptr<Socket> socket)
         m_srcIp = srcIp;
         m_srcPort = srcPort;
     } else {
-        // Only one flow supported
-        NS_ASSERT (m_remoteSsrc == header.GetSsrc ());
+        // Only one flow supported, whose layers may come with SSRCs of
+        // their own (see RmcatSender::AddLayer)
         NS_ASSERT (m_srcIp == srcIp);
         NS_ASSERT (m_srcPort == srcPort);
     }
 
     uint64_t recvTimestampUs = Simulator::Now ().GetMicroSeconds ();
-    AddFeedback (header.GetSequence (), recvTimestampUs);
+    AccountFeedbackRate (packet->GetSize () + header.GetSerializedSize ());
+    OnPacketArrival (header, packet->GetSize (), recvTimestampUs, GetEcn (packet));
+    if (m_nackEnabled) {
+        UpdateNackList (GetFlowSequence (header));
+    }
+    if (header.IsPadding ()) {
+        // Padding-only packet, e.g., for bandwidth probing
+        return;
+    }
+    ProcessPayload (header, packet, recvTimestampUs);
+}
+
+void RmcatReceiver::OnPacketArrival (const RtpHeader& header, uint32_t size,
+                                     uint64_t recvTimestampUs, uint8_t ecn)
+{
+    uint32_t fbSsrc = header.GetSsrc ();
+    uint16_t fbSequence = header.GetSequence ();
+    if (header.GetTransportSequence (fbSequence)) {
+        // Transport-wide sequence numbers: one report block covers all SSRCs
+        fbSsrc = m_remoteSsrc;
+    }
+    AddFeedback (fbSsrc, fbSequence, recvTimestampUs, ecn);
+}
+
+void RmcatReceiver::ProcessPayload (const RtpHeader& header, Ptr<const Packet> packet, uint64_t nowUs)
+{
+    const auto payloadType = header.GetPayloadType ();
+    if (payloadType == RMCAT_FEC_PAYLOAD_TYPE) {
+        ProcessParity (packet, nowUs);
+        return;
+    }
+
+    MediaIndexTag indexTag{};
+    if (!packet->PeekPacketTag (indexTag)) {
+        // Neither retransmissions nor FEC: nothing to recover
+        return;
+    }
+    uint16_t sequence = GetFlowSequence (header);
+    uint32_t size = packet->GetSize ();
+    if (payloadType == RMCAT_RTX_PAYLOAD_TYPE) {
+        // rfc4588: the original sequence number leads the payload
+        uint8_t buf[RMCAT_RTX_OSN_SIZE];
+        NS_ASSERT (size >= RMCAT_RTX_OSN_SIZE);
+        packet->CopyData (buf, RMCAT_RTX_OSN_SIZE);
+        sequence = (uint16_t (buf[0]) << 8) | uint16_t (buf[1]);
+        size -= RMCAT_RTX_OSN_SIZE;
+    }
+    OnMediaReceived (sequence, indexTag.GetMediaIndex (), size, nowUs);
+}
+
+void RmcatReceiver::OnMediaReceived (uint16_t sequence, uint16_t mediaIndex,
+                                     uint32_t size, uint64_t nowUs)
+{
+    if (m_nackList.erase (sequence) > 0) {
+        NS_LOG_INFO ("RmcatReceiver::OnMediaReceived, recovered packet " << sequence);
+    }
+    UpdateResidualLoss (mediaIndex, nowUs);
+    // Kept from the first packet on, as parity packets follow the
+    // packets they protect
+    ExpireFecMedia (nowUs);
+    const MediaRecord record = { mediaIndex, size, nowUs };
+    if (!m_fecMedia.insert (std::make_pair (sequence, record)).second) {
+        return;
+    }
+    m_fecMediaOrder.push_back (std::make_pair (nowUs, sequence));
+    if (!m_fecParities.empty ()) {
+        RecoverWithParities (nowUs);
+    }
+}
+
+void RmcatReceiver::UpdateResidualLoss (uint16_t mediaIndex, uint64_t nowUs)
+{
+    if (!m_highestIndexValid) {
+        m_highestIndexValid = true;
+        m_highestIndex = mediaIndex;
+        ++m_mediaExpected;
+        return;
+    }
+    const uint16_t diff = mediaIndex - m_highestIndex; //this wraps properly
+    if (diff == 0) {
+        return;
+    }
+    if (diff >= 0x8000) {
+        // reordered, retransmitted or recovered packet
+        m_missingMedia.erase (mediaIndex);
+        return;
+    }
+    for (uint16_t missing = m_highestIndex + 1; missing != mediaIndex; ++missing) {
+        m_missingMedia[missing] = nowUs;
+        m_missingOrder.push_back (std::make_pair (nowUs, missing));
+    }
+    m_mediaExpected += diff;
+    m_highestIndex = mediaIndex;
+
+    const uint64_t lostBefore = m_mediaLost;
+    // Only the oldest entries can have expired
+    while (!m_missingOrder.empty () &&
+           m_missingOrder.front ().first + RMCAT_RESIDUAL_LOSS_DELAY_US < nowUs) {
+        const auto& entry = m_missingOrder.front ();
+        const auto it = m_missingMedia.find (entry.second);
+        // Otherwise, received or recovered since
+        if (it != m_missingMedia.end () && it->second == entry.first) {
+            ++m_mediaLost;
+            m_missingMedia.erase (it);
+        }
+        m_missingOrder.pop_front ();
+    }
+    if (m_mediaLost != lostBefore) {
+        NS_LOG_INFO ("RmcatReceiver::UpdateResidualLoss, residual_loss: ssrc " << m_remoteSsrc
+                     << " lost " << m_mediaLost
+                     << " expected " << m_mediaExpected
+                     << " fec_recovered " << m_fecRecovered);
+    }
+}
+
+uint8_t RmcatReceiver::GetEcn (Ptr<const Packet> packet)
+{
+    SocketIpTosTag tosTag;
+    if (!packet->PeekPacketTag (tosTag)) {
+        return 0;
+    }
+    return tosTag.GetTos () & IP_TOS_ECN_MASK;
+}
+
+uint16_t RmcatReceiver::GetFlowSequence (const RtpHeader& header)
+{
+    uint16_t sequence = header.GetSequence ();
+    (void) header.GetTransportSequence (sequence);
+    return sequence;
 }
 
-void RmcatReceiver::AddFeedback (uint16_t sequence,
-                                 uint64_t recvTimestampUs)
+void RmcatReceiver::AddFeedback (uint32_t ssrc,
+                                 uint16_t sequence,
+                                 uint64_t recvTimestampUs,
+                                 uint8_t ecn)
 {
-    auto res = m_header.AddFeedback (m_remoteSsrc, sequence, recvTimestampUs);
+    auto res = m_header.AddFeedback (ssrc, sequence, recvTimestampUs, ecn);
     if (res == CCFeedbackHeader::CCFB_TOO_LONG) {
         SendFeedback (false);
-        res = m_header.AddFeedback (m_remoteSsrc, sequence, recvTimestampUs);
+        res = m_header.AddFeedback (ssrc, sequence, recvTimestampUs, ecn);
     }
     NS_ASSERT (res == CCFeedbackHeader::CCFB_NONE);
 }
 
+void RmcatReceiver::UpdateNackList (uint16_t seq)
+{
+    // Retransmissions and parity packets take new sequence numbers, so
+    // gaps can be detected in a single sequence space
+    if (!m_highestSeqValid) {
+        m_highestSeqValid = true;
+        m_highestSeq = seq;
+        return;
+    }
+    const uint16_t diff = seq - m_highestSeq; //this wraps properly
+    if (diff == 0) {
+        return;
+    }
+    if (diff >= 0x8000) {
+        // reordered packet
+        m_nackList.erase (seq);
+        return;
+    }
+    if (m_nackList.size () + diff - 1 > RMCAT_NACK_MAX_LIST_SIZE) {
+        NS_LOG_INFO ("RmcatReceiver::UpdateNackList, too many missing packets, "
+                     "giving up on " << m_nackList.size () << " of them");
+        m_nackList.clear ();
+    }
+    for (uint16_t missing = m_highestSeq + 1; missing != seq; ++missing) {
+        if (m_nackList.size () >= RMCAT_NACK_MAX_LIST_SIZE) {
+            break;
+        }
+        const NackState state = { 0, 0 };
+        m_nackList[missing] = state;
+    }
+    m_highestSeq = seq;
+    if (!m_nackList.empty () && !m_nackEvent.IsRunning ()) {
+        m_nackEvent = Simulator::ScheduleNow (&RmcatReceiver::SendNack, this);
+    }
+}
+
+void RmcatReceiver::SendNack ()
+{
+    if (!m_running) {
+        return;
+    }
+    const uint64_t nowUs = Simulator::Now ().GetMicroSeconds ();
+    GenericNackHeader header{};
+    header.SetSendSsrc (m_ssrc);
+    header.SetMediaSsrc (m_remoteSsrc);
+    for (auto it = m_nackList.begin (); it != m_nackList.end ();) {
+        auto& state = it->second;
+        const bool due = (state.retries == 0 ||
+                          nowUs >= state.lastSentUs + RMCAT_NACK_RESEND_US);
+        if (!due) {
+            ++it;
+            continue;
+        }
+        if (state.retries >= RMCAT_NACK_MAX_RETRIES) {
+            it = m_nackList.erase (it);
+            continue;
+        }
+        if (!header.AddNack (it->first)) {
+            break;
+        }
+        state.lastSentUs = nowUs;
+        ++state.retries;
+        ++it;
+    }
+
+    if (!header.Empty ()) {
+        auto packet = Create<Packet> ();
+        packet->AddHeader (header);
+        NS_LOG_INFO ("RmcatReceiver::SendNack, " << packet->ToString ());
+        m_socket->SendTo (packet, 0, InetSocketAddress{m_srcIp, m_srcPort});
+    }
+
+    if (!m_nackList.empty ()) {
+        Time tNext {MicroSeconds (RMCAT_NACK_PERIOD_US)};
+        m_nackEvent = Simulator::Schedule (tNext, &RmcatReceiver::SendNack, this);
+    }
+}
+
+void RmcatReceiver::ProcessParity (Ptr<const Packet> packet, uint64_t nowUs)
+{
+    // FEC header, then the XOR of the protected payloads. The XOR of
+    // their media indexes comes in the tag
+    uint8_t buf[RMCAT_FEC_HEADER_SIZE];
+    NS_ASSERT (packet->GetSize () >= sizeof (buf));
+    packet->CopyData (buf, sizeof (buf));
+    MediaIndexTag indexTag{};
+    const bool tagged = packet->PeekPacketTag (indexTag);
+    NS_ASSERT (tagged);
+    (void) tagged; // unused in optimized builds
+    ParityRecord parity{};
+    parity.baseSequence = (uint16_t (buf[0]) << 8) | uint16_t (buf[1]);
+    parity.lengthRecovery = (uint16_t (buf[2]) << 8) | uint16_t (buf[3]);
+    parity.mask = (uint32_t (buf[4]) << 24) | (uint32_t (buf[5]) << 16) |
+                  (uint32_t (buf[6]) << 8) | uint32_t (buf[7]);
+    parity.indexXor = indexTag.GetMediaIndex ();
+    parity.arrivalUs = nowUs;
+
+    ExpireFecMedia (nowUs);
+    while (!m_fecParities.empty () &&
+           m_fecParities.front ().arrivalUs + RMCAT_FEC_RECOVERY_WINDOW_US < nowUs) {
+        m_fecParities.pop_front ();
+    }
+
+    m_fecParities.push_back (parity);
+    RecoverWithParities (nowUs);
+}
+
+void RmcatReceiver::ExpireFecMedia (uint64_t nowUs)
+{
+    // Forget packets too old to be of any use
+    while (!m_fecMediaOrder.empty () &&
+           m_fecMediaOrder.front ().first + RMCAT_FEC_RECOVERY_WINDOW_US < nowUs) {
+        const auto& entry = m_fecMediaOrder.front ();
+        const auto it = m_fecMedia.find (entry.second);
+        if (it != m_fecMedia.end () && it->second.arrivalUs == entry.first) {
+            m_fecMedia.erase (it);
+        }
+        m_fecMediaOrder.pop_front ();
+    }
+}
+
+uint32_t RmcatReceiver::CheckParity (const ParityRecord& parity,
+                                     uint16_t& lostSequence,
+                                     MediaRecord& recovered) const
+{
+    uint32_t nMissing = 0;
+    uint16_t length = parity.lengthRecovery;
+    uint16_t index = parity.indexXor;
+    for (uint32_t i = 0; i <= RMCAT_FEC_MASK_BITS; ++i) {
+        // The base sequence number is always protected
+        if (i > 0 && ((parity.mask >> (RMCAT_FEC_MASK_BITS - i)) & 0x01) == 0) {
+            continue;
+        }
+        const uint16_t seq = parity.baseSequence + i;
+        const auto it = m_fecMedia.find (seq);
+        if (it == m_fecMedia.end ()) {
+            ++nMissing;
+            lostSequence = seq;
+            continue;
+        }
+        length ^= uint16_t (it->second.size);
+        index ^= it->second.mediaIndex;
+    }
+    if (nMissing == 1) {
+        recovered.mediaIndex = index;
+        recovered.size = length;
+    }
+    return nMissing;
+}
+
+void RmcatReceiver::RecoverWithParities (uint64_t nowUs)
+{
+    // A recovered packet may in turn let another parity recover a packet
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (auto it = m_fecParities.begin (); it != m_fecParities.end ();) {
+            uint16_t lostSequence = 0;
+            MediaRecord recovered{};
+            const auto nMissing = CheckParity (*it, lostSequence, recovered);
+            if (nMissing > 1) {
+                ++it;
+                continue;
+            }
+            it = m_fecParities.erase (it);
+            if (nMissing == 1) {
+                NS_LOG_INFO ("RmcatReceiver::RecoverWithParities, recovered packet " << lostSequence
+                             << ", size " << recovered.size);
+                recovered.arrivalUs = nowUs;
+                m_fecMedia[lostSequence] = recovered;
+                m_fecMediaOrder.push_back (std::make_pair (nowUs, lostSequence));
+                m_nackList.erase (lostSequence);
+                UpdateResidualLoss (recovered.mediaIndex, nowUs);
+                ++m_fecRecovered;
+                progress = true;
+            }
+        }
+    }
+}
+
 void RmcatReceiver::SendFeedback (bool reschedule)
 {
     if (m_running && !m_header.Empty ()) {
@@ -140,10 +516,47 @@ void RmcatReceiver::SendFeedback (bool reschedule)
     }
 
     if (reschedule) {
-        Time tNext {MicroSeconds (m_periodUs)};
+        const uint64_t nowUs = Simulator::Now ().GetMicroSeconds ();
+        Time tNext {MicroSeconds (GetFeedbackPeriodUs (nowUs, m_periodUs,
+                                                       RMCAT_CCFB_OVERHEAD_SIZE,
+                                                       RMCAT_FB_METRIC_SIZE))};
         m_sendEvent = Simulator::Schedule (tNext, &RmcatReceiver::SendFeedback, this, true);
     }
 }
 
+void RmcatReceiver::AccountFeedbackRate (uint32_t size)
+{
+    m_fbRateBytes += size;
+    ++m_fbRatePackets;
+}
+
+uint64_t RmcatReceiver::GetFeedbackPeriodUs (uint64_t nowUs, uint64_t fixedPeriodUs,
+                                             uint32_t overheadBytes, uint32_t metricBytes)
+{
+    const uint64_t elapsedUs = nowUs - m_fbRateStartUs;
+    const double bytes = double (m_fbRateBytes);
+    const double packets = double (m_fbRatePackets);
+    m_fbRateStartUs = nowUs;
+    m_fbRateBytes = 0;
+    m_fbRatePackets = 0;
+    if (m_fbRateFraction <= 0. || elapsedUs == 0) {
+        return fixedPeriodUs;
+    }
+
+    // Feedback sent every T seconds takes 8 * (overhead / T + metric * packet rate)
+    // bps: solve for the T that meets the budget
+    const double mediaBps = bytes * 8e6 / double (elapsedUs);
+    const double packetRate = packets * 1e6 / double (elapsedUs);
+    const double budgetBps = m_fbRateFraction * mediaBps - 8. * metricBytes * packetRate;
+    uint64_t periodUs = m_fbMaxPeriodUs;
+    if (budgetBps > 0.) {
+        periodUs = uint64_t (std::min (8e6 * overheadBytes / budgetBps, double (m_fbMaxPeriodUs)));
+    }
+    periodUs = std::max (std::min (periodUs, m_fbMaxPeriodUs), m_fbMinPeriodUs);
+    NS_LOG_INFO ("RmcatReceiver::GetFeedbackPeriodUs, media rate " << mediaBps
+                 << " bps, feedback period " << periodUs << " us");
+    return periodUs;
+}
+
 }
 
@@ -28,9 +28,12 @@
 #ifndef RMCAT_RECEIVER_H
 #define RMCAT_RECEIVER_H
 
+#include "rmcat-constants.h"
 #include "rtp-header.h"
 #include "ns3/socket.h"
 #include "ns3/application.h"
+#include <deque>
+#include <map>
 
 namespace ns3 {
 
@@ -42,14 +45,80 @@ public:
 
     void Setup (uint16_t port);
 
+    /**
+     * Request retransmission of missing media packets with RTCP Generic
+     * NACK (rfc4585). The sender needs retransmissions enabled too (see
+     * RmcatSender::SetRtxEnabled)
+     */
+    void SetNackEnabled (bool enable);
+
+    /**
+     * Fraction of the media packets sent that were neither received nor
+     * recovered (by retransmission or FEC) within
+     * RMCAT_RESIDUAL_LOSS_DELAY_US, i.e., the losses left for the decoder
+     */
+    double GetResidualLossRate () const;
+
+    /**
+     * Adapt the feedback period to the incoming media, so that feedback
+     * takes about the given share of the media bitrate (as suggested by
+     * rfc8888): the higher the rate, the more often feedback is sent.
+     * Per-packet report sizes are accounted for, so that low rates with
+     * small packets get the longest period
+     *
+     * @param [in] rateFraction Feedback bitrate budget, as a fraction of
+     *                          the media bitrate; 0 to go back to the
+     *                          fixed period
+     * @param [in] minPeriodUs Shortest feedback period
+     * @param [in] maxPeriodUs Longest feedback period, i.e., the worst
+     *                         reaction latency added by feedback
+     */
+    void SetFeedbackBudget (double rateFraction,
+                            uint64_t minPeriodUs = RMCAT_FEEDBACK_MIN_PERIOD_US,
+                            uint64_t maxPeriodUs = RMCAT_FEEDBACK_MAX_PERIOD_US);
+
 protected:
     virtual void StartApplication ();
     virtual void StopApplication ();
 
     virtual void RecvPacket (Ptr<Socket> socket);
-    void AddFeedback (uint16_t sequence,
-                      uint64_t recvTimestampUs);
-    void SendFeedback (bool reschedule);
+    /** Account for a packet's arrival; reports it in the next CCFB by default */
+    virtual void OnPacketArrival (const RtpHeader& header, uint32_t size,
+                                  uint64_t recvTimestampUs, uint8_t ecn);
+    void AddFeedback (uint32_t ssrc,
+                      uint16_t sequence,
+                      uint64_t recvTimestampUs,
+                      uint8_t ecn);
+    /** ECN codepoint the packet was received with, from its IP TOS byte */
+    static uint8_t GetEcn (Ptr<const Packet> packet);
+    /**
+     * Transport-wide sequence number of the packet if it has one, RTP
+     * sequence number otherwise. NACKs and FEC work on these, as the
+     * RTP sequence numbers of a layered source restart with each SSRC
+     */
+    static uint16_t GetFlowSequence (const RtpHeader& header);
+    virtual void SendFeedback (bool reschedule);
+    /** Account for a received media packet, for the feedback budget */
+    void AccountFeedbackRate (uint32_t size);
+    /**
+     * Period until the next feedback message, out of the media received
+     * since the last call, and the size of feedback messages
+     *
+     * @param [in] nowUs Current time
+     * @param [in] fixedPeriodUs Period when no budget is set
+     * @param [in] overheadBytes Size of an empty feedback message
+     * @param [in] metricBytes Size added by each packet reported
+     */
+    uint64_t GetFeedbackPeriodUs (uint64_t nowUs, uint64_t fixedPeriodUs,
+                                  uint32_t overheadBytes, uint32_t metricBytes);
+    void ProcessPayload (const RtpHeader& header, Ptr<const Packet> packet, uint64_t nowUs);
+    void OnMediaReceived (uint16_t sequence, uint16_t mediaIndex, uint32_t size, uint64_t nowUs);
+    void UpdateResidualLoss (uint16_t mediaIndex, uint64_t nowUs);
+    void UpdateNackList (uint16_t sequence);
+    void SendNack ();
+    void ProcessParity (Ptr<const Packet> packet, uint64_t nowUs);
+    void ExpireFecMedia (uint64_t nowUs);
+    void RecoverWithParities (uint64_t nowUs);
 
 protected:
     bool m_running;
@@ -62,6 +131,52 @@ protected:
     CCFeedbackHeader m_header;
     EventId m_sendEvent;
     uint64_t m_periodUs;
+
+    double m_fbRateFraction;  /**< feedback budget, 0 if fixed period */
+    uint64_t m_fbMinPeriodUs;
+    uint64_t m_fbMaxPeriodUs;
+    uint64_t m_fbRateStartUs;  /**< start of the current measurement */
+    uint64_t m_fbRateBytes;
+    uint32_t m_fbRatePackets;
+
+    struct NackState {
+        uint64_t lastSentUs;
+        uint32_t retries;
+    };
+    bool m_nackEnabled;
+    bool m_highestSeqValid;
+    uint16_t m_highestSeq;
+    std::map<uint16_t /* sequence */, NackState> m_nackList;
+    EventId m_nackEvent;
+
+    struct MediaRecord {
+        uint16_t mediaIndex;
+        uint32_t size;
+        uint64_t arrivalUs;
+    };
+    struct ParityRecord {
+        uint16_t baseSequence;
+        uint32_t mask;
+        uint16_t lengthRecovery;
+        uint16_t indexXor;
+        uint64_t arrivalUs;
+    };
+    uint32_t CheckParity (const ParityRecord& parity,
+                          uint16_t& lostSequence,
+                          MediaRecord& recovered) const;
+    /** Media packets of the last RMCAT_FEC_RECOVERY_WINDOW_US, for recovery */
+    std::map<uint16_t /* sequence */, MediaRecord> m_fecMedia;
+    std::deque<std::pair<uint64_t /* arrival time */, uint16_t /* sequence */> > m_fecMediaOrder;
+    std::deque<ParityRecord> m_fecParities;  /**< parities with several losses */
+    uint64_t m_fecRecovered;
+
+    bool m_highestIndexValid;
+    uint16_t m_highestIndex;
+    std::map<uint16_t /* media index */, uint64_t /* detection time */> m_missingMedia;
+    /** Detection order of the entries above; received ones are skipped when expiring */
+    std::deque<std::pair<uint64_t /* detection time */, uint16_t /* media index */> > m_missingOrder;
+    uint64_t m_mediaExpected;
+    uint64_t m_mediaLost;
 };
 
 }
@@ -0,0 +1,164 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Receiver application implementation for rmcat ns3 module, with
+ * receiver-side bandwidth estimation (REMB).
+ *
+ * @version 0.1.1
+ */
+
+#include "rmcat-remb-receiver.h"
+#include "rmcat-constants.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("RmcatRembReceiver");
+
+namespace ns3 {
+
+RmcatRembReceiver::RmcatRembReceiver ()
+: RmcatReceiver{}
+, m_interArrival{}
+, m_trendline{}
+, m_detector{}
+, m_aimd{}
+, m_incomingRate{RMCAT_REMB_RATE_WINDOW_MS, webrtc::RateStatistics::kBpsScale}
+, m_absSendTimeValid{false}
+, m_lastAbsSendTime{0}
+, m_absSendTicks{0}
+, m_firstArrivalUs{0}
+, m_lastUpdateUs{0}
+, m_lastUpdateValid{false}
+, m_lastRembBps{0.f}
+{
+    // The base class's feedback timer sends REMB messages (see SendFeedback)
+    m_periodUs = RMCAT_REMB_PERIOD_US;
+}
+
+RmcatRembReceiver::~RmcatRembReceiver () {}
+
+void RmcatRembReceiver::StartApplication ()
+{
+    m_aimd.setBounds (RMCAT_REMB_MIN_BPS, RMCAT_REMB_MAX_BPS);
+    RmcatReceiver::StartApplication ();
+}
+
+void RmcatRembReceiver::StopApplication ()
+{
+    RmcatReceiver::StopApplication ();
+    m_interArrival.reset ();
+    m_trendline.reset ();
+    m_detector.reset ();
+    m_aimd.reset ();
+    m_incomingRate.Reset ();
+    m_absSendTimeValid = false;
+    m_lastUpdateValid = false;
+    m_lastRembBps = 0.f;
+}
+
+void RmcatRembReceiver::OnPacketArrival (const RtpHeader& header, uint32_t size,
+                                         uint64_t recvTimestampUs, uint8_t ecn)
+{
+    uint32_t absSendTime = 0;
+    if (!header.GetAbsSendTime (absSendTime)) {
+        return;
+    }
+    if (!m_absSendTimeValid) {
+        m_firstArrivalUs = recvTimestampUs;
+    }
+    const uint64_t sendTimeUs = UnwrapAbsSendTime (absSendTime);
+    m_incomingRate.Update (size, int64_t (recvTimestampUs / 1000));
+
+    int64_t sendDeltaUs = 0;
+    int64_t arrivalDeltaUs = 0;
+    if (m_interArrival.computeDeltas (sendTimeUs, recvTimestampUs, size,
+                                      sendDeltaUs, arrivalDeltaUs)) {
+        m_trendline.update (sendDeltaUs, arrivalDeltaUs, recvTimestampUs);
+        m_detector.detect (m_trendline.getModifiedTrend (), sendDeltaUs,
+                           m_trendline.getNumDeltas (), recvTimestampUs);
+    }
+    UpdateEstimate (recvTimestampUs);
+}
+
+uint64_t RmcatRembReceiver::UnwrapAbsSendTime (uint32_t absSendTime)
+{
+    if (!m_absSendTimeValid) {
+        m_absSendTimeValid = true;
+        m_lastAbsSendTime = absSendTime;
+        m_absSendTicks = absSendTime;
+    } else {
+        const uint32_t diff = (absSendTime - m_lastAbsSendTime) & 0xffffff; //this wraps properly
+        if (diff < 0x800000) {
+            m_absSendTicks += diff;
+            m_lastAbsSendTime = absSendTime;
+        } else {
+            // reordered: earlier than the latest one
+            return ((m_absSendTicks - (0x1000000 - diff)) * 1000000) >> 18;
+        }
+    }
+    return (m_absSendTicks * 1000000) >> 18;
+}
+
+void RmcatRembReceiver::UpdateEstimate (uint64_t nowUs)
+{
+    const float incomingBps = float (m_incomingRate.Rate (int64_t (nowUs / 1000)));
+    if (!m_aimd.isBitrateValid ()) {
+        if (nowUs - m_firstArrivalUs < RMCAT_REMB_INIT_US || incomingBps <= 0.f) {
+            return;
+        }
+        m_aimd.setBitrate (incomingBps);
+    }
+
+    const bool overusing = (m_detector.getState () == rmcat::GCC_BW_OVERUSING);
+    if (m_lastUpdateValid && !overusing && nowUs - m_lastUpdateUs < RMCAT_REMB_UPDATE_US) {
+        return;
+    }
+    m_lastUpdateUs = nowUs;
+    m_lastUpdateValid = true;
+    const float bps = m_aimd.update (m_detector.getState (), incomingBps,
+                                     RMCAT_REMB_DEFAULT_RTT_US, nowUs);
+    if (m_lastRembBps <= 0.f || bps < RMCAT_REMB_DECREASE_RATIO * m_lastRembBps) {
+        // Do not wait for the timer to report the first estimate, or a decrease
+        SendFeedback (false);
+    }
+}
+
+void RmcatRembReceiver::SendFeedback (bool reschedule)
+{
+    if (m_running && !m_waiting && m_aimd.isBitrateValid ()) {
+        RembHeader header{};
+        header.SetSendSsrc (m_ssrc);
+        header.SetBitrate (uint64_t (m_aimd.getBitrate ()));
+        header.AddSsrc (m_remoteSsrc);
+        auto packet = Create<Packet> ();
+        packet->AddHeader (header);
+        NS_LOG_INFO ("RmcatRembReceiver::SendFeedback, " << packet->ToString ());
+        m_socket->SendTo (packet, 0, InetSocketAddress{m_srcIp, m_srcPort});
+        m_lastRembBps = m_aimd.getBitrate ();
+    }
+
+    if (reschedule) {
+        Time tNext {MicroSeconds (m_periodUs)};
+        m_sendEvent = Simulator::Schedule (tNext, &RmcatRembReceiver::SendFeedback, this, true);
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Receiver application interface for rmcat ns3 module, with
+ * receiver-side bandwidth estimation (REMB).
+ *
+ * @version 0.1.1
+ */
+
+#ifndef RMCAT_REMB_RECEIVER_H
+#define RMCAT_REMB_RECEIVER_H
+
+#include "rmcat-receiver.h"
+#include "ns3/gcc-estimators.h"
+#include "ns3/rate_statistics.h"
+
+namespace ns3 {
+
+/**
+ * Receiver that estimates the available bandwidth itself, rather than
+ * reporting every packet's arrival: it runs GCC's delay-based estimator
+ * (see rmcat::GccInterArrival and friends) on the arrival times and the
+ * abs-send-time header extension (see
+ * RmcatSender::SetHeaderExtensionsEnabled), and sends the estimate in
+ * REMB messages (draft-alvestrand-rmcat-remb), to be handed over to an
+ * rmcat::RembController at the sender. The feedback is then a few dozen
+ * bytes per second, instead of a report every RMCAT_FEEDBACK_PERIOD_US.
+ *
+ * Packets without abs-send-time are not taken into account.
+ */
+class RmcatRembReceiver: public RmcatReceiver
+{
+public:
+    RmcatRembReceiver ();
+    virtual ~RmcatRembReceiver ();
+
+private:
+    virtual void StartApplication ();
+    virtual void StopApplication ();
+
+    virtual void OnPacketArrival (const RtpHeader& header, uint32_t size,
+                                  uint64_t recvTimestampUs, uint8_t ecn);
+    virtual void SendFeedback (bool reschedule);
+
+    uint64_t UnwrapAbsSendTime (uint32_t absSendTime);
+    void UpdateEstimate (uint64_t nowUs);
+
+private:
+    rmcat::GccInterArrival m_interArrival;
+    rmcat::GccTrendlineEstimator m_trendline;
+    rmcat::GccOveruseDetector m_detector;
+    rmcat::GccAimdRateControl m_aimd;
+    webrtc::RateStatistics m_incomingRate;
+
+    bool m_absSendTimeValid;
+    uint32_t m_lastAbsSendTime;   /**< latest 24-bit abs-send-time */
+    uint64_t m_absSendTicks;      /**< unwrapped, in 1/2^18 s */
+    uint64_t m_firstArrivalUs;
+    uint64_t m_lastUpdateUs;
+    bool m_lastUpdateValid;
+    float m_lastRembBps;          /**< latest estimate sent, 0 if none */
+};
+
+}
+
+#endif /* RMCAT_REMB_RECEIVER_H */
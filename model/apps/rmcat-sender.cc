@@ -31,20 +31,53 @@
 #include "ns3/dummy-controller.h"
 #include "ns3/nada-controller.h"
 #include "ns3/ccfs-controller.h"
+#include "ns3/remb-controller.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/log.h"
 
+#include <algorithm>
 #include <sys/stat.h>
 
 NS_LOG_COMPONENT_DEFINE ("RmcatSender");
 
 namespace ns3 {
 
+/** Video traces directory, shared by all senders */
+static std::string& TraceDirectory ()
+{
+    static std::string traceDir{};
+    return traceDir;
+}
+
+/** Look for the video traces in the ns-3 source tree */
+static std::string FindTraceDirectory ()
+{
+    const std::vector<std::string> candidatePaths = {
+        ".",      // If run from top directory (e.g., with gdb), from ns-3.26/
+        "../",    // If run from with test_new.py with designated directory, from ns-3.26/2017-xyz/
+        "../..",  // If run with test.py, from ns-3.26/testpy-output/201...
+    };
+
+    const std::string traceSubDir{"src/ns3-rmcat/model/syncodecs/video_traces/chat_firefox_h264"};
+
+    for (auto c : candidatePaths) {
+        std::ostringstream currPathOss;
+        currPathOss << c << "/" << traceSubDir;
+        struct stat buffer;
+        if (::stat (currPathOss.str ().c_str (), &buffer) == 0) {
+            //filename exists
+            return currPathOss.str ();
+        }
+    }
+    return std::string{};
+}
+
 RmcatSender::RmcatSender ()
-: m_destIP{}
+: m_frameGranular{false}
+, m_destIP{}
 , m_destPort{0}
 , m_initBw{0}
 , m_minBw{0}
@@ -61,7 +94,32 @@ RmcatSender::RmcatSender ()
 , m_rSend{0.}
 , m_rateShapingBytes{0}
 , m_nextSendTstmpUs{0}
+, m_windowBlocked{false}
 , m_algo{""}
+, m_capture{}
+, m_fse{}
+, m_fsePriority{1.}
+, m_fseId{0}
+, m_fseRegistered{false}
+, m_fseAcked{}
+, m_mediaIndex{0}
+, m_rtxEnabled{false}
+, m_rttUs{0}
+, m_rtxHistory{}
+, m_rtxQueue{}
+, m_fecEnabled{false}
+, m_fecGroupSize{0}
+, m_fecCurrentGroup{0}
+, m_fecPending{}
+, m_fecPendingCount{0}
+, m_fecQueue{}
+, m_probingEnabled{false}
+, m_probeCluster{}
+, m_probePacketsSent{0}
+, m_probeBytesSent{0}
+, m_probeEvent{}
+, m_layers{}
+, m_hdrExtEnabled{false}
 {}
 
 RmcatSender::~RmcatSender () {}
@@ -75,13 +133,27 @@ void RmcatSender::PauseResume (bool pause)
         Simulator::Cancel (m_sendOversleepEvent);
         m_rateShapingBuf.clear ();
         m_rateShapingBytes = 0;
+        m_windowBlocked = false;
+        m_rtxQueue.clear ();
+        m_rtxHistory.clear ();
+        m_fecQueue.clear ();
+        m_fecPendingCount = 0;
+        Simulator::Cancel (m_probeEvent);
+        m_probeCluster.id = 0;
+        for (auto& layer : m_layers) {
+            Simulator::Cancel (layer.enqueueEvent);
+            layer.rate = 0.f;
+        }
+        DeregisterFromFse ();
     } else {
         m_rVin = m_initBw;
         m_rSend = m_initBw;
+        RegisterWithFse ();
         m_enqueueEvent = Simulator::ScheduleNow (&RmcatSender::EnqueuePacket, this);
         m_nextSendTstmpUs = 0;
     }
     m_paused = pause;
+    StartProbeCluster ();
 }
 
 void RmcatSender::SetCodec (std::shared_ptr<syncodecs::Codec> codec)
@@ -89,7 +161,38 @@ void RmcatSender::SetCodec (std::shared_ptr<syncodecs::Codec> codec)
     m_codec = codec;
 }
 
-// TODO (deferred): allow flexible input of video traffic trace path via config file, etc.
+void RmcatSender::SetFrameGranularEnqueue (bool enable)
+{
+    m_frameGranular = enable;
+}
+
+void RmcatSender::AddLayer (std::shared_ptr<syncodecs::Codec> codec, float minRate, float maxRate)
+{
+    NS_ASSERT (codec);
+    NS_ASSERT (minRate > 0.f);
+    NS_ASSERT (minRate <= maxRate);
+    const MediaLayer layer = { codec, minRate, maxRate, 0.f, EventId{}, 0, std::vector<uint16_t>{} };
+    m_layers.push_back (layer);
+}
+
+syncodecs::Codec* RmcatSender::Packetize (syncodecs::Codec* innerCodec) const
+{
+    if (m_frameGranular) {
+        // Frames are split into packets upon enqueuing
+        return innerCodec;
+    }
+    return new syncodecs::ShapedPacketizer{innerCodec, DEFAULT_PACKET_SIZE};
+}
+
+void RmcatSender::SetTraceDirectory (const std::string& path)
+{
+    struct stat buffer;
+    if (::stat (path.c_str (), &buffer) != 0 || !S_ISDIR (buffer.st_mode)) {
+        NS_FATAL_ERROR ("Traces directory not found: " << path);
+    }
+    TraceDirectory () = path;
+}
+
 void RmcatSender::SetCodecType (SyncodecType codecType)
 {
     syncodecs::Codec* codec = NULL;
@@ -103,40 +206,27 @@ void RmcatSender::SetCodecType (SyncodecType codecType)
         {
             const auto fps = SYNCODEC_DEFAULT_FPS;
             auto innerCodec = new syncodecs::SimpleFpsBasedCodec{fps};
-            codec = new syncodecs::ShapedPacketizer{innerCodec, DEFAULT_PACKET_SIZE};
+            codec = Packetize (innerCodec);
             break;
         }
         case SYNCODEC_TYPE_STATS:
         {
             const auto fps = SYNCODEC_DEFAULT_FPS;
             auto innerStCodec = new syncodecs::StatisticsCodec{fps};
-            codec = new syncodecs::ShapedPacketizer{innerStCodec, DEFAULT_PACKET_SIZE};
+            codec = Packetize (innerStCodec);
             break;
         }
         case SYNCODEC_TYPE_TRACE:
         case SYNCODEC_TYPE_HYBRID:
         {
-            const std::vector<std::string> candidatePaths = {
-                ".",      // If run from top directory (e.g., with gdb), from ns-3.26/
-                "../",    // If run from with test_new.py with designated directory, from ns-3.26/2017-xyz/
-                "../..",  // If run with test.py, from ns-3.26/testpy-output/201...
-            };
-
-            const std::string traceSubDir{"src/ns3-rmcat/model/syncodecs/video_traces/chat_firefox_h264"};
-            std::string traceDir{};
-
-            for (auto c : candidatePaths) {
-                std::ostringstream currPathOss;
-                currPathOss << c << "/" << traceSubDir;
-                struct stat buffer;
-                if (::stat (currPathOss.str ().c_str (), &buffer) == 0) {
-                    //filename exists
-                    traceDir = currPathOss.str ();
-                    break;
-                }
+            // Looked up once for all senders
+            std::string& traceDir = TraceDirectory ();
+            if (traceDir.empty ()) {
+                traceDir = FindTraceDirectory ();
+            }
+            if (traceDir.empty ()) {
+                NS_FATAL_ERROR ("Traces file not found in candidate paths");
             }
-
-            NS_ASSERT_MSG (!traceDir.empty (), "Traces file not found in candidate paths");
 
             auto filePrefix = "chat";
             auto innerCodec = (codecType == SYNCODEC_TYPE_TRACE) ?
@@ -151,13 +241,13 @@ void RmcatSender::SetCodecType (SyncodecType codecType)
                                     SYNCODEC_DEFAULT_FPS,             // Default FPS: 30fps
                                     true};           // fixed mode: image resolution doesn't change
 
-            codec = new syncodecs::ShapedPacketizer{innerCodec, DEFAULT_PACKET_SIZE};
+            codec = Packetize (innerCodec);
             break;
         }
         case SYNCODEC_TYPE_SHARING:
         {
             auto innerShCodec = new syncodecs::SimpleContentSharingCodec{};
-            codec = new syncodecs::ShapedPacketizer{innerShCodec, DEFAULT_PACKET_SIZE};
+            codec = Packetize (innerShCodec);
             break;
         }
         default:  // defaults to perfect codec
@@ -216,6 +306,21 @@ void RmcatSender::StartApplication ()
     // RTP initial values for sequence number and timestamp SHOULD be random (RFC 3550)
     m_sequence = rand ();
     m_rtpTsOffset = rand ();
+    if (!m_layers.empty () && (m_algo == "ccfs" || m_algo == "CCFS")) {
+        // The CCFS receiver reports on a single SSRC and sequence number space
+        NS_FATAL_ERROR ("Layered sources are not supported with CCFS");
+    }
+    if (!m_layers.empty () && (m_rtxEnabled || m_fecEnabled)) {
+        // NACKs and parity packets cannot refer to packets of several SSRCs
+        // by their RTP sequence numbers
+        m_hdrExtEnabled = true;
+    }
+    for (auto& layer : m_layers) {
+        layer.sequence = rand ();
+        if (!m_hdrExtEnabled) {
+            layer.flowSequences.assign (0x10000, 0);
+        }
+    }
 
     NS_ASSERT (m_minBw <= m_initBw);
     NS_ASSERT (m_initBw <= m_maxBw);
@@ -228,10 +333,16 @@ void RmcatSender::StartApplication ()
         auto res = m_socket->Bind ();
         NS_ASSERT (res == 0);
     }
+    // Media packets are ECN-capable, so that a marking bottleneck can
+    // signal congestion before it builds a queue
+    m_socket->SetIpTos (RMCAT_IP_TOS);
     m_socket->SetRecvCallback (MakeCallback (&RmcatSender::RecvPacket, this));
 
+    RegisterWithFse ();
+
     m_enqueueEvent = Simulator::Schedule (Seconds (0.0), &RmcatSender::EnqueuePacket, this);
     m_nextSendTstmpUs = 0;
+    StartProbeCluster ();
 }
 
 void RmcatSender::StopApplication ()
@@ -241,10 +352,35 @@ void RmcatSender::StopApplication ()
     Simulator::Cancel (m_sendOversleepEvent);
     m_rateShapingBuf.clear ();
     m_rateShapingBytes = 0;
+    m_windowBlocked = false;
+    m_rtxQueue.clear ();
+    m_rtxHistory.clear ();
+    m_fecQueue.clear ();
+    m_fecPendingCount = 0;
+    Simulator::Cancel (m_probeEvent);
+    m_probeCluster.id = 0;
+    for (auto& layer : m_layers) {
+        Simulator::Cancel (layer.enqueueEvent);
+        layer.rate = 0.f;
+    }
+    DeregisterFromFse ();
+    if (m_capture) {
+        m_capture->close ();
+    }
 }
 
 void RmcatSender::EnqueuePacket ()
 {
+    if (!m_layers.empty ()) {
+        // Each layer has its own enqueuing events, started along with its allocation
+        AllocateLayers (m_rVin);
+        return;
+    }
+    if (m_frameGranular) {
+        EnqueueFrame ();
+        return;
+    }
+
     syncodecs::Codec& codec = *m_codec;
     codec.setTargetRate (m_rVin);
     ++codec; // Advance codec/packetizer to next frame/packet
@@ -252,8 +388,8 @@ void RmcatSender::EnqueuePacket ()
     NS_ASSERT (bytesToSend > 0);
     NS_ASSERT (bytesToSend <= DEFAULT_PACKET_SIZE);
 
-    m_rateShapingBuf.push_back (bytesToSend);
-    m_rateShapingBytes += bytesToSend;
+    const bool bufferWasEmpty = IsBufferEmpty ();
+    PushToBuffer (bytesToSend, 0);
 
     NS_LOG_INFO ("RmcatSender::EnqueuePacket, packet enqueued, packet length: " << bytesToSend
                  << ", buffer size: " << m_rateShapingBuf.size ()
@@ -277,52 +413,196 @@ void RmcatSender::EnqueuePacket ()
         return;
     }
 
-    if (m_rateShapingBuf.size () == 1) {
-        // Buffer was empty
+    if (bufferWasEmpty) {
         const uint64_t nowUs = Simulator::Now ().GetMicroSeconds ();
-        const uint64_t usToNextSentPacket = nowUs < m_nextSendTstmpUs ?
-                                                    m_nextSendTstmpUs - nowUs : 0;
         NS_LOG_INFO ("(Re-)starting the send timer: nowUs " << nowUs
                      << ", bytesToSend " << bytesToSend
-                     << ", usToNextSentPacket " << usToNextSentPacket
+                     << ", m_nextSendTstmpUs " << m_nextSendTstmpUs
                      << ", m_rSend " << m_rSend
                      << ", m_rVin " << m_rVin
                      << ", secsToNextEnqPacket " << secsToNextEnqPacket);
+        StartSendTimer (nowUs);
+    }
+}
 
-        Time tNext{MicroSeconds (usToNextSentPacket)};
-        m_sendEvent = Simulator::Schedule (tNext, &RmcatSender::SendPacket, this, usToNextSentPacket);
+void RmcatSender::EnqueueFrame ()
+{
+    syncodecs::Codec& codec = *m_codec;
+    codec.setTargetRate (m_rVin);
+    ++codec; // Advance codec to next frame
+    const uint32_t frameBytes = codec->first.size ();
+    NS_ASSERT (frameBytes > 0);
+
+    const bool ccfs = (m_algo == "ccfs" || m_algo == "CCFS");
+    const bool bufferWasEmpty = IsBufferEmpty ();
+    uint32_t numPackets = 0;
+    if (ccfs) {
+        // The CCFS path sends the whole buffer in one datagram, so
+        // the frame's packets are sent one by one, as they are split
+        for (uint32_t bytesLeft = frameBytes; bytesLeft > 0; ++numPackets) {
+            const auto bytesToSend = std::min (bytesLeft, DEFAULT_PACKET_SIZE);
+            PushToBuffer (bytesToSend, 0);
+            SendOverSleep (m_rateShapingBytes);
+            bytesLeft -= bytesToSend;
+        }
+    } else {
+        numPackets = PushToBuffer (frameBytes, 0);
+    }
+
+    NS_LOG_INFO ("RmcatSender::EnqueueFrame, frame enqueued, frame length: " << frameBytes
+                 << ", packets: " << numPackets
+                 << ", buffer size: " << m_rateShapingBuf.size ()
+                 << ", buffer bytes: " << m_rateShapingBytes);
+
+    const double secsToNextEnqFrame = codec->second;
+    Time tNext{Seconds (secsToNextEnqFrame)};
+    m_enqueueEvent = Simulator::Schedule (tNext, &RmcatSender::EnqueuePacket, this);
+
+    if (ccfs) {
+        return;
+    }
+
+    if (!USE_BUFFER) {
+        for (uint32_t i = 0; i < numPackets; ++i) {
+            m_sendEvent = Simulator::ScheduleNow (&RmcatSender::SendPacket, this,
+                                                  secsToNextEnqFrame * 1000. / numPackets);
+        }
+        return;
+    }
+
+    if (bufferWasEmpty) {
+        StartSendTimer (Simulator::Now ().GetMicroSeconds ());
     }
 }
 
+void RmcatSender::EnqueueLayer (uint32_t layer)
+{
+    NS_ASSERT (layer < m_layers.size ());
+    auto& mediaLayer = m_layers[layer];
+    NS_ASSERT (mediaLayer.rate > 0.f);
+    syncodecs::Codec& codec = *mediaLayer.codec;
+    codec.setTargetRate (mediaLayer.rate);
+    ++codec; // Advance codec/packetizer to next frame/packet
+    const uint32_t bytes = codec->first.size ();
+    NS_ASSERT (bytes > 0);
+    NS_ASSERT (m_frameGranular || bytes <= DEFAULT_PACKET_SIZE);
+
+    const bool bufferWasEmpty = IsBufferEmpty ();
+    const auto numPackets = PushToBuffer (bytes, layer);
+
+    NS_LOG_INFO ("RmcatSender::EnqueueLayer, layer " << layer << " enqueued " << bytes
+                 << " bytes in " << numPackets << " packets"
+                 << ", buffer size: " << m_rateShapingBuf.size ()
+                 << ", buffer bytes: " << m_rateShapingBytes);
+
+    const double secsToNextEnq = codec->second;
+    Time tNext{Seconds (secsToNextEnq)};
+    mediaLayer.enqueueEvent = Simulator::Schedule (tNext, &RmcatSender::EnqueueLayer, this, layer);
+
+    if (!USE_BUFFER) {
+        for (uint32_t i = 0; i < numPackets; ++i) {
+            m_sendEvent = Simulator::ScheduleNow (&RmcatSender::SendPacket, this,
+                                                  secsToNextEnq * 1000. / numPackets);
+        }
+        return;
+    }
+
+    if (bufferWasEmpty) {
+        StartSendTimer (Simulator::Now ().GetMicroSeconds ());
+    }
+}
+
+uint32_t RmcatSender::PushToBuffer (uint32_t bytes, uint32_t layer)
+{
+    // Frames are split into packets of at most DEFAULT_PACKET_SIZE
+    uint32_t numPackets = 0;
+    for (uint32_t bytesLeft = bytes; bytesLeft > 0; ++numPackets) {
+        const auto bytesToSend = std::min (bytesLeft, DEFAULT_PACKET_SIZE);
+        const BufferedPacket packet = { bytesToSend, layer };
+        m_rateShapingBuf.push_back (packet);
+        m_rateShapingBytes += bytesToSend;
+        bytesLeft -= bytesToSend;
+    }
+    return numPackets;
+}
+
 void RmcatSender::SendPacket (uint64_t usSlept)
 {
-    NS_ASSERT (m_rateShapingBuf.size () > 0);
+    NS_ASSERT (!IsBufferEmpty ());
     NS_ASSERT (m_rateShapingBytes < MAX_QUEUE_SIZE_SANITY);
 
-    const auto bytesToSend = m_rateShapingBuf.front ();
+    // Retransmissions go first, then parity packets
+    const bool rtx = !m_rtxQueue.empty ();
+    const bool fec = !rtx && !m_fecQueue.empty ();
+    uint32_t bytesToSend = 0;
+    if (rtx) {
+        bytesToSend = m_rtxQueue.front ().size + RMCAT_RTX_OSN_SIZE;
+    } else if (fec) {
+        bytesToSend = m_fecQueue.front ().size;
+    } else {
+        bytesToSend = m_rateShapingBuf.front ().size;
+    }
     NS_ASSERT (bytesToSend > 0);
-    NS_ASSERT (bytesToSend <= DEFAULT_PACKET_SIZE);
-    m_rateShapingBuf.pop_front ();
-    NS_ASSERT (m_rateShapingBytes >= bytesToSend);
-    m_rateShapingBytes -= bytesToSend;
+    NS_ASSERT (bytesToSend <= DEFAULT_PACKET_SIZE + (rtx ? RMCAT_RTX_OSN_SIZE : 0) +
+                                                    (fec ? RMCAT_FEC_HEADER_SIZE : 0));
 
-    NS_LOG_INFO ("RmcatSender::SendPacket, packet dequeued, packet length: " << bytesToSend
-                 << ", buffer size: " << m_rateShapingBuf.size ()
-                 << ", buffer bytes: " << m_rateShapingBytes);
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    if (!m_controller->canSendPacket (nowUs, bytesToSend)) {
+        // Window-based controller: keep the packet in the buffer until
+        // feedback opens the window. Retry meanwhile, as the controller
+        // gives up on the packets in flight if feedback is lost
+        NS_LOG_INFO ("RmcatSender::SendPacket, window full, holding packet, buffer size: "
+                     << m_rateShapingBuf.size ());
+        m_windowBlocked = true;
+        Time tRetry{MicroSeconds (RMCAT_WINDOW_RETRY_US)};
+        m_sendEvent = Simulator::Schedule (tRetry, &RmcatSender::SendPacket, this,
+                                           RMCAT_WINDOW_RETRY_US);
+        return;
+    }
+    m_windowBlocked = false;
 
     // Synthetic oversleep: random uniform [0% .. 1%]
     uint64_t oversleepUs = usSlept * (rand () % 100) / 10000;
     Time tOver{MicroSeconds (oversleepUs)};
-    m_sendOversleepEvent = Simulator::Schedule (tOver, &RmcatSender::SendOverSleep,
-                                                this, bytesToSend);
+    if (rtx) {
+        const auto record = m_rtxQueue.front ();
+        m_rtxQueue.pop_front ();
+        NS_ASSERT (m_rateShapingBytes >= record.size);
+        m_rateShapingBytes -= record.size;
+        NS_LOG_INFO ("RmcatSender::SendPacket, retransmission dequeued, original sequence: "
+                     << record.sequence << ", packet length: " << bytesToSend);
+        m_sendOversleepEvent = Simulator::Schedule (tOver, &RmcatSender::SendRtxOverSleep,
+                                                    this, record.sequence, bytesToSend,
+                                                    record.sendUs, record.mediaIndex);
+    } else if (fec) {
+        const auto parity = m_fecQueue.front ();
+        m_fecQueue.pop_front ();
+        NS_ASSERT (m_rateShapingBytes >= parity.size);
+        m_rateShapingBytes -= parity.size;
+        NS_LOG_INFO ("RmcatSender::SendPacket, parity packet dequeued, base sequence: "
+                     << parity.baseSequence << ", packet length: " << bytesToSend);
+        m_sendOversleepEvent = Simulator::Schedule (tOver, &RmcatSender::SendFecOverSleep,
+                                                    this, parity);
+    } else {
+        const auto layer = m_rateShapingBuf.front ().layer;
+        m_rateShapingBuf.pop_front ();
+        NS_ASSERT (m_rateShapingBytes >= bytesToSend);
+        m_rateShapingBytes -= bytesToSend;
+
+        NS_LOG_INFO ("RmcatSender::SendPacket, packet dequeued, packet length: " << bytesToSend
+                     << ", buffer size: " << m_rateShapingBuf.size ()
+                     << ", buffer bytes: " << m_rateShapingBytes);
+
+        m_sendOversleepEvent = Simulator::Schedule (tOver, &RmcatSender::SendOverSleep,
+                                                    this, bytesToSend, layer);
+    }
 
     // schedule next sendData
     const double usToNextSentPacketD = double (bytesToSend) * 8. * 1000. * 1000. / m_rSend;
     const uint64_t usToNextSentPacket = uint64_t (usToNextSentPacketD);
 
-    if (!USE_BUFFER || m_rateShapingBuf.size () == 0) {
+    if (!USE_BUFFER || IsBufferEmpty ()) {
         // Buffer became empty
-        const auto nowUs = Simulator::Now ().GetMicroSeconds ();
         m_nextSendTstmpUs = nowUs + usToNextSentPacket;
         return;
     }
@@ -331,7 +611,7 @@ void RmcatSender::SendPacket (uint64_t usSlept)
     m_sendEvent = Simulator::Schedule (tNext, &RmcatSender::SendPacket, this, usToNextSentPacket);
 }
 
-void RmcatSender::SendOverSleep (uint32_t bytesToSend) {
+void RmcatSender::SendOverSleep (uint32_t bytesToSend, uint32_t layer) {
     const auto nowUs = Simulator::Now ().GetMicroSeconds ();
 
     if(m_algo == "ccfs" || m_algo == "CCFS")
@@ -345,20 +625,96 @@ void RmcatSender::SendOverSleep (uint32_t bytesToSend) {
     else
     {
         m_controller->processSendPacket (nowUs, m_sequence, bytesToSend);
+        if (m_rtxEnabled) {
+            StoreForRtx (nowUs, m_sequence, bytesToSend, m_mediaIndex);
+        }
+        if (m_fecEnabled) {
+            AddToFecGroup (m_sequence, bytesToSend, m_mediaIndex);
+        }
     }
+    CaptureSend (nowUs, m_sequence, bytesToSend);
+
+    auto packet = Create<Packet> (bytesToSend);
+    if (m_rtxEnabled || m_fecEnabled) {
+        packet->AddPacketTag (MediaIndexTag{m_mediaIndex++});
+    }
+    // 96: dynamic payload type, according to RFC 3551
+    SendRtpPacket (packet, 96, nowUs, false, layer);
+}
+
+void RmcatSender::SendRtxOverSleep (uint16_t origSequence, uint32_t bytesToSend,
+                                    uint64_t origSendUs, uint16_t mediaIndex)
+{
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    // The retransmission is a packet of its own to the congestion controller
+    m_controller->processSendPacket (nowUs, m_sequence, bytesToSend);
+    CaptureSend (nowUs, m_sequence, bytesToSend);
+
+    // rfc4588: the original sequence number leads the original payload.
+    // On a layered source, that is the transport-wide sequence number
+    std::vector<uint8_t> payload (bytesToSend, 0);
+    NS_ASSERT (bytesToSend >= RMCAT_RTX_OSN_SIZE);
+    payload[0] = uint8_t (origSequence >> 8);
+    payload[1] = uint8_t (origSequence & 0xff);
+    auto packet = Create<Packet> (payload.data (), bytesToSend);
+    packet->AddPacketTag (MediaIndexTag{mediaIndex});
+    // Same timestamp as the original packet
+    SendRtpPacket (packet, RMCAT_RTX_PAYLOAD_TYPE, origSendUs);
+}
+
+void RmcatSender::SendFecOverSleep (FecParity parity)
+{
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    // Parity packets are charged to the congestion controller too
+    m_controller->processSendPacket (nowUs, m_sequence, parity.size);
+    CaptureSend (nowUs, m_sequence, parity.size);
+
+    // FEC header, then the XOR of the protected payloads. These are all
+    // zeroes; the XOR of their media indexes goes along in the tag
+    std::vector<uint8_t> payload (parity.size, 0);
+    NS_ASSERT (parity.size >= RMCAT_FEC_HEADER_SIZE);
+    payload[0] = uint8_t (parity.baseSequence >> 8);
+    payload[1] = uint8_t (parity.baseSequence & 0xff);
+    payload[2] = uint8_t (parity.lengthRecovery >> 8);
+    payload[3] = uint8_t (parity.lengthRecovery & 0xff);
+    payload[4] = uint8_t (parity.mask >> 24);
+    payload[5] = uint8_t ((parity.mask >> 16) & 0xff);
+    payload[6] = uint8_t ((parity.mask >> 8) & 0xff);
+    payload[7] = uint8_t (parity.mask & 0xff);
+    auto packet = Create<Packet> (payload.data (), parity.size);
+    packet->AddPacketTag (MediaIndexTag{parity.indexXor});
+    SendRtpPacket (packet, RMCAT_FEC_PAYLOAD_TYPE, nowUs);
+}
 
-    ns3::RtpHeader header{96}; // 96: dynamic payload type, according to RFC 3551
-    header.SetSequence (m_sequence++);
-    NS_ASSERT (nowUs >= 0);
+void RmcatSender::SendRtpPacket (Ptr<Packet> packet, uint8_t payloadType, uint64_t captureUs,
+                                 bool padding, uint32_t layer)
+{
+    ns3::RtpHeader header{payloadType};
+    header.SetPadding (padding);
+    // The sequence number the congestion controller knows the packet by
+    const uint16_t flowSequence = m_sequence++;
+    uint16_t sequence = flowSequence;
+    if (!m_layers.empty ()) {
+        // Each SSRC has a sequence number space of its own
+        auto& mediaLayer = m_layers[layer];
+        sequence = mediaLayer.sequence++;
+        if (!mediaLayer.flowSequences.empty ()) {
+            mediaLayer.flowSequences[sequence] = flowSequence;
+        }
+    }
+    header.SetSequence (sequence);
     // Most video payload types in RFC 3551, Table 5, use a 90 KHz clock
     // Therefore, assuming 90 KHz clock for RTP timestamps
-    header.SetTimestamp (m_rtpTsOffset + uint32_t (nowUs * 90 / 1000));;
-    header.SetSsrc (m_ssrc);
+    header.SetTimestamp (m_rtpTsOffset + uint32_t (captureUs * 90 / 1000));
+    header.SetSsrc (GetLayerSsrc (layer));
+    if (m_hdrExtEnabled) {
+        header.SetAbsSendTime (Simulator::Now ().GetMicroSeconds ());
+        header.SetTransportSequence (flowSequence);
+    }
 
-    auto packet = Create<Packet> (bytesToSend);
     packet->AddHeader (header);
 
-    NS_LOG_INFO ("RmcatSender::SendOverSleep, " << packet->ToString ());
+    NS_LOG_INFO ("RmcatSender::SendRtpPacket, " << packet->ToString ());
     m_socket->SendTo (packet, 0, InetSocketAddress{m_destIP, m_destPort});
 }
 
@@ -381,6 +737,15 @@ void RmcatSender::RecvPacket (Ptr<Socket> socket)
         RfbHeader header {};
         Packet->RemoveHeader (header);
 
+        if (m_capture) {
+            std::vector<std::pair<uint16_t, RfbHeader::MetricBlock> > metrics{};
+            header.GetMetricList (m_ssrc, metrics);
+            for (const auto& item : metrics) {
+                CaptureFeedback (nowUs, item.first,
+                                 item.second.m_timestampMs * 1000, item.second.m_ecn);
+            }
+        }
+
         auto *vcc = dynamic_cast<rmcat::CcfsController *>(m_controller.get());
         vcc->processFeedback2(nowUs, header);
 
@@ -390,20 +755,54 @@ void RmcatSender::RecvPacket (Ptr<Socket> socket)
         return;
     }
 
-    CCFeedbackHeader header{};
     NS_LOG_INFO ("RmcatSender::RecvPacket, " << Packet->ToString ());
+    RtcpHeader commonHeader{};
+    Packet->PeekHeader (commonHeader);
+    if (commonHeader.GetPacketType () == RtcpHeader::RTP_FB &&
+        commonHeader.GetTypeOrCount () == RtcpHeader::RTCP_RTPFB_GNACK) {
+        GenericNackHeader nackHeader{};
+        Packet->RemoveHeader (nackHeader);
+        ProcessNack (nowUs, nackHeader);
+        return;
+    }
+    if (RembHeader::IsRemb (commonHeader)) {
+        RembHeader rembHeader{};
+        Packet->RemoveHeader (rembHeader);
+        ProcessRemb (nowUs, rembHeader);
+        return;
+    }
+
+    CCFeedbackHeader header{};
     Packet->RemoveHeader (header);
-    std::set<uint32_t> ssrcList{};
-    header.GetSsrcList (ssrcList);
-    if (ssrcList.count (m_ssrc) == 0) {
+    std::vector<std::pair<uint16_t,
+                      CCFeedbackHeader::MetricBlock> > feedback{};
+    const uint32_t numLayers = std::max<uint32_t> (m_layers.size (), 1);
+    for (uint32_t layer = 0; layer < numLayers; ++layer) {
+        std::vector<std::pair<uint16_t,
+                          CCFeedbackHeader::MetricBlock> > layerFeedback{};
+        if (header.GetMetricList (GetLayerSsrc (layer), layerFeedback)) {
+            if (!m_layers.empty () && !m_layers[layer].flowSequences.empty ()) {
+                // Feedback on the layer's RTP sequence numbers
+                for (auto& item : layerFeedback) {
+                    item.first = m_layers[layer].flowSequences[item.first];
+                }
+            }
+            feedback.insert (feedback.end (), layerFeedback.begin (), layerFeedback.end ());
+        }
+    }
+    if (feedback.empty ()) {
         NS_LOG_INFO ("RmcatSender::Received Feedback packet with no data for SSRC " << m_ssrc);
         CalcBufferParams (nowUs);
         return;
     }
-    std::vector<std::pair<uint16_t,
-                      CCFeedbackHeader::MetricBlock> > feedback{};
-    const bool res = header.GetMetricList (m_ssrc, feedback);
-    NS_ASSERT (res);
+    if (numLayers > 1) {
+        // Back to the flow's sending order
+        std::sort (feedback.begin (), feedback.end (),
+                   [] (const std::pair<uint16_t, CCFeedbackHeader::MetricBlock>& a,
+                       const std::pair<uint16_t, CCFeedbackHeader::MetricBlock>& b) {
+                       return uint16_t (a.first - b.first) >= 0x8000; //this wraps properly
+                   });
+    }
     std::vector<rmcat::SenderBasedController::FeedbackItem> fbBatch{};
     for (auto& item : feedback) {
         const rmcat::SenderBasedController::FeedbackItem fbItem{
@@ -412,16 +811,31 @@ void RmcatSender::RecvPacket (Ptr<Socket> socket)
             .ecn = item.second.m_ecn
         };
         fbBatch.push_back (fbItem);
+        CaptureFeedback (nowUs, fbItem.sequence, fbItem.rxTimestampUs, fbItem.ecn);
     }
     m_controller->processFeedbackBatch (nowUs, fbBatch);
+    if (m_rtxEnabled) {
+        (void) m_controller->getCurrentRTT (m_rttUs);
+    }
+    if (m_fecEnabled && m_fecGroupSize == 0) {
+        UpdateFecProtection ();
+    }
+    UpdateFseGroups (nowUs);
     CalcBufferParams (nowUs);
+    StartProbeCluster ();
+
+    if (m_windowBlocked && USE_BUFFER) {
+        // Self-clocking: the feedback may have opened the window
+        Simulator::Cancel (m_sendEvent);
+        m_sendEvent = Simulator::ScheduleNow (&RmcatSender::SendPacket, this, uint64_t (0));
+    }
 
 }
 
 void RmcatSender::CalcBufferParams (uint64_t nowUs)
 {
     //Calculate rate shaping buffer parameters
-    const auto r_ref = m_controller->getBandwidth (nowUs); // bandwidth in bps
+    const auto r_ref = GetReferenceRate (nowUs); // bandwidth in bps
     float bufferLen;
     //Purpose: smooth out timing issues between send and receive
     // feedback for the common case: buffer oscillating between 0 and 1 packets
@@ -431,12 +845,15 @@ void RmcatSender::CalcBufferParams (uint64_t nowUs)
         bufferLen = 0;
     }
 
-    syncodecs::Codec& codec = *m_codec;
+    // The base layer sets the pace of a layered source
+    syncodecs::Codec& codec = m_layers.empty () ? *m_codec : *m_layers.front ().codec;
 
     // TODO (deferred): encapsulate rate shaping buffer in a separate class
+    // Parity packets take their share of the rate off the encoder's
+    const float mediaShare = GetFecMediaShare ();
     if (USE_BUFFER && static_cast<bool> (codec)) {
         const float fps = 1. / static_cast<float>  (codec->second);
-        m_rVin = std::max<float> (m_minBw, r_ref - BETA_V * 8. * bufferLen * fps);
+        m_rVin = std::max<float> (m_minBw, r_ref * mediaShare - BETA_V * 8. * bufferLen * fps);
         m_rSend = r_ref + BETA_S * 8. * bufferLen * fps;
         NS_LOG_INFO ("New rate shaping buffer parameters: r_ref " << r_ref
                      << ", m_rVin " << m_rVin
@@ -444,13 +861,423 @@ void RmcatSender::CalcBufferParams (uint64_t nowUs)
                      << ", fps " << fps
                      << ", buffer length " << bufferLen);
     } else {
-        m_rVin = r_ref;
+        m_rVin = r_ref * mediaShare;
         m_rSend = r_ref;
     }
+    if (!m_layers.empty ()) {
+        AllocateLayers (m_rVin);
+    }
+}
+
+void RmcatSender::AllocateLayers (float rate)
+{
+    // Minimum rates first, from the base layer up
+    std::vector<float> rates (m_layers.size (), 0.f);
+    float rateLeft = rate;
+    size_t numActive = 0;
+    for (; numActive < m_layers.size (); ++numActive) {
+        const auto& layer = m_layers[numActive];
+        const auto minRate = layer.rate > 0.f ? layer.minRate :
+                                                layer.minRate * RMCAT_LAYER_ON_FACTOR;
+        if (numActive > 0 && minRate > rateLeft) {
+            break;
+        }
+        // The base layer is never dropped
+        rates[numActive] = layer.minRate;
+        rateLeft = std::max (rateLeft - layer.minRate, 0.f);
+    }
+    // Then up to the maximum rates, in the same order
+    for (size_t i = 0; i < numActive; ++i) {
+        const auto extra = std::min (rateLeft, m_layers[i].maxRate - rates[i]);
+        rates[i] += extra;
+        rateLeft -= extra;
+    }
+
+    for (uint32_t i = 0; i < m_layers.size (); ++i) {
+        auto& layer = m_layers[i];
+        const bool wasActive = layer.rate > 0.f;
+        layer.rate = rates[i];
+        if (!wasActive && layer.rate > 0.f) {
+            NS_LOG_INFO ("RmcatSender::AllocateLayers, layer " << i << " on, target rate " << rate);
+            layer.enqueueEvent = Simulator::ScheduleNow (&RmcatSender::EnqueueLayer, this, i);
+        } else if (wasActive && layer.rate == 0.f) {
+            NS_LOG_INFO ("RmcatSender::AllocateLayers, layer " << i << " off, target rate " << rate);
+            Simulator::Cancel (layer.enqueueEvent);
+        }
+    }
+}
+
+uint32_t RmcatSender::GetLayerSsrc (uint32_t layer) const
+{
+    return m_ssrc + layer;
+}
+
+bool RmcatSender::IsOwnSsrc (uint32_t ssrc) const
+{
+    const uint32_t numLayers = std::max<uint32_t> (m_layers.size (), 1);
+    return uint32_t (ssrc - m_ssrc) < numLayers;
+}
+
+float RmcatSender::GetReferenceRate (uint64_t nowUs)
+{
+    const auto ccRate = m_controller->getBandwidth (nowUs);
+    if (!m_fseRegistered) {
+        return ccRate;
+    }
+    auto fseRate = m_fse->update (m_fseId, ccRate);
+    fseRate = std::min (std::max (fseRate, m_minBw), m_maxBw);
+    // Active FSE: the controller carries on from the coupled rate
+    if (fseRate != ccRate) {
+        m_controller->setCurrentBw (fseRate);
+    }
+    NS_LOG_INFO ("RmcatSender::GetReferenceRate, controller rate " << ccRate
+                 << ", coupled rate " << fseRate);
+    return fseRate;
+}
+
+void RmcatSender::UpdateFseGroups (uint64_t nowUs)
+{
+    if (!m_fseRegistered || !m_fse->isSbdEnabled ()) {
+        return;
+    }
+    m_controller->getNewAckedPackets (m_fseAcked);
+    for (const auto& packet : m_fseAcked) {
+        m_fse->addOwdSample (m_fseId, packet.sequence, packet.owdUs);
+    }
+    m_fse->updateGroups (nowUs);
+}
+
+void RmcatSender::SetRtxEnabled (bool enable)
+{
+    m_rtxEnabled = enable;
+}
+
+void RmcatSender::StoreForRtx (uint64_t nowUs, uint16_t sequence, uint32_t size,
+                               uint16_t mediaIndex)
+{
+    // The cache holds a few RTTs worth of packets: older ones would not
+    // make it in time anyway
+    const uint64_t historyUs = std::max<uint64_t> (RMCAT_RTX_HISTORY_RTTS * m_rttUs,
+                                                   RMCAT_RTX_MIN_HISTORY_US);
+    while (!m_rtxHistory.empty () && m_rtxHistory.front ().sendUs + historyUs < nowUs) {
+        m_rtxHistory.pop_front ();
+    }
+    const RtxRecord record = { sequence, size, nowUs, 0, 0, mediaIndex };
+    m_rtxHistory.push_back (record);
+}
+
+void RmcatSender::ProcessNack (uint64_t nowUs, const GenericNackHeader& header)
+{
+    if (!m_rtxEnabled || !IsOwnSsrc (header.GetMediaSsrc ()) || m_rtxHistory.empty ()) {
+        return;
+    }
+    const bool bufferWasEmpty = IsBufferEmpty ();
+    // Sequence numbers increase (with wrapping) along the history: binary
+    // search on the offset from the oldest packet
+    const uint16_t firstSeq = m_rtxHistory.front ().sequence;
+    for (const auto seq : header.GetNackList ()) {
+        const uint16_t offset = seq - firstSeq; //this wraps properly
+        auto it = std::lower_bound (m_rtxHistory.begin (), m_rtxHistory.end (), offset,
+                                    [firstSeq] (const RtxRecord& r, uint16_t off) {
+                                        return uint16_t (r.sequence - firstSeq) < off;
+                                    });
+        if (it == m_rtxHistory.end () || it->sequence != seq) {
+            // Too old, or a retransmission itself: the receiver NACKs
+            // the original packet again anyway
+            NS_LOG_INFO ("RmcatSender::ProcessNack, packet " << seq << " not in history");
+            continue;
+        }
+        auto& record = *it;
+        if (record.numRtx > 0 && nowUs < record.lastRtxUs + m_rttUs) {
+            // Retransmitted less than one RTT ago
+            continue;
+        }
+        record.lastRtxUs = nowUs;
+        ++record.numRtx;
+        m_rtxQueue.push_back (record);
+        m_rateShapingBytes += record.size;
+        NS_LOG_INFO ("RmcatSender::ProcessNack, queued retransmission of packet " << seq
+                     << ", attempt " << record.numRtx);
+    }
+
+    if (bufferWasEmpty && !m_rtxQueue.empty ()) {
+        StartSendTimer (nowUs);
+    }
+}
+
+void RmcatSender::ProcessRemb (uint64_t nowUs, const RembHeader& header)
+{
+    auto remb = dynamic_cast<rmcat::RembController*> (m_controller.get ());
+    const auto& ssrcs = header.GetSsrcs ();
+    const bool ours = std::any_of (ssrcs.begin (), ssrcs.end (),
+                                   [this] (uint32_t ssrc) { return IsOwnSsrc (ssrc); });
+    if (remb == nullptr || !ours) {
+        NS_LOG_INFO ("RmcatSender::ProcessRemb, REMB message ignored");
+        return;
+    }
+    remb->processRemb (nowUs, float (header.GetBitrate ()));
+    UpdateFseGroups (nowUs);
+    CalcBufferParams (nowUs);
 }
+
+bool RmcatSender::IsBufferEmpty () const
+{
+    return m_rateShapingBuf.empty () && m_rtxQueue.empty () && m_fecQueue.empty ();
+}
+
+void RmcatSender::StartSendTimer (uint64_t nowUs)
+{
+    const uint64_t usToNextSentPacket = nowUs < m_nextSendTstmpUs ?
+                                                m_nextSendTstmpUs - nowUs : 0;
+    Time tNext{MicroSeconds (usToNextSentPacket)};
+    m_sendEvent = Simulator::Schedule (tNext, &RmcatSender::SendPacket, this, usToNextSentPacket);
+}
+
+void RmcatSender::SetFecEnabled (bool enable, uint32_t groupSize)
+{
+    NS_ASSERT (groupSize == 0 ||
+               (groupSize >= RMCAT_FEC_MIN_GROUP && groupSize <= RMCAT_FEC_MAX_GROUP));
+    m_fecEnabled = enable;
+    m_fecGroupSize = groupSize;
+    m_fecCurrentGroup = enable ? groupSize : 0;
+    m_fecPendingCount = 0;
+}
+
+void RmcatSender::AddToFecGroup (uint16_t sequence, uint32_t size, uint16_t mediaIndex)
+{
+    if (m_fecCurrentGroup == 0) {
+        return;
+    }
+    if (m_fecPendingCount > 0) {
+        const uint16_t offset = sequence - m_fecPending.baseSequence; //this wraps properly
+        if (offset == 0 || offset > RMCAT_FEC_MASK_BITS) {
+            // Out of the mask's reach, e.g., after many retransmissions
+            CloseFecGroup ();
+        }
+    }
+    if (m_fecPendingCount == 0) {
+        const FecParity parity = { sequence, 0, 0, 0, 0 };
+        m_fecPending = parity;
+    } else {
+        const uint16_t offset = sequence - m_fecPending.baseSequence;
+        m_fecPending.mask |= (uint32_t (1) << (RMCAT_FEC_MASK_BITS - offset));
+    }
+    m_fecPending.lengthRecovery ^= uint16_t (size);
+    m_fecPending.indexXor ^= mediaIndex;
+    m_fecPending.size = std::max (m_fecPending.size, size);
+    ++m_fecPendingCount;
+    if (m_fecPendingCount >= m_fecCurrentGroup) {
+        CloseFecGroup ();
+    }
+}
+
+void RmcatSender::CloseFecGroup ()
+{
+    if (m_fecPendingCount == 0) {
+        return;
+    }
+    const bool bufferWasEmpty = IsBufferEmpty ();
+    auto parity = m_fecPending;
+    parity.size += RMCAT_FEC_HEADER_SIZE;
+    m_fecQueue.push_back (parity);
+    m_rateShapingBytes += parity.size;
+    m_fecPendingCount = 0;
+    if (bufferWasEmpty) {
+        StartSendTimer (Simulator::Now ().GetMicroSeconds ());
+    }
+}
+
+void RmcatSender::UpdateFecProtection ()
+{
+    uint32_t nLoss = 0;
+    float plr = 0.f;
+    if (!m_controller->getPktLossInfo (nLoss, plr)) {
+        return;
+    }
+    // More losses, smaller groups
+    uint32_t groupSize = 0;
+    if (plr >= RMCAT_FEC_MIN_LOSS) {
+        const auto size = uint32_t (1.f / (RMCAT_FEC_LOSS_FACTOR * plr));
+        groupSize = std::min (std::max (size, RMCAT_FEC_MIN_GROUP), RMCAT_FEC_MAX_GROUP);
+    }
+    if (groupSize == m_fecCurrentGroup) {
+        return;
+    }
+    NS_LOG_INFO ("RmcatSender::UpdateFecProtection, loss rate " << plr
+                 << ", media packets per parity packet: " << groupSize);
+    m_fecCurrentGroup = groupSize;
+    if (m_fecPendingCount >= groupSize) {
+        CloseFecGroup ();
+    }
+}
+
+void RmcatSender::SetProbingEnabled (bool enable)
+{
+    m_probingEnabled = enable;
+}
+
+void RmcatSender::SetHeaderExtensionsEnabled (bool enable)
+{
+    m_hdrExtEnabled = enable;
+}
+
+void RmcatSender::StartProbeCluster ()
+{
+    if (!m_probingEnabled || m_paused || m_probeCluster.id != 0) {
+        return;
+    }
+    if (m_algo == "ccfs" || m_algo == "CCFS") {
+        return;
+    }
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    rmcat::ProbeCluster cluster{};
+    if (!m_controller->getProbeRequest (nowUs, cluster)) {
+        return;
+    }
+    NS_ASSERT (cluster.id != 0);
+    NS_ASSERT (cluster.rateBps > 0.);
+    NS_LOG_INFO ("RmcatSender::StartProbeCluster, cluster " << cluster.id
+                 << ", rate " << cluster.rateBps << " bps, min packets " << cluster.minPackets
+                 << ", min bytes " << cluster.minBytes);
+    m_probeCluster = cluster;
+    m_probePacketsSent = 0;
+    m_probeBytesSent = 0;
+    m_probeEvent = Simulator::ScheduleNow (&RmcatSender::SendProbePacket, this);
+}
+
+void RmcatSender::SendProbePacket ()
+{
+    NS_ASSERT (m_probeCluster.id != 0);
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    const bool rtx = m_rtxEnabled && !m_rtxHistory.empty ();
+    const uint32_t bytesToSend = rtx ? m_rtxHistory.back ().size + RMCAT_RTX_OSN_SIZE :
+                                       RMCAT_PROBE_PADDING_SIZE;
+    if (!m_controller->canSendPacket (nowUs, bytesToSend)) {
+        // The window is full, no point in probing any further
+        NS_LOG_INFO ("RmcatSender::SendProbePacket, cluster " << m_probeCluster.id
+                     << " cut short after " << m_probePacketsSent << " packets");
+        m_probeCluster.id = 0;
+        return;
+    }
+
+    const uint16_t sequence = m_sequence;
+    if (rtx) {
+        const auto& record = m_rtxHistory.back ();
+        SendRtxOverSleep (record.sequence, bytesToSend, record.sendUs, record.mediaIndex);
+    } else {
+        SendPaddingPacket (bytesToSend);
+    }
+    const bool res = m_controller->markProbePacket (sequence, m_probeCluster.id);
+    NS_ASSERT (res);
+    (void) res;
+
+    ++m_probePacketsSent;
+    m_probeBytesSent += bytesToSend;
+    if (m_probePacketsSent >= m_probeCluster.minPackets &&
+        m_probeBytesSent >= m_probeCluster.minBytes) {
+        NS_LOG_INFO ("RmcatSender::SendProbePacket, cluster " << m_probeCluster.id
+                     << " sent: " << m_probePacketsSent << " packets, "
+                     << m_probeBytesSent << " bytes");
+        m_probeCluster.id = 0;
+        // The controller may want another one right away
+        StartProbeCluster ();
+        return;
+    }
+
+    const double usToNextProbe = double (bytesToSend) * 8. * 1000. * 1000. / m_probeCluster.rateBps;
+    Time tNext{MicroSeconds (uint64_t (usToNextProbe))};
+    m_probeEvent = Simulator::Schedule (tNext, &RmcatSender::SendProbePacket, this);
+}
+
+void RmcatSender::SendPaddingPacket (uint32_t bytesToSend)
+{
+    NS_ASSERT (bytesToSend > 0);
+    NS_ASSERT (bytesToSend <= RMCAT_PROBE_PADDING_SIZE);
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    m_controller->processSendPacket (nowUs, m_sequence, bytesToSend);
+    CaptureSend (nowUs, m_sequence, bytesToSend);
+
+    // rfc3550: the last octet of the padding is its length
+    std::vector<uint8_t> payload (bytesToSend, 0);
+    payload.back () = uint8_t (bytesToSend);
+    auto packet = Create<Packet> (payload.data (), bytesToSend);
+    SendRtpPacket (packet, 96, nowUs, true);
+}
+
+float RmcatSender::GetFecMediaShare () const
+{
+    if (m_fecCurrentGroup == 0) {
+        return 1.f;
+    }
+    return float (m_fecCurrentGroup) / float (m_fecCurrentGroup + 1);
+}
+
+void RmcatSender::SetFlowStateExchange (std::shared_ptr<rmcat::FlowStateExchange> fse,
+                                        float priority)
+{
+    NS_ASSERT (!m_fseRegistered);
+    NS_ASSERT (priority > 0);
+    m_fse = fse;
+    m_fsePriority = priority;
+}
+
+void RmcatSender::RegisterWithFse ()
+{
+    if (m_fse && !m_fseRegistered) {
+        m_fseId = m_fse->registerFlow (m_initBw, m_fsePriority);
+        // The encoder cannot make use of more than the maximum rate
+        m_fse->setDesiredRate (m_fseId, m_maxBw);
+        m_fseRegistered = true;
+    }
+}
+
+void RmcatSender::DeregisterFromFse ()
+{
+    if (m_fseRegistered) {
+        m_fse->deregisterFlow (m_fseId);
+        m_fseRegistered = false;
+    }
+}
+
 void RmcatSender::SetControllerName(std::string algo)
 {
     m_algo = algo;
     NS_LOG_INFO("Set Controller Name: " << m_algo);
 }
+
+void RmcatSender::EnableCapture (const std::string& path)
+{
+    m_capture.reset (new rmcat::ControllerTraceWriter{});
+    if (!m_capture->open (path)) {
+        NS_FATAL_ERROR ("Cannot create capture file " << path);
+    }
+    NS_LOG_INFO ("Capturing controller input to " << path);
+}
+
+void RmcatSender::CaptureSend (uint64_t nowUs, uint16_t sequence, uint32_t size)
+{
+    if (m_capture) {
+        rmcat::TraceRecord record{};
+        record.type = rmcat::TraceRecord::TRACE_RECORD_SEND;
+        record.sequence = sequence;
+        record.size = size;
+        record.timeUs = nowUs;
+        m_capture->write (record);
+    }
+}
+
+void RmcatSender::CaptureFeedback (uint64_t nowUs, uint16_t sequence,
+                                   uint64_t rxTimestampUs, uint8_t ecn)
+{
+    if (m_capture) {
+        rmcat::TraceRecord record{};
+        record.type = rmcat::TraceRecord::TRACE_RECORD_FEEDBACK;
+        record.ecn = ecn;
+        record.sequence = sequence;
+        record.timeUs = nowUs;
+        record.rxTimestampUs = rxTimestampUs;
+        m_capture->write (record);
+    }
+}
+
 }
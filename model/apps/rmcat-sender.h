@@ -29,11 +29,16 @@
 #define RMCAT_SENDER_H
 
 #include "rmcat-constants.h"
+#include "rtp-header.h"
 #include "ns3/syncodecs.h"
 #include "ns3/sender-based-controller.h"
+#include "ns3/controller-trace.h"
+#include "ns3/flow-state-exchange.h"
 #include "ns3/socket.h"
 #include "ns3/application.h"
+#include <deque>
 #include <memory>
+#include <vector>
 
 namespace ns3 {
 
@@ -49,6 +54,55 @@ public:
     void SetCodec (std::shared_ptr<syncodecs::Codec> codec);
     void SetCodecType (SyncodecType codecType);
 
+    /**
+     * Set the directory holding the video traces of SYNCODEC_TYPE_TRACE
+     * and SYNCODEC_TYPE_HYBRID codecs, for all senders. If not set, the
+     * traces are looked up once in the ns-3 source tree, relative to
+     * the usual working directories of test runs
+     *
+     * @param [in] path Path to the traces directory
+     */
+    static void SetTraceDirectory (const std::string& path);
+
+    /**
+     * Enqueue whole frames, split into packets, in a single simulator
+     * event per frame, rather than one event per packet as spaced out
+     * by a syncodecs::ShapedPacketizer. This divides the number of
+     * enqueuing events by the number of packets per frame. The rate
+     * shaping buffer then sees the actual frame rate. Must be called
+     * before #SetCodecType , which then leaves out the packetizer;
+     * codecs passed to #SetCodec are expected to output whole frames
+     *
+     * @param [in] enable Whether to enqueue whole frames
+     */
+    void SetFrameGranularEnqueue (bool enable);
+
+    /**
+     * Add a layer to a layered media source (simulcast streams or
+     * scalable layers), sent with an SSRC of its own, and RTP sequence
+     * numbers of their own (rfc3550). The layers share the flow's
+     * congestion controller, which knows packets by the flow's sequence
+     * numbers: the sender maps the feedback on each layer back to them,
+     * unless the feedback is on transport-wide sequence numbers (see
+     * #SetHeaderExtensionsEnabled). Retransmissions and FEC refer to
+     * packets by transport-wide sequence numbers on a layered source, so
+     * they turn header extensions on. The controller's target rate is
+     * split among the layers from the base layer up: each active layer
+     * gets its minimum rate, and the layers are then filled up to their
+     * maximum rate, in the same order. A layer whose minimum rate does
+     * not fit is dropped, along with the layers above it, so that rate
+     * cuts are absorbed by dropping layers, rather than by re-encoding
+     * all of them at a lower rate. The first layer added is the base
+     * layer, which is never dropped. Once a layer is added, the codec
+     * set with #SetCodec or #SetCodecType is no longer used. Must be
+     * called before the application starts. Not supported by CCFS
+     *
+     * @param [in] codec Codec producing the layer
+     * @param [in] minRate Rate below which the layer is dropped, in bps
+     * @param [in] maxRate Rate the layer gets at most, in bps
+     */
+    void AddLayer (std::shared_ptr<syncodecs::Codec> codec, float minRate, float maxRate);
+
     void SetController (std::shared_ptr<rmcat::SenderBasedController> controller);
 
     void SetRinit (float Rinit);
@@ -59,18 +113,119 @@ public:
 
     void SetControllerName(std::string algorithm);
 
+    /**
+     * Capture every packet sent and every feedback item received, as fed
+     * to the congestion controller, into a binary trace file. The trace
+     * can be replayed offline with the rmcat-replay program. The simulation
+     * stops with a fatal error if the file cannot be created
+     *
+     * @param [in] path Path to the trace file to create
+     */
+    void EnableCapture (const std::string& path);
+
+    /**
+     * Couple this flow's congestion controller with those of the other
+     * flows sharing the same Flow State Exchange (rfc8699), typically the
+     * other rmcat flows sent by the same host. The flow then sends at
+     * the coupled rate handed out by the FSE. Not supported by CCFS.
+     * Must be called before the application starts
+     *
+     * @param [in] fse Flow State Exchange shared by the coupled flows
+     * @param [in] priority Weight of this flow in the FSE (e.g., 2 for a
+     *                      camera flow and 1 for a screen share flow)
+     */
+    void SetFlowStateExchange (std::shared_ptr<rmcat::FlowStateExchange> fse,
+                               float priority);
+
+    /**
+     * Keep sent media packets for a few RTTs, and retransmit (rfc4588)
+     * those the receiver reports missing via RTCP Generic NACK (see
+     * RmcatReceiver::SetNackEnabled). Retransmissions go through the
+     * rate shaping buffer, ahead of new media, and are fed to the
+     * congestion controller like any other packet, so that they count
+     * towards the sending rate. Not supported by CCFS
+     */
+    void SetRtxEnabled (bool enable);
+
+    /**
+     * Protect media packets with XOR parity packets (forward error
+     * correction), for paths where retransmissions would come too late.
+     * Each parity packet covers a group of consecutive media packets,
+     * from which the receiver can recover any single loss. Parity
+     * packets are sent right after their group, and their share of the
+     * rate is taken off the encoder's target rate. Not supported by CCFS
+     *
+     * @param [in] enable Whether to send parity packets
+     * @param [in] groupSize Media packets per parity packet, or 0 to
+     *                       adapt it to the loss rate seen by the
+     *                       congestion controller (no parity without
+     *                       losses)
+     */
+    void SetFecEnabled (bool enable, uint32_t groupSize = 0);
+
+    /**
+     * Send the probe clusters the congestion controller asks for (see
+     * rmcat::SenderBasedController::getProbeRequest), so that it can
+     * find out about available bandwidth faster than the codec ramps
+     * up. Probe packets are sent on top of the media, at the cluster's
+     * rate; they are retransmissions of the latest media packet if
+     * retransmissions are enabled, or padding otherwise. Not supported
+     * by CCFS
+     */
+    void SetProbingEnabled (bool enable);
+
+    /**
+     * Tag every RTP packet with the abs-send-time and transport-wide
+     * sequence number header extensions (rfc8285). The receiver then
+     * reports feedback on the transport-wide sequence numbers in a single
+     * report block, whatever the number of layers (SSRCs), and it can
+     * run delay-based estimation off the send times
+     */
+    void SetHeaderExtensionsEnabled (bool enable);
+
 private:
     virtual void StartApplication ();
     virtual void StopApplication ();
 
     void EnqueuePacket ();
+    void EnqueueFrame ();
+    void EnqueueLayer (uint32_t layer);
+    uint32_t PushToBuffer (uint32_t bytes, uint32_t layer);
+    void AllocateLayers (float rate);
+    uint32_t GetLayerSsrc (uint32_t layer) const;
+    bool IsOwnSsrc (uint32_t ssrc) const;
+    syncodecs::Codec* Packetize (syncodecs::Codec* innerCodec) const;
     void SendPacket (uint64_t usSlept);
-    void SendOverSleep (uint32_t bytesToSend);
+    void SendOverSleep (uint32_t bytesToSend, uint32_t layer = 0);
+    void SendRtxOverSleep (uint16_t origSequence, uint32_t bytesToSend,
+                           uint64_t origSendUs, uint16_t mediaIndex);
+    void SendRtpPacket (Ptr<Packet> packet, uint8_t payloadType, uint64_t captureUs,
+                        bool padding = false, uint32_t layer = 0);
     void RecvPacket (Ptr<Socket> socket);
     void CalcBufferParams (uint64_t nowUs);
+    float GetReferenceRate (uint64_t nowUs);
+    void RegisterWithFse ();
+    void DeregisterFromFse ();
+    void UpdateFseGroups (uint64_t nowUs);
+    void StoreForRtx (uint64_t nowUs, uint16_t sequence, uint32_t size, uint16_t mediaIndex);
+    void ProcessNack (uint64_t nowUs, const GenericNackHeader& header);
+    void ProcessRemb (uint64_t nowUs, const RembHeader& header);
+    bool IsBufferEmpty () const;
+    void StartSendTimer (uint64_t nowUs);
+    void AddToFecGroup (uint16_t sequence, uint32_t size, uint16_t mediaIndex);
+    void CloseFecGroup ();
+    void UpdateFecProtection ();
+    float GetFecMediaShare () const;
+    void StartProbeCluster ();
+    void SendProbePacket ();
+    void SendPaddingPacket (uint32_t bytesToSend);
+    void CaptureSend (uint64_t nowUs, uint16_t sequence, uint32_t size);
+    void CaptureFeedback (uint64_t nowUs, uint16_t sequence,
+                          uint64_t rxTimestampUs, uint8_t ecn);
 
 private:
     std::shared_ptr<syncodecs::Codec> m_codec;
+    bool m_frameGranular;
     std::shared_ptr<rmcat::SenderBasedController> m_controller;
     Ipv4Address m_destIP;
     uint16_t m_destPort;
@@ -88,10 +243,71 @@ private:
 
     double m_rVin; //bps
     double m_rSend; //bps
-    std::deque<uint32_t> m_rateShapingBuf;
+    struct BufferedPacket {
+        uint32_t size;
+        uint32_t layer;
+    };
+    std::deque<BufferedPacket> m_rateShapingBuf;
     uint32_t m_rateShapingBytes;
     uint64_t m_nextSendTstmpUs;
+    bool m_windowBlocked;
     std::string m_algo;
+    std::unique_ptr<rmcat::ControllerTraceWriter> m_capture;
+    std::shared_ptr<rmcat::FlowStateExchange> m_fse;
+    float m_fsePriority;
+    uint32_t m_fseId;
+    bool m_fseRegistered;
+    std::vector<rmcat::SenderBasedController::PacketRecord> m_fseAcked;
+
+    uint16_t m_mediaIndex;
+
+    struct RtxRecord {
+        uint16_t sequence;
+        uint32_t size;
+        uint64_t sendUs;
+        uint64_t lastRtxUs;
+        uint32_t numRtx;
+        uint16_t mediaIndex;
+    };
+    bool m_rtxEnabled;
+    uint64_t m_rttUs;
+    std::deque<RtxRecord> m_rtxHistory;  /**< in sending order */
+    std::deque<RtxRecord> m_rtxQueue;    /**< retransmissions waiting to be sent */
+
+    struct FecParity {
+        uint16_t baseSequence;
+        uint32_t mask;            /**< bit i (MSB first): baseSequence + 1 + i */
+        uint16_t lengthRecovery;  /**< XOR of the protected payload lengths */
+        uint16_t indexXor;        /**< XOR of the protected media indexes */
+        uint32_t size;            /**< payload size of the parity packet */
+    };
+    void SendFecOverSleep (FecParity parity);
+
+    bool m_fecEnabled;
+    uint32_t m_fecGroupSize;      /**< configured, 0 if adaptive */
+    uint32_t m_fecCurrentGroup;   /**< in use, 0 if no protection */
+    FecParity m_fecPending;       /**< parity of the group being sent */
+    uint32_t m_fecPendingCount;
+    std::deque<FecParity> m_fecQueue;  /**< parity packets waiting to be sent */
+
+    bool m_probingEnabled;
+    rmcat::ProbeCluster m_probeCluster;  /**< being sent, id 0 if none */
+    uint32_t m_probePacketsSent;
+    uint32_t m_probeBytesSent;
+    EventId m_probeEvent;
+
+    struct MediaLayer {
+        std::shared_ptr<syncodecs::Codec> codec;
+        float minRate;
+        float maxRate;
+        float rate;             /**< allocated, 0 if dropped */
+        EventId enqueueEvent;
+        uint16_t sequence;      /**< next RTP sequence number of the layer's SSRC */
+        std::vector<uint16_t> flowSequences;  /**< flow's sequence numbers, by RTP sequence number */
+    };
+    std::vector<MediaLayer> m_layers;  /**< base layer first; empty if not layered */
+
+    bool m_hdrExtEnabled;
 };
 
 }
@@ -27,12 +27,16 @@
  */
 
 #include "rtp-header.h"
+#include <algorithm>
 
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (RtpHeader);
 NS_OBJECT_ENSURE_REGISTERED (RtcpHeader);
 NS_OBJECT_ENSURE_REGISTERED (CCFeedbackHeader);
+NS_OBJECT_ENSURE_REGISTERED (GenericNackHeader);
+NS_OBJECT_ENSURE_REGISTERED (RembHeader);
+NS_OBJECT_ENSURE_REGISTERED (MediaIndexTag);
 
 void RtpHdrSetBit (uint8_t& val, uint8_t pos, bool bit)
 {
@@ -59,7 +63,12 @@ RtpHeader::RtpHeader ()
 , m_sequence{0}
 , m_timestamp{0}
 , m_ssrc{0}
+, m_csrcCount{0}
 , m_csrcs{}
+, m_extCount{0}
+, m_extElements{}
+, m_extDataLength{0}
+, m_extData{}
 {}
 
 RtpHeader::RtpHeader (uint8_t payloadType)
@@ -71,7 +80,12 @@ RtpHeader::RtpHeader (uint8_t payloadType)
 , m_sequence{0}
 , m_timestamp{0}
 , m_ssrc{0}
+, m_csrcCount{0}
 , m_csrcs{}
+, m_extCount{0}
+, m_extElements{}
+, m_extDataLength{0}
+, m_extData{}
 {}
 
 RtpHeader::~RtpHeader () {}
@@ -92,20 +106,21 @@ TypeId RtpHeader::GetInstanceTypeId () const
 
 uint32_t RtpHeader::GetSerializedSize () const
 {
-    NS_ASSERT (m_csrcs.size () <= 0x0f);
+    NS_ASSERT (m_csrcCount <= RTP_MAX_CSRCS);
     return 2 + // First two octets
            sizeof (m_sequence)  +
            sizeof (m_timestamp) +
            sizeof (m_ssrc) +
-           (m_csrcs.size () & 0x0f) * sizeof (decltype (m_csrcs)::value_type);
+           (m_csrcCount & 0x0f) * sizeof (m_csrcs[0]) +
+           GetExtensionSize ();
 }
 
 void RtpHeader::Serialize (Buffer::Iterator start) const
 {
-    NS_ASSERT (m_csrcs.size () <= 0x0f);
+    NS_ASSERT (m_csrcCount <= RTP_MAX_CSRCS);
     NS_ASSERT (m_payloadType <= 0x7f);
 
-    const uint8_t csrcCount = (m_csrcs.size () & 0x0f);
+    const uint8_t csrcCount = (m_csrcCount & 0x0f);
     uint8_t octet1 = 0;
     octet1 |= (RTP_VERSION << 6);
     RtpHdrSetBit (octet1, 5, m_padding);
@@ -121,9 +136,33 @@ void RtpHeader::Serialize (Buffer::Iterator start) const
     start.WriteHtonU16 (m_sequence);
     start.WriteHtonU32 (m_timestamp);
     start.WriteHtonU32 (m_ssrc);
-    for (const auto& csrc : m_csrcs) {
-        start.WriteHtonU32 (csrc);
+    for (uint8_t i = 0; i < csrcCount; ++i) {
+        start.WriteHtonU32 (m_csrcs[i]);
     }
+    if (!m_extension) {
+        return;
+    }
+
+    const bool twoByte = UseTwoByteExtensions ();
+    const uint32_t extSize = GetExtensionSize ();
+    start.WriteHtonU16 (twoByte ? RTP_EXT_TWO_BYTE_PROFILE : RTP_EXT_ONE_BYTE_PROFILE);
+    start.WriteHtonU16 ((extSize - 4) / 4);
+    uint32_t written = 4;
+    for (uint8_t i = 0; i < m_extCount; ++i) {
+        const auto& elem = m_extElements[i];
+        if (twoByte) {
+            start.WriteU8 (elem.id);
+            start.WriteU8 (elem.length);
+            written += 2;
+        } else {
+            start.WriteU8 (uint8_t (elem.id << 4) | uint8_t (elem.length - 1));
+            ++written;
+        }
+        start.Write (m_extData + elem.offset, elem.length);
+        written += elem.length;
+    }
+    NS_ASSERT (written <= extSize);
+    start.WriteU8 (0, extSize - written); // padding
 }
 
 uint32_t RtpHeader::Deserialize (Buffer::Iterator start)
@@ -141,32 +180,44 @@ uint32_t RtpHeader::Deserialize (Buffer::Iterator start)
     m_sequence = start.ReadNtohU16 ();
     m_timestamp = start.ReadNtohU32 ();
     m_ssrc = start.ReadNtohU32 ();
-    m_csrcs.clear ();
+    uint32_t size = 12 + 4 * csrcCount;
+    m_csrcCount = 0;
     for (auto i = 0; i < csrcCount; ++i) {
         const uint32_t csrc = start.ReadNtohU32 ();
-        NS_ASSERT (m_csrcs.count (csrc) == 0);
-        m_csrcs.insert (csrc);
+        const bool added = AddCsrc (csrc);
+        NS_ASSERT (added);
+        (void) added; // unused in optimized builds
+    }
+    ClearExtensions ();
+    if (m_extension) {
+        const uint16_t profile = start.ReadNtohU16 ();
+        const uint32_t length = 4 * uint32_t (start.ReadNtohU16 ());
+        DeserializeExtension (start, profile, length);
+        size += 4 + length;
     }
     NS_ASSERT (version == RTP_VERSION);
-    return GetSerializedSize ();
+    // Not GetSerializedSize (): elements in unknown forms are skipped
+    return size;
 }
 
 void RtpHeader::Print (std::ostream& os) const
 {
-    NS_ASSERT (m_csrcs.size () <= 0x0f);
+    NS_ASSERT (m_csrcCount <= RTP_MAX_CSRCS);
     os << "RtpHeader - version = " << int (RTP_VERSION)
        << ", padding = " << (m_padding ? "yes" : "no")
        << ", extension = " << (m_extension ? "yes" : "no")
-       << ", CSRC count = " << m_csrcs.size ()
+       << ", CSRC count = " << int (m_csrcCount)
        << ", marker = " << (m_marker ? "yes" : "no")
        << ", payload type = " << int (m_payloadType)
        << ", sequence = " << m_sequence
        << ", timestamp = " << m_timestamp
        << ", ssrc = " << m_ssrc;
-    size_t i = 0;
-    for (const auto& csrc : m_csrcs) {
-        os << ", CSRC#" << i << " = " << csrc;
-        ++i;
+    for (uint8_t i = 0; i < m_csrcCount; ++i) {
+        os << ", CSRC#" << int (i) << " = " << m_csrcs[i];
+    }
+    for (uint8_t i = 0; i < m_extCount; ++i) {
+        os << ", extension ID " << int (m_extElements[i].id)
+           << " length = " << int (m_extElements[i].length);
     }
     os << std::endl;
 }
@@ -242,20 +293,164 @@ void RtpHeader::SetTimestamp (uint32_t timestamp)
     m_timestamp = timestamp;
 }
 
-const std::set<uint32_t>& RtpHeader::GetCsrcs () const
+RtpCsrcList RtpHeader::GetCsrcs () const
 {
-    return m_csrcs;
+    return RtpCsrcList{m_csrcs, m_csrcCount};
 }
 
 bool RtpHeader::AddCsrc (uint32_t csrc)
 {
-    if (m_csrcs.count (csrc) != 0) {
+    if (m_csrcCount >= RTP_MAX_CSRCS) {
+        return false;
+    }
+    // At most 15 entries: a linear scan beats any lookup structure
+    for (uint8_t i = 0; i < m_csrcCount; ++i) {
+        if (m_csrcs[i] == csrc) {
+            return false;
+        }
+    }
+    m_csrcs[m_csrcCount++] = csrc;
+    return true;
+}
+
+bool RtpHeader::AddExtension (uint8_t id, const uint8_t* data, uint8_t length)
+{
+    if (id == 0 || m_extCount >= RTP_EXT_MAX_ELEMENTS ||
+        length > RTP_EXT_MAX_DATA - m_extDataLength) {
+        return false;
+    }
+    for (uint8_t i = 0; i < m_extCount; ++i) {
+        if (m_extElements[i].id == id) {
+            return false;
+        }
+    }
+    const ExtensionElement elem = { id, length, m_extDataLength };
+    m_extElements[m_extCount++] = elem;
+    std::copy (data, data + length, m_extData + m_extDataLength);
+    m_extDataLength += length;
+    m_extension = true;
+    return true;
+}
+
+bool RtpHeader::GetExtension (uint8_t id, const uint8_t*& data, uint8_t& length) const
+{
+    for (uint8_t i = 0; i < m_extCount; ++i) {
+        if (m_extElements[i].id == id) {
+            data = m_extData + m_extElements[i].offset;
+            length = m_extElements[i].length;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RtpHeader::ClearExtensions ()
+{
+    m_extCount = 0;
+    m_extDataLength = 0;
+}
+
+bool RtpHeader::SetAbsSendTime (uint64_t sendTimeUs, uint8_t id)
+{
+    // 6.18 fixed point seconds, lowest 24 bits
+    const uint32_t absSendTime = uint32_t (((sendTimeUs << 18) / 1000000) & 0xffffff);
+    const uint8_t data[3] = { uint8_t (absSendTime >> 16),
+                              uint8_t (absSendTime >> 8),
+                              uint8_t (absSendTime) };
+    return AddExtension (id, data, sizeof (data));
+}
+
+bool RtpHeader::GetAbsSendTime (uint32_t& absSendTime, uint8_t id) const
+{
+    const uint8_t* data = nullptr;
+    uint8_t length = 0;
+    if (!GetExtension (id, data, length) || length != 3) {
+        return false;
+    }
+    absSendTime = (uint32_t (data[0]) << 16) | (uint32_t (data[1]) << 8) | uint32_t (data[2]);
+    return true;
+}
+
+uint64_t RtpHeader::AbsSendTimeToUs (uint32_t absSendTime)
+{
+    return (uint64_t (absSendTime & 0xffffff) * 1000000) >> 18;
+}
+
+bool RtpHeader::SetTransportSequence (uint16_t sequence, uint8_t id)
+{
+    const uint8_t data[2] = { uint8_t (sequence >> 8), uint8_t (sequence) };
+    return AddExtension (id, data, sizeof (data));
+}
+
+bool RtpHeader::GetTransportSequence (uint16_t& sequence, uint8_t id) const
+{
+    const uint8_t* data = nullptr;
+    uint8_t length = 0;
+    if (!GetExtension (id, data, length) || length != 2) {
         return false;
     }
-    m_csrcs.insert (csrc);
+    sequence = (uint16_t (data[0]) << 8) | uint16_t (data[1]);
     return true;
 }
 
+bool RtpHeader::UseTwoByteExtensions () const
+{
+    for (uint8_t i = 0; i < m_extCount; ++i) {
+        const auto& elem = m_extElements[i];
+        if (elem.id > 14 || elem.length == 0 || elem.length > 16) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t RtpHeader::GetExtensionSize () const
+{
+    if (!m_extension) {
+        return 0;
+    }
+    const uint32_t perElement = UseTwoByteExtensions () ? 2 : 1;
+    const uint32_t elemSize = m_extCount * perElement + m_extDataLength;
+    return 4 + // profile and length
+           ((elemSize + 3) / 4) * 4; // padded to 32-bit words
+}
+
+void RtpHeader::DeserializeExtension (Buffer::Iterator& start, uint16_t profile, uint32_t length)
+{
+    const bool oneByte = (profile == RTP_EXT_ONE_BYTE_PROFILE);
+    const bool twoByte = ((profile & 0xfff0) == RTP_EXT_TWO_BYTE_PROFILE);
+    uint8_t data[0xff];
+    while ((oneByte || twoByte) && length > 0) {
+        uint8_t id = start.ReadU8 ();
+        --length;
+        if (id == 0) {
+            continue; // padding
+        }
+        uint8_t elemLength;
+        if (oneByte) {
+            elemLength = (id & 0x0f) + 1;
+            id >>= 4;
+            if (id == 15) {
+                break; // reserved: stop parsing
+            }
+        } else {
+            if (length == 0) {
+                break;
+            }
+            elemLength = start.ReadU8 ();
+            --length;
+        }
+        if (elemLength > length) {
+            break;
+        }
+        start.Read (data, elemLength);
+        length -= elemLength;
+        // Elements that do not fit are dropped, as unknown ones would be
+        (void) AddExtension (id, data, elemLength);
+    }
+    start.Next (length);
+}
+
 
 RtcpHeader::RtcpHeader ()
 : Header{}
@@ -738,4 +933,323 @@ uint32_t CCFeedbackHeader::UsToNtp (uint64_t tsUs)
     return uint32_t (tsSeconds * double (0x10000));
 }
 
+GenericNackHeader::GenericNackHeader ()
+: RtcpHeader{RTP_FB, RTCP_RTPFB_GNACK}
+, m_mediaSsrc{0}
+, m_nacks{}
+, m_fciList{}
+{
+    ++m_length; // SSRC of media source
+}
+
+GenericNackHeader::~GenericNackHeader () {}
+
+void GenericNackHeader::Clear ()
+{
+    RtcpHeader::Clear ();
+    m_packetType = RTP_FB;
+    m_typeOrCnt = RTCP_RTPFB_GNACK;
+    ++m_length; // SSRC of media source
+    m_mediaSsrc = 0;
+    m_nacks.clear ();
+    m_fciList.clear ();
+}
+
+TypeId GenericNackHeader::GetTypeId ()
+{
+    static TypeId tid = TypeId ("GenericNackHeader")
+      .SetParent<RtcpHeader> ()
+      .AddConstructor<GenericNackHeader> ()
+    ;
+    return tid;
+}
+
+TypeId GenericNackHeader::GetInstanceTypeId () const
+{
+    return GetTypeId ();
+}
+
+uint32_t GenericNackHeader::GetMediaSsrc () const
+{
+    return m_mediaSsrc;
+}
+
+void GenericNackHeader::SetMediaSsrc (uint32_t mediaSsrc)
+{
+    m_mediaSsrc = mediaSsrc;
+}
+
+bool GenericNackHeader::AddNack (uint16_t seq)
+{
+    if (m_nacks.count (seq) > 0) {
+        return true; // already there
+    }
+    // Sequence numbers are normally added in increasing order, so they
+    // mostly fall in the bitmask of the last FCI entry
+    if (!m_fciList.empty ()) {
+        auto& fci = m_fciList.back ();
+        const uint16_t offset = seq - fci.first; //this wraps properly
+        if (offset >= 1 && offset <= 16) {
+            fci.second |= uint16_t (1 << (offset - 1));
+            m_nacks.insert (seq);
+            return true;
+        }
+    }
+    if (m_length >= 0xffff) {
+        return false;
+    }
+    m_fciList.push_back (std::make_pair (seq, uint16_t (0)));
+    m_nacks.insert (seq);
+    ++m_length;
+    return true;
+}
+
+bool GenericNackHeader::Empty () const
+{
+    return m_nacks.empty ();
+}
+
+const std::set<uint16_t>& GenericNackHeader::GetNackList () const
+{
+    return m_nacks;
+}
+
+uint32_t GenericNackHeader::GetSerializedSize () const
+{
+    NS_ASSERT (m_length >= 2);
+    const auto commonHdrSize = RtcpHeader::GetSerializedSize ();
+    return commonHdrSize + (m_length - 1) * 4;
+}
+
+void GenericNackHeader::Serialize (Buffer::Iterator start) const
+{
+    NS_ASSERT (m_length >= 2);
+    RtcpHeader::SerializeCommon (start);
+    start.WriteHtonU32 (m_mediaSsrc);
+    NS_ASSERT (m_fciList.size () == size_t (m_length - 2));
+    for (const auto& fci : m_fciList) {
+        start.WriteHtonU16 (fci.first);
+        start.WriteHtonU16 (fci.second);
+    }
+}
+
+uint32_t GenericNackHeader::Deserialize (Buffer::Iterator start)
+{
+    NS_ASSERT (m_length >= 2);
+    (void) RtcpHeader::DeserializeCommon (start);
+    NS_ASSERT (m_packetType == RTP_FB);
+    NS_ASSERT (m_typeOrCnt == RTCP_RTPFB_GNACK);
+    NS_ASSERT (m_length >= 2);
+    m_mediaSsrc = start.ReadNtohU32 ();
+    m_nacks.clear ();
+    m_fciList.clear ();
+    const size_t nFci = size_t (m_length - 2 /* sender SSRC + media SSRC */);
+    for (size_t i = 0; i < nFci; ++i) {
+        const uint16_t pid = start.ReadNtohU16 ();
+        const uint16_t blp = start.ReadNtohU16 ();
+        m_fciList.push_back (std::make_pair (pid, blp));
+        m_nacks.insert (pid);
+        for (uint8_t bit = 0; bit < 16; ++bit) {
+            if ((blp >> bit) & 0x01) {
+                m_nacks.insert (uint16_t (pid + bit + 1));
+            }
+        }
+    }
+    return GetSerializedSize ();
+}
+
+void GenericNackHeader::Print (std::ostream& os) const
+{
+    NS_ASSERT (m_length >= 2);
+    RtcpHeader::PrintN (os);
+    os << ", SSRC of media source = " << m_mediaSsrc
+       << ", NACKs = {";
+    for (const auto seq : m_nacks) {
+        os << " " << seq;
+    }
+    os << " }" << std::endl;
+}
+
+RembHeader::RembHeader ()
+: RtcpHeader{RTP_PSFB, RTCP_PSFB_AFB}
+, m_exponent{0}
+, m_mantissa{0}
+, m_ssrcs{}
+{
+    m_length += 3; // SSRC of media source, identifier, bitrate
+}
+
+RembHeader::~RembHeader () {}
+
+void RembHeader::Clear ()
+{
+    RtcpHeader::Clear ();
+    m_packetType = RTP_PSFB;
+    m_typeOrCnt = RTCP_PSFB_AFB;
+    m_length += 3; // SSRC of media source, identifier, bitrate
+    m_exponent = 0;
+    m_mantissa = 0;
+    m_ssrcs.clear ();
+}
+
+TypeId RembHeader::GetTypeId ()
+{
+    static TypeId tid = TypeId ("RembHeader")
+      .SetParent<RtcpHeader> ()
+      .AddConstructor<RembHeader> ()
+    ;
+    return tid;
+}
+
+TypeId RembHeader::GetInstanceTypeId () const
+{
+    return GetTypeId ();
+}
+
+uint64_t RembHeader::GetBitrate () const
+{
+    return uint64_t (m_mantissa) << m_exponent;
+}
+
+void RembHeader::SetBitrate (uint64_t bitrate)
+{
+    uint8_t exponent = 0;
+    while (bitrate > 0x3ffff) { // 18-bit mantissa
+        bitrate >>= 1;
+        ++exponent;
+    }
+    NS_ASSERT (exponent <= 0x3f);
+    m_exponent = exponent;
+    m_mantissa = uint32_t (bitrate);
+}
+
+bool RembHeader::AddSsrc (uint32_t ssrc)
+{
+    if (m_ssrcs.size () >= 0xff ||
+        std::find (m_ssrcs.begin (), m_ssrcs.end (), ssrc) != m_ssrcs.end ()) {
+        return false;
+    }
+    m_ssrcs.push_back (ssrc);
+    ++m_length;
+    return true;
+}
+
+const std::vector<uint32_t>& RembHeader::GetSsrcs () const
+{
+    return m_ssrcs;
+}
+
+bool RembHeader::IsRemb (const RtcpHeader& header)
+{
+    // AFB messages other than REMB are not used here
+    return header.GetPacketType () == RTP_PSFB &&
+           header.GetTypeOrCount () == RTCP_PSFB_AFB;
+}
+
+uint32_t RembHeader::GetSerializedSize () const
+{
+    NS_ASSERT (m_length >= 4);
+    const auto commonHdrSize = RtcpHeader::GetSerializedSize ();
+    return commonHdrSize + (m_length - 1) * 4;
+}
+
+void RembHeader::Serialize (Buffer::Iterator start) const
+{
+    NS_ASSERT (m_length == 4 + m_ssrcs.size ());
+    RtcpHeader::SerializeCommon (start);
+    start.WriteHtonU32 (0); // SSRC of media source, unused
+    start.WriteHtonU32 (REMB_IDENTIFIER);
+    start.WriteU8 (uint8_t (m_ssrcs.size ()));
+    start.WriteU8 (uint8_t (m_exponent << 2) | uint8_t ((m_mantissa >> 16) & 0x03));
+    start.WriteHtonU16 (uint16_t (m_mantissa & 0xffff));
+    for (const auto ssrc : m_ssrcs) {
+        start.WriteHtonU32 (ssrc);
+    }
+}
+
+uint32_t RembHeader::Deserialize (Buffer::Iterator start)
+{
+    (void) RtcpHeader::DeserializeCommon (start);
+    NS_ASSERT (m_packetType == RTP_PSFB);
+    NS_ASSERT (m_typeOrCnt == RTCP_PSFB_AFB);
+    NS_ASSERT (m_length >= 4);
+    (void) start.ReadNtohU32 (); // SSRC of media source
+    const uint32_t identifier = start.ReadNtohU32 ();
+    NS_ASSERT (identifier == REMB_IDENTIFIER);
+    (void) identifier; // unused in optimized builds
+    const uint8_t numSsrc = start.ReadU8 ();
+    const uint8_t octet = start.ReadU8 ();
+    m_exponent = (octet >> 2);
+    m_mantissa = (uint32_t (octet & 0x03) << 16) | uint32_t (start.ReadNtohU16 ());
+    m_ssrcs.clear ();
+    NS_ASSERT (m_length == 4 + numSsrc);
+    for (uint8_t i = 0; i < numSsrc; ++i) {
+        m_ssrcs.push_back (start.ReadNtohU32 ());
+    }
+    return GetSerializedSize ();
+}
+
+void RembHeader::Print (std::ostream& os) const
+{
+    NS_ASSERT (m_length >= 4);
+    RtcpHeader::PrintN (os);
+    os << ", REMB bitrate = " << GetBitrate ()
+       << ", SSRCs = {";
+    for (const auto ssrc : m_ssrcs) {
+        os << " " << ssrc;
+    }
+    os << " }" << std::endl;
+}
+
+MediaIndexTag::MediaIndexTag ()
+: Tag{}
+, m_mediaIndex{0}
+{}
+
+MediaIndexTag::MediaIndexTag (uint16_t mediaIndex)
+: Tag{}
+, m_mediaIndex{mediaIndex}
+{}
+
+MediaIndexTag::~MediaIndexTag () {}
+
+TypeId MediaIndexTag::GetTypeId ()
+{
+    static TypeId tid = TypeId ("MediaIndexTag")
+      .SetParent<Tag> ()
+      .AddConstructor<MediaIndexTag> ()
+    ;
+    return tid;
+}
+
+TypeId MediaIndexTag::GetInstanceTypeId () const
+{
+    return GetTypeId ();
+}
+
+uint32_t MediaIndexTag::GetSerializedSize () const
+{
+    return sizeof (m_mediaIndex);
+}
+
+void MediaIndexTag::Serialize (TagBuffer buf) const
+{
+    buf.WriteU16 (m_mediaIndex);
+}
+
+void MediaIndexTag::Deserialize (TagBuffer buf)
+{
+    m_mediaIndex = buf.ReadU16 ();
+}
+
+void MediaIndexTag::Print (std::ostream& os) const
+{
+    os << "media index = " << m_mediaIndex;
+}
+
+uint16_t MediaIndexTag::GetMediaIndex () const
+{
+    return m_mediaIndex;
+}
+
 }
@@ -17,8 +17,9 @@
 
 /**
  * @file
- * Header interface of RTP packets (RFC 3550), and RTCP Feedback
- * packets (draft-ietf-avtcore-cc-feedback-message-01) for ns3-rmcat.
+ * Header interface of RTP packets (RFC 3550), RTCP Feedback
+ * packets (draft-ietf-avtcore-cc-feedback-message-01), and RTCP
+ * Generic NACK packets (RFC 4585) for ns3-rmcat.
 
  * @version 0.1.1
  * @author Jiantao Fu
@@ -30,9 +31,11 @@
 #define RTP_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/tag.h"
 #include "ns3/type-id.h"
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -40,6 +43,39 @@ void RtpHdrSetBit (uint8_t& val, uint8_t pos, bool bit);
 bool RtpHdrGetBit (uint8_t val, uint8_t pos);
 
 const uint8_t RTP_VERSION = 2;
+const uint8_t RTP_MAX_CSRCS = 15; /**< the CC field is 4 bits wide */
+
+// RTP header extensions (rfc8285)
+const uint16_t RTP_EXT_ONE_BYTE_PROFILE = 0xbede;
+const uint16_t RTP_EXT_TWO_BYTE_PROFILE = 0x1000; /**< low 4 bits: appbits */
+const uint8_t RTP_EXT_MAX_ELEMENTS = 8;
+const uint8_t RTP_EXT_MAX_DATA = 64; /**< bytes of element data, all elements */
+// Extension IDs are negotiated out of band (SDP extmap); these are ours
+const uint8_t RTP_EXT_ID_ABS_SEND_TIME = 3;
+const uint8_t RTP_EXT_ID_TRANSPORT_SEQ = 5;
+
+/**
+ * Read-only view on the CSRC identifiers stored inline in an #RtpHeader.
+ * It does not own the identifiers, so it must not outlive the header
+ */
+class RtpCsrcList
+{
+public:
+    RtpCsrcList (const uint32_t* csrcs, uint8_t count)
+    : m_csrcs{csrcs}
+    , m_count{count}
+    {}
+
+    const uint32_t* begin () const { return m_csrcs; }
+    const uint32_t* end () const { return m_csrcs + m_count; }
+    size_t size () const { return m_count; }
+    bool empty () const { return m_count == 0; }
+    uint32_t operator[] (size_t i) const { return m_csrcs[i]; }
+
+private:
+    const uint32_t* m_csrcs;
+    uint8_t m_count;
+};
 
 //-------------------- RTP HEADER (RFC 3550) ----------------------//
 //   0                   1                   2                   3
@@ -53,7 +89,15 @@ const uint8_t RTP_VERSION = 2;
 //  +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
 //  |            contributing source (CSRC) identifiers             |
 //  |                             ....                              |
+//  +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+//  |      0xBE     |      0xDE     |           length              |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |  ID   |  L    |     data      |    ....                       |
 //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+// If the X bit is set, a header extension (rfc8285) follows the CSRCs.
+// The one-byte form is shown above; the two-byte form (profile 0x100X,
+// 8-bit ID and length) is used when an element does not fit in it
 class RtpHeader : public Header
 {
 public:
@@ -82,10 +126,48 @@ public:
     void SetSsrc (uint32_t ssrc);
     uint32_t GetTimestamp () const;
     void SetTimestamp (uint32_t timestamp);
-    const std::set<uint32_t>& GetCsrcs () const;
+    RtpCsrcList GetCsrcs () const;
     bool AddCsrc (uint32_t csrc);
 
+    /**
+     * Add a header extension element (rfc8285), and set the X bit. Fails
+     * if the ID is 0 or already present, or if there is no room left
+     *
+     * @param [in] id Element ID, 1-14 to fit in the one-byte form
+     * @param [in] data Element data
+     * @param [in] length Length of data, 1-16 to fit in the one-byte form
+     */
+    bool AddExtension (uint8_t id, const uint8_t* data, uint8_t length);
+    /**
+     * Look up a header extension element
+     *
+     * @param [in] id Element ID
+     * @param [out] data Element data, valid as long as the header is
+     * @param [out] length Length of data
+     * @retval false if the element is not present
+     */
+    bool GetExtension (uint8_t id, const uint8_t*& data, uint8_t& length) const;
+    void ClearExtensions ();
+    /** Absolute send time (abs-send-time), 24-bit 6.18 fixed point seconds */
+    bool SetAbsSendTime (uint64_t sendTimeUs, uint8_t id = RTP_EXT_ID_ABS_SEND_TIME);
+    bool GetAbsSendTime (uint32_t& absSendTime, uint8_t id = RTP_EXT_ID_ABS_SEND_TIME) const;
+    /** abs-send-time to microseconds; wraps around every 64 seconds */
+    static uint64_t AbsSendTimeToUs (uint32_t absSendTime);
+    /** Sequence number shared by all the sender's SSRCs (transport-wide-cc) */
+    bool SetTransportSequence (uint16_t sequence, uint8_t id = RTP_EXT_ID_TRANSPORT_SEQ);
+    bool GetTransportSequence (uint16_t& sequence, uint8_t id = RTP_EXT_ID_TRANSPORT_SEQ) const;
+
 protected:
+    bool UseTwoByteExtensions () const;
+    uint32_t GetExtensionSize () const;
+    void DeserializeExtension (Buffer::Iterator& start, uint16_t profile, uint32_t length);
+
+    struct ExtensionElement {
+        uint8_t id;
+        uint8_t length;
+        uint8_t offset;  /**< into m_extData */
+    };
+
     bool m_padding;
     bool m_extension;
     bool m_marker;
@@ -93,7 +175,12 @@ protected:
     uint16_t m_sequence;
     uint32_t m_timestamp;
     uint32_t m_ssrc;
-    std::set<uint32_t> m_csrcs;
+    uint8_t m_csrcCount;
+    uint32_t m_csrcs[RTP_MAX_CSRCS];
+    uint8_t m_extCount;
+    ExtensionElement m_extElements[RTP_EXT_MAX_ELEMENTS];
+    uint8_t m_extDataLength;
+    uint8_t m_extData[RTP_EXT_MAX_DATA];
 };
 
 
@@ -151,6 +238,17 @@ public:
         RTCP_RTPFB_CC     = 15,  // TODO (deferred): Change to IANA-assigned value
     };
 
+    enum PsFeedbackType {
+        RTCP_PSFB_PLI  =  1,
+        RTCP_PSFB_SLI  =  2,
+        RTCP_PSFB_RPSI =  3,
+        RTCP_PSFB_FIR  =  4,
+        RTCP_PSFB_TSTR =  5,
+        RTCP_PSFB_TSTN =  6,
+        RTCP_PSFB_VBCM =  7,
+        RTCP_PSFB_AFB  = 15,  // Application layer feedback, e.g., REMB
+    };
+
     RtcpHeader ();
     RtcpHeader (uint8_t packetType);
     RtcpHeader (uint8_t packetType, uint8_t subType);
@@ -262,6 +360,128 @@ protected:
     uint64_t m_latestTsUs;
 };
 
+//------------ RCTP GENERIC NACK HEADER (RFC 4585) ----------------//
+//   0                   1                   2                   3
+//   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |V=2|P|  FMT=1  | PT=RTPFB=205  |          length               |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                 SSRC of RTCP packet sender                    |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                      SSRC of media source                     |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |            PID                |             BLP               |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  .                                                               .
+//  .                                                               .
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |            PID                |             BLP               |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class GenericNackHeader : public RtcpHeader
+{
+public:
+    GenericNackHeader ();
+    virtual ~GenericNackHeader ();
+    virtual void Clear ();
+
+    static ns3::TypeId GetTypeId ();
+    virtual ns3::TypeId GetInstanceTypeId () const;
+    virtual uint32_t GetSerializedSize () const;
+    virtual void Serialize (ns3::Buffer::Iterator start) const;
+    virtual uint32_t Deserialize (ns3::Buffer::Iterator start);
+    virtual void Print (std::ostream& os) const;
+
+    uint32_t GetMediaSsrc () const;
+    void SetMediaSsrc (uint32_t mediaSsrc);
+    /** Returns false if adding the sequence number would make the packet too long */
+    bool AddNack (uint16_t seq);
+    bool Empty () const;
+    const std::set<uint16_t>& GetNackList () const;
+
+protected:
+    typedef std::vector<std::pair<uint16_t /* PID */, uint16_t /* BLP */> > FciList_t;
+
+    uint32_t m_mediaSsrc;
+    std::set<uint16_t> m_nacks;
+    FciList_t m_fciList; /**< built as NACKs are added, in that order */
+};
+
+//------- RCTP REMB HEADER (draft-alvestrand-rmcat-remb-03) --------//
+//   0                   1                   2                   3
+//   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |V=2|P| FMT=15  |   PT=206      |             length            |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                  SSRC of packet sender                        |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                  SSRC of media source (0)                     |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |  Unique identifier 'R' 'E' 'M' 'B'                            |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |  Num SSRC     | BR Exp    |  BR Mantissa                      |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |   SSRC feedback                                               |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |  ...                                                          |
+class RembHeader : public RtcpHeader
+{
+public:
+    RembHeader ();
+    virtual ~RembHeader ();
+    virtual void Clear ();
+
+    static ns3::TypeId GetTypeId ();
+    virtual ns3::TypeId GetInstanceTypeId () const;
+    virtual uint32_t GetSerializedSize () const;
+    virtual void Serialize (ns3::Buffer::Iterator start) const;
+    virtual uint32_t Deserialize (ns3::Buffer::Iterator start);
+    virtual void Print (std::ostream& os) const;
+
+    /** Bitrate in bps; encoding it as exponent and mantissa rounds it down */
+    uint64_t GetBitrate () const;
+    void SetBitrate (uint64_t bitrate);
+    /** Returns false if the SSRC is already there, or if there are 255 already */
+    bool AddSsrc (uint32_t ssrc);
+    const std::vector<uint32_t>& GetSsrcs () const;
+
+    /** Whether the header of a PSFB packet is that of a REMB packet */
+    static bool IsRemb (const RtcpHeader& header);
+
+protected:
+    static const uint32_t REMB_IDENTIFIER = 0x52454d42; // 'R' 'E' 'M' 'B'
+
+    uint8_t m_exponent;
+    uint32_t m_mantissa;
+    std::vector<uint32_t> m_ssrcs;
+};
+
+/**
+ * Media index of a media packet, i.e., its position in the media
+ * stream, regardless of the RTP sequence numbers. The media payload is
+ * all zeroes in this simulator, so the index stands for the codec data
+ * that retransmissions and FEC recover. Only attached when either is on.
+ * Parity packets carry the XOR of the indexes they protect
+ */
+class MediaIndexTag : public Tag
+{
+public:
+    MediaIndexTag ();
+    MediaIndexTag (uint16_t mediaIndex);
+    virtual ~MediaIndexTag ();
+
+    static ns3::TypeId GetTypeId ();
+    virtual ns3::TypeId GetInstanceTypeId () const;
+    virtual uint32_t GetSerializedSize () const;
+    virtual void Serialize (ns3::TagBuffer buf) const;
+    virtual void Deserialize (ns3::TagBuffer buf);
+    virtual void Print (std::ostream& os) const;
+
+    uint16_t GetMediaIndex () const;
+
+protected:
+    uint16_t m_mediaIndex;
+};
+
 }
 
 #endif /* RTP_HEADER_H */
@@ -44,23 +44,9 @@
 
 /*******************************************************************
  * Constants
+ * Tunable ones are in CcfsParams (see ccfs-controller.h)
  */
 
-const uint32_t  kCcfsQDelayWindowTimeMs = 4000;
-const uint64_t  kCcfsBrFractionWindowTimeMs = 500;
-
-const int32_t   kCcfsTargetQDelayMs   = 50;
-const int32_t   kCcfsTargetQDelayMsMin   = 0;
-const int32_t   kCcfsTargetQDelayMsMax   = 250;
-
-const int32_t   kCcfsCrossTrafficTargetQDelayMs = 50;
-const int32_t   kCcfsCompeteTargetQDelayMs   = kCcfsCrossTrafficTargetQDelayMs + kCcfsTargetQDelayMs ;
-
-const uint64_t  kCcfsCompeteMaintainMs   = 4000;
-
-
-const uint64_t  kCcfsInitWaitToProbeMs = kCcfsQDelayWindowTimeMs;
-
 /*
  * TODO: adaptive target qdelay
 const float     kCcfsTargetQDelayDescRate    = 0.95;
@@ -68,49 +54,6 @@ const float     kCcfsTargetQDelayIncrRate    = 1.05;
 const int32_t   kCcfsTargetQDelayForThrottleMs = 50;
 */
 
-const int32_t    KCcfsTrigCompQIncrTimeMs = 2000;
-
-const float      kCcfsTrigThroQDFractMin = 1.5;
-const float      kCcfsTrigThroBrFractMax = 0.9;
-
-const int32_t    kCcfsTrigCompQMRangeMin         = 150;
-const int32_t    kCcfsTrigCompQDelayMin         = kCcfsTrigCompQMRangeMin;
-
-
-const int32_t    kCcfsTrigStopCompQDelayMax = 50;
-const int32_t    kCcfsTrigStopCompQMRangeMax = 20;
-
-const float      kCcfsTrigProbQDelayMax  = 20;
-const float      kCcfsTrigProbBrFractMin  = 1.0f;
-const int32_t    kCcfsTrigProbQMRangeMax  = 15;
-const float      kCcfsTrigProbLossRtMax    = 0.001f;
-const float      kCcfsTrigProbECNRtMax     = 0.001f;
-
-const float      kCcfsTrigStopProbQDFractMin = 1.3f;
-const float      kCcfsTrigStopProbBrFractMax = 0.8f;
-const float      kCcfsTrigStopProbLossRtMax    = 0.03f;
-const float      kCcfsTrigStopProbECNRtMax     = 0.001f;
-
-const float      kCcfsCompTargetBrUpRate = 1.3f;
-const float      kCcfsThroTargetBrRate= 0.5f;
-
-const uint64_t  kCcfsSentRtpKeepTimeMs       = 10000;    // 10 sec
-
-const float     kCcfsFwdBwdEstMAFactor       = 0.9f;
-
-const float     kCcfsFwdBwdRoom              = 0.1f;
-
-
-const uint64_t kCcfsQIncrDetectorMinDurationMs = 500;
-
-const uint64_t kCcfsProbingTimeoutMs = 4000;
-
-
-const float kCcfsDfltBrCtrlQDFractLow = 0.5;
-const float kCcfsDfltBrCtrlQDFractHi = 1.05;
-const float kCcfsDfltBrCtrlIncrRate = 1.005;
-const float kCcfsDfltBrCtrlDecrRate = 0.98;
-
 /* TODO: xqFraction
 const float kCcfsCompBrCtrlQDFractHi = 1.0;
 const float kCcfsCompBrCtrlXQFractLow = 0.8;
@@ -119,10 +62,6 @@ const float kCcfsCompBrCtrlXQFractLow = 0.8;
 #if 0
 const float kCcfsCompBrCtrlQDelayBoundLow = 50;
 #endif
-const float kCcfsCompBrCtrlDecrRate = 0.95;
-const float kCcfsCompBrCtrlIncrRate = 1.02;
-
-const int32_t kCcfsVqBaseDelayUs = 20000; // 20msec
 
 NS_LOG_COMPONENT_DEFINE ("CcfsController");
 
@@ -130,10 +69,11 @@ namespace rmcat {
 
 
 CcfsController::CcfsController() :
+    m_params(),
     m_nqMonitor(NULL),
     m_netDataRate(0),
     m_minQDelay(100000),
-    m_targetQDelay(kCcfsTargetQDelayMs),
+    m_targetQDelay(m_params.targetQDelayMs),
     m_targetSendBps{m_initBw/8}
 {
     NS_LOG_INFO("INIT: TargetTxBps=" << ns3::utilConvertKbps(m_targetSendBps)
@@ -156,6 +96,17 @@ float CcfsController::getBandwidth(uint64_t now) const
     return 8.0 * m_targetSendBps ;
 }
 
+void CcfsController::setParams(const CcfsParams& params)
+{
+    m_params = params;
+    m_targetQDelay = m_params.targetQDelayMs;
+}
+
+const CcfsParams& CcfsController::getParams() const
+{
+    return m_params;
+}
+
 
 void CcfsController::reset()
 {
@@ -175,8 +126,11 @@ void CcfsController::reset()
     m_minQPktSize = 0;
 
     m_qdelayWindow.clear();
+    m_qdelayWindowFront = 0;
+    m_qdelayMinWindow.clear();
+    m_qdelayMaxWindow.clear();
 
-    m_targetQDelay = kCcfsTargetQDelayMs;
+    m_targetQDelay = m_params.targetQDelayMs;
     m_maXQDelay = 0.0f;
 
     m_ivqMinQptUs = 10000000;
@@ -341,6 +295,7 @@ void CcfsController::parseFeedback(ns3::RfbHeader &feedback, const uint32_t begi
     parsed.txedBytes = 0;
     parsed.lastAddedBytes = 0;
     parsed.lossCount = 0;
+    parsed.ceCount = 0;
     parsed.vq.clear();
 
     for(auto ssrc : ssrcList)
@@ -383,7 +338,9 @@ void CcfsController::parseFeedback(ns3::RfbHeader &feedback, const uint32_t begi
 
                     QDelayData timeData = {ssrc, seq, record.localTimestampUs, item->second.m_timestampMs, record.size };
                     parsed.vq.push_back(timeData);
-
+                    if(item->second.m_ecn == RMCAT_ECN_CE) {
+                        parsed.ceCount++;
+                    }
 
                     rv.erase(item);
                 }
@@ -466,14 +423,14 @@ void CcfsController::updateTargetQDelay(int32_t newTargetQDelay)
     if(m_targetQDelay == newTargetQDelay)
         return;
 
-    if(newTargetQDelay > kCcfsTargetQDelayMsMax) {
+    if(newTargetQDelay > m_params.targetQDelayMsMax) {
         NS_LOG_INFO("Set max target qdelay");
-        newTargetQDelay = kCcfsTargetQDelayMsMax;
+        newTargetQDelay = m_params.targetQDelayMsMax;
     }
     
-    if(newTargetQDelay < kCcfsTargetQDelayMsMin) {
+    if(newTargetQDelay < m_params.targetQDelayMsMin) {
         NS_LOG_INFO("Set min target qdelay");
-        newTargetQDelay = kCcfsTargetQDelayMsMin;
+        newTargetQDelay = m_params.targetQDelayMsMin;
     }
 
     NS_LOG_INFO("Update TargetQDelay: " << m_targetQDelay << "->" << newTargetQDelay);
@@ -499,11 +456,11 @@ void CcfsController::setFwdBw(float roomedInputBwBps)
 
     if(m_estFwdBwBps <  (m_minBw/8.0))
     {
-        newFwdBwBps = roomedInputBwBps/(1.0 - kCcfsFwdBwdRoom);
+        newFwdBwBps = roomedInputBwBps/(1.0 - m_params.fwdBwdRoom);
     }
     else
     {
-        newFwdBwBps = (kCcfsFwdBwdEstMAFactor * m_estFwdBwBps) + ((1.0 - kCcfsFwdBwdEstMAFactor) * roomedInputBwBps);
+        newFwdBwBps = (m_params.fwdBwdEstMAFactor * m_estFwdBwBps) + ((1.0 - m_params.fwdBwdEstMAFactor) * roomedInputBwBps);
 
         if(newFwdBwBps > m_maxBw/8.0f)
             newFwdBwBps = m_maxBw/8.0f;
@@ -533,7 +490,7 @@ uint64_t CcfsController::getIncreasingQTime(uint64_t nowUs, int32_t minQDelay, u
         if(m_incrCount >= 3)
         {
             const auto duration = periodEndMs - m_incrStartTime;
-            if(duration >= kCcfsQIncrDetectorMinDurationMs)
+            if(duration >= m_params.qIncrDetectorMinDurationMs)
             {
                 NS_LOG_INFO("Increasing Set:" << m_incrStartTime
                 << " ~ " << periodEndMs
@@ -580,11 +537,11 @@ float CcfsController::getBpsForProbing()
 
 void CcfsController::handleEvtStartCompete(uint64_t nowUs)
 {
-    updateSendRate( m_targetSendBps*kCcfsCompTargetBrUpRate );
+    updateSendRate( m_targetSendBps*m_params.compTargetBrUpRate );
 
     m_status = SENDER_STATUS_COMPETING;
 
-    updateTargetQDelay(kCcfsCompeteTargetQDelayMs);
+    updateTargetQDelay(m_params.crossTrafficTargetQDelayMs + m_params.targetQDelayMs);
 
     m_lastCompeteTime = nowUs/1000;
 }
@@ -673,7 +630,7 @@ float CcfsController::updateBrFractionWindow(const uint32_t beginMs,
     {
         const uint64_t timeMs = m_brFractionWindow.front().beginTimeMs;
 
-        if(timeMs + kCcfsBrFractionWindowTimeMs < endMs)
+        if(timeMs + m_params.brFractionWindowTimeMs < endMs)
         {
             m_totSentBytes -= m_brFractionWindow.front().sentBytes;
             m_totRcvdBytes -= m_brFractionWindow.front().rcvdBytes;
@@ -748,9 +705,9 @@ CcfsController::calcIVQDelay(const ParsedFBData &parsed, float fwdbw, std::vecto
      *   So
      *   vqd[i] < xod[i] + base_delay
      *   Although we cannot know base_delay,
-     *   kCcfsVqBaseDelayUs is base_delay in virtual q delay and constant.
+     *   vqBaseDelayUs is base_delay in virtual q delay and constant.
      *
-     *   So, vqd[i] - kCcfsVqBaseDelayUs < xod[i]
+     *   So, vqd[i] - vqBaseDelayUs < xod[i]
      *
      *
      * qdt: q departure time
@@ -769,7 +726,7 @@ CcfsController::calcIVQDelay(const ParsedFBData &parsed, float fwdbw, std::vecto
         preQdt = 0;
     }
     else {
-        preQpt = m_lastQDelay*1000 + kCcfsVqBaseDelayUs;
+        preQpt = m_lastQDelay*1000 + m_params.vqBaseDelayUs;
         preQdt = m_ivqStUs + preQpt;
 
     }
@@ -819,7 +776,7 @@ void CcfsController::updateInternalVQDelay(const rmcat::CcfsController::ParsedFB
         return ;
 
     float ori_fwdbw ;
-    float fwdbw = float(m_estFwdBwBps / (1.0f - kCcfsFwdBwdRoom));
+    float fwdbw = float(m_estFwdBwBps / (1.0f - m_params.fwdBwdRoom));
     float corr = 0.0f;
     ori_fwdbw = fwdbw;
 
@@ -853,8 +810,8 @@ void CcfsController::updateInternalVQDelay(const rmcat::CcfsController::ParsedFB
                     << " vq.size=" << vqdelays.size()
                     << " corr=" << corr);
 
-        if(stqpt.second > kCcfsVqBaseDelayUs)
-            xqptUs = (stqpt.second  - kCcfsVqBaseDelayUs);
+        if(stqpt.second > m_params.vqBaseDelayUs)
+            xqptUs = (stqpt.second  - m_params.vqBaseDelayUs);
         else
             xqptUs = 0;
 
@@ -901,33 +858,40 @@ rmcat::CcfsController::EstiQDelay CcfsController::estiQDelay(uint64_t periodEndM
     while (m_qdelayWindow.size())
     {
         const uint64_t timeMs = m_qdelayWindow.front().second;
-        if(timeMs + kCcfsQDelayWindowTimeMs < periodEndMs)
+        if(timeMs + m_params.qDelayWindowTimeMs < periodEndMs)
         {
             m_qdelayWindow.pop_front();
-
+            ++m_qdelayWindowFront;
         }
         else
         {
             break;
         }
     }
-    int32_t wndMaxQDelay = -1;
-    EstiQDelay qdelay = {10000, 0, 0, 0};
-
-    /// Find minimum within m_qdelayWindow
-    std::deque< std::pair<int32_t, uint64_t> >::iterator itr;
-
-    for(itr = m_qdelayWindow.begin(); itr != m_qdelayWindow.end(); ++itr)
+    while (m_qdelayMinWindow.size() && m_qdelayMinWindow.front() < m_qdelayWindowFront)
     {
-        if(qdelay.wndMinQDelay > itr->first)
-            qdelay.wndMinQDelay = itr->first;
+        m_qdelayMinWindow.pop_front();
+    }
+    while (m_qdelayMaxWindow.size() && m_qdelayMaxWindow.front() < m_qdelayWindowFront)
+    {
+        m_qdelayMaxWindow.pop_front();
+    }
+    const auto sampleQDelay = [this](uint64_t sample) {
+        return m_qdelayWindow[sample - m_qdelayWindowFront].first;
+    };
 
-        if(wndMaxQDelay < itr->first)
-            wndMaxQDelay = itr->first;
+    int32_t wndMaxQDelay = -1;
+    EstiQDelay qdelay = {10000, 0, 0, 0};
 
-    }
+    /// Minimum and maximum within m_qdelayWindow
+    if(m_qdelayMinWindow.size() && qdelay.wndMinQDelay > sampleQDelay(m_qdelayMinWindow.front()))
+        qdelay.wndMinQDelay = sampleQDelay(m_qdelayMinWindow.front());
 
+    if(m_qdelayMaxWindow.size() && wndMaxQDelay < sampleQDelay(m_qdelayMaxWindow.front()))
+        wndMaxQDelay = sampleQDelay(m_qdelayMaxWindow.front());
 
+    /// Per-packet details are only worth building if someone reads them
+    const bool logEnabled = g_log.IsEnabled(ns3::LOG_INFO);
     std::string log("");
     char buff[64];
 
@@ -965,8 +929,11 @@ rmcat::CcfsController::EstiQDelay CcfsController::estiQDelay(uint64_t periodEndM
 
             nqdelays.push_back(newQDelay);
 
-            snprintf(buff, sizeof(buff), "%d:%dms,", parsed.vq[i].seq, newQDelay);
-            log += buff;
+            if(logEnabled)
+            {
+                snprintf(buff, sizeof(buff), "%d:%dms,", parsed.vq[i].seq, newQDelay);
+                log += buff;
+            }
 
         }
 
@@ -979,8 +946,18 @@ rmcat::CcfsController::EstiQDelay CcfsController::estiQDelay(uint64_t periodEndM
         if(wndMaxQDelay < qdelay.latestQDelay)
             wndMaxQDelay = qdelay.latestQDelay;
 
+        const uint64_t sample = m_qdelayWindowFront + m_qdelayWindow.size();
         m_qdelayWindow.push_back(std::make_pair(qdelay.latestQDelay, periodEndMs));
 
+        /// Older samples that can no longer be the window's min (resp. max)
+        while (m_qdelayMinWindow.size() && sampleQDelay(m_qdelayMinWindow.back()) >= qdelay.latestQDelay)
+            m_qdelayMinWindow.pop_back();
+        m_qdelayMinWindow.push_back(sample);
+
+        while (m_qdelayMaxWindow.size() && sampleQDelay(m_qdelayMaxWindow.back()) <= qdelay.latestQDelay)
+            m_qdelayMaxWindow.pop_back();
+        m_qdelayMaxWindow.push_back(sample);
+
 
     }
 
@@ -1024,7 +1001,7 @@ float CcfsController::estiFwdBwPre(const ParsedFBData parsed, int periodMs)
 
     lastRxedBps = (1000.0 * (float)parsed.rxedBytes) / (float)(periodMs) ; /* Byte per sec */
     float lastTxedBps = (1000.0 * (float)parsed.txedBytes) / (float)(periodMs) ; /* Byte per sec */
-    float roomedLastRxedBps = lastRxedBps*(1.0 - kCcfsFwdBwdRoom);
+    float roomedLastRxedBps = lastRxedBps*(1.0 - m_params.fwdBwdRoom);
 
     if( m_status != SENDER_STATUS_THROTTLED
         && ( (parsed.txedBytes > parsed.rxedSentBytes)                                       /* Not arrived all yet */
@@ -1070,7 +1047,7 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
     ctrl.qdFraction = float(eq.latestQDelay) / float(m_targetQDelay);
 
     if(eq.currXQDelay > 0)
-        ctrl.xqFraction = float(eq.currXQDelay) / float(kCcfsCrossTrafficTargetQDelayMs);
+        ctrl.xqFraction = float(eq.currXQDelay) / float(m_params.crossTrafficTargetQDelayMs);
 
 
     if(m_status == SENDER_STATUS_THROTTLED)
@@ -1085,8 +1062,8 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
 
 
     if (increasingMs > 0
-        && ctrl.qdFraction >= kCcfsTrigThroQDFractMin
-        && ctrl.brFraction < kCcfsTrigThroBrFractMax
+        && ctrl.qdFraction >= m_params.trigThroQDFractMin
+        && ctrl.brFraction < m_params.trigThroBrFractMax
         /* TODO ref xqFraction
         && ctrl.xqFraction == 0.0f
          */
@@ -1099,11 +1076,11 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
     }
 
 
-    if( (eq.wndMinQRange > kCcfsTrigCompQMRangeMin && increasingMs > KCcfsTrigCompQIncrTimeMs)  /* intrude: Fast increase */
-        || (eq.latestQDelay > kCcfsTrigCompQDelayMin && increasingMs > KCcfsTrigCompQIncrTimeMs) )      /* Slow increase */
+    if( (eq.wndMinQRange > m_params.trigCompQMRangeMin && increasingMs > m_params.trigCompQIncrTimeMs)  /* intrude: Fast increase */
+        || (eq.latestQDelay > m_params.trigCompQDelayMin && increasingMs > m_params.trigCompQIncrTimeMs) )      /* Slow increase */
         /* TODO: ref xqFraction ctrl.xqFraction > 0.2f */
        /*
-            || (eq.latestQDelay > kCcfsTrigCompQDelayMin && increasingMs > KCcfsTrigCompQIncrTimeMs)) )
+            || (eq.latestQDelay > m_params.trigCompQDelayMin && increasingMs > m_params.trigCompQIncrTimeMs)) )
             */
     {
         ctrl.evt = SEND_CONTROL_START_COMPETE;
@@ -1113,9 +1090,9 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
     }
 
     if(m_status == SENDER_STATUS_COMPETING
-        && periodEndMs - m_lastCompeteTime > kCcfsCompeteMaintainMs
-        && eq.latestQDelay < kCcfsTrigStopCompQDelayMax
-        && eq.wndMinQRange < kCcfsTrigStopCompQMRangeMax
+        && periodEndMs - m_lastCompeteTime > m_params.competeMaintainMs
+        && eq.latestQDelay < m_params.trigStopCompQDelayMax
+        && eq.wndMinQRange < m_params.trigStopCompQMRangeMax
        /* TODO: ref xqFraction
         && ctrl.xqFraction == 0.0f
         */
@@ -1127,13 +1104,13 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
         goto FUNC_OUT;
     }
 
-    if( (nowUs - m_ccfsStartTime)/1000 > kCcfsInitWaitToProbeMs
+    if( (nowUs - m_ccfsStartTime)/1000 > m_params.qDelayWindowTimeMs
        && m_status != SENDER_STATUS_PROBING
-       && eq.latestQDelay < kCcfsTrigProbQDelayMax
-       && ctrl.brFraction >= kCcfsTrigProbBrFractMin
-       && eq.wndMinQRange < kCcfsTrigProbQMRangeMax
-       && m_ecnRate < kCcfsTrigProbECNRtMax
-       && m_lossRate < kCcfsTrigProbLossRtMax)
+       && eq.latestQDelay < m_params.trigProbQDelayMax
+       && ctrl.brFraction >= m_params.trigProbBrFractMin
+       && eq.wndMinQRange < m_params.trigProbQMRangeMax
+       && m_ecnRate < m_params.trigProbECNRtMax
+       && m_lossRate < m_params.trigProbLossRtMax)
     {
         ctrl.evt = SEND_CONTROL_START_PROBING;
         NS_LOG_INFO("PROBING START");
@@ -1143,10 +1120,10 @@ rmcat::CcfsController::ControlSend CcfsController::getControlSend(const uint64_t
 
     if(m_status == SENDER_STATUS_PROBING
         && ( increasingMs > 0
-             || ctrl.qdFraction > kCcfsTrigStopProbQDFractMin
-             || ctrl.brFraction < kCcfsTrigStopProbBrFractMax
-             || m_ecnRate > kCcfsTrigStopProbECNRtMax
-             || m_lossRate > kCcfsTrigStopProbLossRtMax) )
+             || ctrl.qdFraction > m_params.trigStopProbQDFractMin
+             || ctrl.brFraction < m_params.trigStopProbBrFractMax
+             || m_ecnRate > m_params.trigStopProbECNRtMax
+             || m_lossRate > m_params.trigStopProbLossRtMax) )
     {
         ctrl.evt = SEND_CONTROL_STOP_PROBING;
         NS_LOG_INFO("PROBING STOP");
@@ -1184,13 +1161,13 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
 
             if(ctrl.evt == SEND_CONTROL_NOTHING)
             {
-                if(ctrl.qdFraction < kCcfsDfltBrCtrlQDFractLow && m_targetSendBps < m_estFwdBwBps)
+                if(ctrl.qdFraction < m_params.dfltBrCtrlQDFractLow && m_targetSendBps < m_estFwdBwBps)
                 {
-                    updateSendRate( m_targetSendBps*kCcfsDfltBrCtrlIncrRate );
+                    updateSendRate( m_targetSendBps*m_params.dfltBrCtrlIncrRate );
                 }
-                else if(ctrl.qdFraction > kCcfsDfltBrCtrlQDFractHi)
+                else if(ctrl.qdFraction > m_params.dfltBrCtrlQDFractHi)
                 {
-                    updateSendRate( m_targetSendBps*kCcfsDfltBrCtrlDecrRate );
+                    updateSendRate( m_targetSendBps*m_params.dfltBrCtrlDecrRate );
                 }
             }
 
@@ -1207,7 +1184,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
 
             else if(ctrl.evt == SEND_CONTROL_DETECT_THROTTLE)
             {
-                updateSendRate( m_targetSendBps * kCcfsThroTargetBrRate );
+                updateSendRate( m_targetSendBps * m_params.throTargetBrRate );
                 m_throEstFwdBwBps = m_estFwdBwBps;
                 m_status = SENDER_STATUS_THROTTLED;
 
@@ -1224,7 +1201,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
                         || (ctrl.qdFraction < kCcfsCompBrCtrlQDFractHi && ctrl.xqFraction > kCcfsCompBrCtrlXQFractLow)))
                          */
                 {
-                    updateSendRate( m_targetSendBps * kCcfsCompBrCtrlIncrRate );
+                    updateSendRate( m_targetSendBps * m_params.compBrCtrlIncrRate );
                 }
 
                 if(m_targetSendBps > m_estFwdBwBps * 1.05)
@@ -1232,7 +1209,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
                         && (0.001 < ctrl.xqFraction && ctrl.xqFraction < 0.4))
                 */
                 {
-                    updateSendRate( m_targetSendBps * kCcfsCompBrCtrlDecrRate );
+                    updateSendRate( m_targetSendBps * m_params.compBrCtrlDecrRate );
                 }
 #if 0
 
@@ -1249,7 +1226,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
             }
             else if(ctrl.evt == SEND_CONTROL_STOP_COMPETE)
             {
-                updateTargetQDelay(kCcfsTargetQDelayMs);
+                updateTargetQDelay(m_params.targetQDelayMs);
                 m_lastCompeteTime = 0;
 
                 m_status = SENDER_STATUS_DEFAULT;
@@ -1263,10 +1240,10 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
 
                 /*
                  *
-                updateTargetQDelay(kCcfsTargetQDelayMs);
+                updateTargetQDelay(m_params.targetQDelayMs);
                 m_lastCompeteTime = 0;
 
-                updateSendRate( m_targetSendBps * kCcfsThroTargetBrRate );
+                updateSendRate( m_targetSendBps * m_params.throTargetBrRate );
                 m_throEstFwdBwBps = m_estFwdBwBps;
                 m_status = SENDER_STATUS_THROTTLED;
 
@@ -1280,7 +1257,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
 
             if(ctrl.evt == SEND_CONTROL_NOTHING)
             {
-                if( nowMs > m_probingStartTime + kCcfsProbingTimeoutMs )
+                if( nowMs > m_probingStartTime + m_params.probingTimeoutMs )
                 {
 
                     m_status = SENDER_STATUS_DEFAULT;
@@ -1307,7 +1284,7 @@ void CcfsController::handleSendControl(uint64_t nowUs, const ParsedFBData &parse
             {
                 NS_LOG_INFO("PROBING Quit --> THROTTLED");
 
-                updateSendRate( (m_estFwdBwBps * kCcfsThroTargetBrRate) );
+                updateSendRate( (m_estFwdBwBps * m_params.throTargetBrRate) );
                 m_throEstFwdBwBps = m_estFwdBwBps;
                 m_status = SENDER_STATUS_THROTTLED;
 
@@ -1394,10 +1371,10 @@ bool CcfsController::processFeedback2(uint64_t nowUs, ns3::RfbHeader &feedback)
     const auto brFraction = updateBrFractionWindow(lastPeriodBeginMs, lastPeriodEndMs, parsed.rxedBytes, parsed.txedBytes);
 
     /*
-     * TODO: Update Loss/Ecn rate
+     * TODO: Update Loss rate
      */
     m_lossRate = 0.0;
-    m_ecnRate = 0.0;
+    m_ecnRate = parsed.vq.empty() ? 0.0 : float(parsed.ceCount) / parsed.vq.size();
 
     /*
      * First Estimate Fwd bandwidth
@@ -1496,7 +1473,7 @@ bool CcfsController::processSendPacket2(uint32_t ssrc,
         auto sentMs = sitr->second.localTimestampUs/1000;
         auto currMs = localTimestampUs/1000;
 
-        if(sentMs + kCcfsSentRtpKeepTimeMs < currMs) {
+        if(sentMs + m_params.sentRtpKeepTimeMs < currMs) {
             //NS_LOG_INFO("Remove old data: [ssrc=" << ssrc
             //            << ", (seq, pkt_size)=(" << sitr->first << ", " << sitr->second.size
             //            << ")");
@@ -31,6 +31,52 @@
 
 namespace rmcat {
 
+/**
+ * Tuning parameters of #CcfsController. Default values are the ones
+ * the algorithm was designed with. Times are in ms (suffix Ms) or
+ * us (suffix Us); rates and fractions are ratios.
+ */
+struct CcfsParams
+{
+    uint32_t qDelayWindowTimeMs = 4000;                  ///< Window over which min/max qdelay are tracked; also the initial wait before probing
+    uint64_t brFractionWindowTimeMs = 500;               ///< Window of the received/sent bitrate fraction
+    int32_t  targetQDelayMs = 50;                        ///< Default target qdelay
+    int32_t  targetQDelayMsMin = 0;                      ///< Lower bound of the target qdelay
+    int32_t  targetQDelayMsMax = 250;                    ///< Upper bound of the target qdelay
+    int32_t  crossTrafficTargetQDelayMs = 50;            ///< Extra target qdelay while competing with cross traffic
+    uint64_t competeMaintainMs = 4000;                   ///< Minimum time to stay in competing mode
+    int32_t  trigCompQIncrTimeMs = 2000;                 ///< Qdelay increase duration that triggers competing mode
+    float    trigThroQDFractMin = 1.5f;                  ///< Min qdelay fraction to detect throttling
+    float    trigThroBrFractMax = 0.9f;                  ///< Max bitrate fraction to detect throttling
+    int32_t  trigCompQMRangeMin = 150;                   ///< Min windowed qdelay range to start competing
+    int32_t  trigCompQDelayMin = 150;                    ///< Min qdelay to start competing
+    int32_t  trigStopCompQDelayMax = 50;                 ///< Max qdelay to stop competing
+    int32_t  trigStopCompQMRangeMax = 20;                ///< Max windowed qdelay range to stop competing
+    float    trigProbQDelayMax = 20;                     ///< Max qdelay to start probing
+    float    trigProbBrFractMin = 1.0f;                  ///< Min bitrate fraction to start probing
+    int32_t  trigProbQMRangeMax = 15;                    ///< Max windowed qdelay range to start probing
+    float    trigProbLossRtMax = 0.001f;                 ///< Max loss rate to start probing
+    float    trigProbECNRtMax = 0.001f;                  ///< Max ECN marking rate to start probing
+    float    trigStopProbQDFractMin = 1.3f;              ///< Qdelay fraction above which probing stops
+    float    trigStopProbBrFractMax = 0.8f;              ///< Bitrate fraction below which probing stops
+    float    trigStopProbLossRtMax = 0.03f;              ///< Loss rate above which probing stops
+    float    trigStopProbECNRtMax = 0.001f;              ///< ECN marking rate above which probing stops
+    float    compTargetBrUpRate = 1.3f;                  ///< Rate increase factor when starting to compete
+    float    throTargetBrRate = 0.5f;                    ///< Rate decrease factor when throttled
+    uint64_t sentRtpKeepTimeMs = 10000;                  ///< How long sent packet records are kept
+    float    fwdBwdEstMAFactor = 0.9f;                   ///< Moving average factor of the forward bandwidth estimate
+    float    fwdBwdRoom = 0.1f;                          ///< Headroom left below the forward bandwidth estimate
+    uint64_t qIncrDetectorMinDurationMs = 500;           ///< Min duration of a qdelay increase to be detected
+    uint64_t probingTimeoutMs = 4000;                    ///< Max duration of probing mode
+    float    dfltBrCtrlQDFractLow = 0.5f;                ///< Default mode: qdelay fraction below which the rate increases
+    float    dfltBrCtrlQDFractHi = 1.05f;                ///< Default mode: qdelay fraction above which the rate decreases
+    float    dfltBrCtrlIncrRate = 1.005f;                ///< Default mode: rate increase factor
+    float    dfltBrCtrlDecrRate = 0.98f;                 ///< Default mode: rate decrease factor
+    float    compBrCtrlDecrRate = 0.95f;                 ///< Competing mode: rate decrease factor
+    float    compBrCtrlIncrRate = 1.02f;                 ///< Competing mode: rate increase factor
+    int32_t  vqBaseDelayUs = 20000;                      ///< Base delay of the internal virtual queue
+};
+
 /**
  * Draft:
  * https://datatracker.ietf.org/doc/draft-gwock-rmcat-ccfs/
@@ -54,6 +100,12 @@ public:
 
     virtual float getBandwidth(uint64_t now) const;
 
+    /**
+     * Replace the tuning parameters. Call it before the flow starts
+     */
+    void setParams(const CcfsParams& params);
+    const CcfsParams& getParams() const;
+
     /**
      * This is only for the logging
      */
@@ -85,6 +137,7 @@ private:
         uint64_t txedBytes;
         uint64_t lastAddedBytes;
         uint32_t lossCount;
+        uint32_t ceCount;
         std::vector<QDelayData> vq;
 
     };
@@ -217,6 +270,8 @@ private:
     /*
      * Variables
      */
+    CcfsParams  m_params;
+
     uint32_t    m_rxedFbmCount;
 
      /**
@@ -257,6 +312,11 @@ private:
 
     /* QDelay Estimation */
     std::deque< std::pair<int32_t /*qdelay*/, uint64_t /*txedTimeMs*/> > m_qdelayWindow;
+    uint64_t    m_qdelayWindowFront;    /* sample number of m_qdelayWindow.front() */
+    /* Sample numbers of monotonic (increasing/decreasing) subsets of
+     * m_qdelayWindow: their front is the window's minimum/maximum qdelay */
+    std::deque< uint64_t > m_qdelayMinWindow;
+    std::deque< uint64_t > m_qdelayMaxWindow;
     int32_t     m_minQDelay;            /* base delay */
     int32_t     m_lastQDelay;
     uint32_t    m_minQPktSize;
@@ -0,0 +1,243 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Run time CCFS parameters, as ns3 attributes.
+ *
+ * @version 0.1.1
+ */
+
+#include "ccfs-params-profile.h"
+#include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CcfsParamsProfile);
+
+TypeId CcfsParamsProfile::GetTypeId ()
+{
+    // Attributes live in the rmcat::CcfsParams base, so defaults come from it
+    const rmcat::CcfsParams defaults{};
+    static TypeId tid = TypeId ("ns3::CcfsParamsProfile")
+        .SetParent<Object> ()
+        .SetGroupName ("Applications")
+        .AddConstructor<CcfsParamsProfile> ()
+        .AddAttribute ("QDelayWindowTimeMs",
+                       "Window over which min/max qdelay are tracked; also the initial wait before probing",
+                       UintegerValue (defaults.qDelayWindowTimeMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::qDelayWindowTimeMs),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("BrFractionWindowTimeMs",
+                       "Window of the received/sent bitrate fraction",
+                       UintegerValue (defaults.brFractionWindowTimeMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::brFractionWindowTimeMs),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("TargetQDelayMs",
+                       "Default target qdelay",
+                       IntegerValue (defaults.targetQDelayMs),
+                       MakeIntegerAccessor (&CcfsParamsProfile::targetQDelayMs),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TargetQDelayMsMin",
+                       "Lower bound of the target qdelay",
+                       IntegerValue (defaults.targetQDelayMsMin),
+                       MakeIntegerAccessor (&CcfsParamsProfile::targetQDelayMsMin),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TargetQDelayMsMax",
+                       "Upper bound of the target qdelay",
+                       IntegerValue (defaults.targetQDelayMsMax),
+                       MakeIntegerAccessor (&CcfsParamsProfile::targetQDelayMsMax),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("CrossTrafficTargetQDelayMs",
+                       "Extra target qdelay while competing with cross traffic",
+                       IntegerValue (defaults.crossTrafficTargetQDelayMs),
+                       MakeIntegerAccessor (&CcfsParamsProfile::crossTrafficTargetQDelayMs),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("CompeteMaintainMs",
+                       "Minimum time to stay in competing mode",
+                       UintegerValue (defaults.competeMaintainMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::competeMaintainMs),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("TrigCompQIncrTimeMs",
+                       "Qdelay increase duration that triggers competing mode",
+                       IntegerValue (defaults.trigCompQIncrTimeMs),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigCompQIncrTimeMs),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigThroQDFractMin",
+                       "Min qdelay fraction to detect throttling",
+                       DoubleValue (defaults.trigThroQDFractMin),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigThroQDFractMin),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigThroBrFractMax",
+                       "Max bitrate fraction to detect throttling",
+                       DoubleValue (defaults.trigThroBrFractMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigThroBrFractMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigCompQMRangeMin",
+                       "Min windowed qdelay range to start competing",
+                       IntegerValue (defaults.trigCompQMRangeMin),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigCompQMRangeMin),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigCompQDelayMin",
+                       "Min qdelay to start competing",
+                       IntegerValue (defaults.trigCompQDelayMin),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigCompQDelayMin),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigStopCompQDelayMax",
+                       "Max qdelay to stop competing",
+                       IntegerValue (defaults.trigStopCompQDelayMax),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigStopCompQDelayMax),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigStopCompQMRangeMax",
+                       "Max windowed qdelay range to stop competing",
+                       IntegerValue (defaults.trigStopCompQMRangeMax),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigStopCompQMRangeMax),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigProbQDelayMax",
+                       "Max qdelay to start probing",
+                       DoubleValue (defaults.trigProbQDelayMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigProbQDelayMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigProbBrFractMin",
+                       "Min bitrate fraction to start probing",
+                       DoubleValue (defaults.trigProbBrFractMin),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigProbBrFractMin),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigProbQMRangeMax",
+                       "Max windowed qdelay range to start probing",
+                       IntegerValue (defaults.trigProbQMRangeMax),
+                       MakeIntegerAccessor (&CcfsParamsProfile::trigProbQMRangeMax),
+                       MakeIntegerChecker<int32_t> ())
+        .AddAttribute ("TrigProbLossRtMax",
+                       "Max loss rate to start probing",
+                       DoubleValue (defaults.trigProbLossRtMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigProbLossRtMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigProbECNRtMax",
+                       "Max ECN marking rate to start probing",
+                       DoubleValue (defaults.trigProbECNRtMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigProbECNRtMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigStopProbQDFractMin",
+                       "Qdelay fraction above which probing stops",
+                       DoubleValue (defaults.trigStopProbQDFractMin),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigStopProbQDFractMin),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigStopProbBrFractMax",
+                       "Bitrate fraction below which probing stops",
+                       DoubleValue (defaults.trigStopProbBrFractMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigStopProbBrFractMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigStopProbLossRtMax",
+                       "Loss rate above which probing stops",
+                       DoubleValue (defaults.trigStopProbLossRtMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigStopProbLossRtMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("TrigStopProbECNRtMax",
+                       "ECN marking rate above which probing stops",
+                       DoubleValue (defaults.trigStopProbECNRtMax),
+                       MakeDoubleAccessor (&CcfsParamsProfile::trigStopProbECNRtMax),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("CompTargetBrUpRate",
+                       "Rate increase factor when starting to compete",
+                       DoubleValue (defaults.compTargetBrUpRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::compTargetBrUpRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("ThroTargetBrRate",
+                       "Rate decrease factor when throttled",
+                       DoubleValue (defaults.throTargetBrRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::throTargetBrRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("SentRtpKeepTimeMs",
+                       "How long sent packet records are kept",
+                       UintegerValue (defaults.sentRtpKeepTimeMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::sentRtpKeepTimeMs),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("FwdBwdEstMAFactor",
+                       "Moving average factor of the forward bandwidth estimate",
+                       DoubleValue (defaults.fwdBwdEstMAFactor),
+                       MakeDoubleAccessor (&CcfsParamsProfile::fwdBwdEstMAFactor),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("FwdBwdRoom",
+                       "Headroom left below the forward bandwidth estimate",
+                       DoubleValue (defaults.fwdBwdRoom),
+                       MakeDoubleAccessor (&CcfsParamsProfile::fwdBwdRoom),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("QIncrDetectorMinDurationMs",
+                       "Min duration of a qdelay increase to be detected",
+                       UintegerValue (defaults.qIncrDetectorMinDurationMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::qIncrDetectorMinDurationMs),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("ProbingTimeoutMs",
+                       "Max duration of probing mode",
+                       UintegerValue (defaults.probingTimeoutMs),
+                       MakeUintegerAccessor (&CcfsParamsProfile::probingTimeoutMs),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("DfltBrCtrlQDFractLow",
+                       "Default mode: qdelay fraction below which the rate increases",
+                       DoubleValue (defaults.dfltBrCtrlQDFractLow),
+                       MakeDoubleAccessor (&CcfsParamsProfile::dfltBrCtrlQDFractLow),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("DfltBrCtrlQDFractHi",
+                       "Default mode: qdelay fraction above which the rate decreases",
+                       DoubleValue (defaults.dfltBrCtrlQDFractHi),
+                       MakeDoubleAccessor (&CcfsParamsProfile::dfltBrCtrlQDFractHi),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("DfltBrCtrlIncrRate",
+                       "Default mode: rate increase factor",
+                       DoubleValue (defaults.dfltBrCtrlIncrRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::dfltBrCtrlIncrRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("DfltBrCtrlDecrRate",
+                       "Default mode: rate decrease factor",
+                       DoubleValue (defaults.dfltBrCtrlDecrRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::dfltBrCtrlDecrRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("CompBrCtrlDecrRate",
+                       "Competing mode: rate decrease factor",
+                       DoubleValue (defaults.compBrCtrlDecrRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::compBrCtrlDecrRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("CompBrCtrlIncrRate",
+                       "Competing mode: rate increase factor",
+                       DoubleValue (defaults.compBrCtrlIncrRate),
+                       MakeDoubleAccessor (&CcfsParamsProfile::compBrCtrlIncrRate),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("VqBaseDelayUs",
+                       "Base delay of the internal virtual queue",
+                       IntegerValue (defaults.vqBaseDelayUs),
+                       MakeIntegerAccessor (&CcfsParamsProfile::vqBaseDelayUs),
+                       MakeIntegerChecker<int32_t> ());
+    return tid;
+}
+
+CcfsParamsProfile::CcfsParamsProfile ()
+: Object{}
+, rmcat::CcfsParams{}
+{}
+
+CcfsParamsProfile::~CcfsParamsProfile ()
+{}
+
+rmcat::CcfsParams CcfsParamsProfile::GetParams () const
+{
+    return *this;
+}
+
+}
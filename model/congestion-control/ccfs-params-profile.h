@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Run time CCFS parameters, as ns3 attributes.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef CCFS_PARAMS_PROFILE_H
+#define CCFS_PARAMS_PROFILE_H
+
+#include "ccfs-controller.h"
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * Exposes #rmcat::CcfsParams as ns3 attributes, so that CCFS can be tuned
+ * at run time, e.g., from the command line:
+ *
+ *   --ns3::CcfsParamsProfile::TargetQDelayMs=100
+ *
+ * Attribute names are the CcfsParams field names, capitalized. Create a
+ * profile once the attribute defaults are set, and pass its parameters to
+ * each controller (see rmcat::CcfsController::setParams).
+ */
+class CcfsParamsProfile : public Object, public rmcat::CcfsParams
+{
+public:
+    static TypeId GetTypeId ();
+
+    CcfsParamsProfile ();
+    virtual ~CcfsParamsProfile ();
+
+    rmcat::CcfsParams GetParams () const;
+};
+
+}
+
+#endif /* CCFS_PARAMS_PROFILE_H */
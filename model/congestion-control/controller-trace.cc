@@ -0,0 +1,263 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Implementation of the controller trace record format, reader and writer.
+ *
+ * @version 0.1.1
+ */
+
+#include "controller-trace.h"
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+namespace rmcat {
+
+static void writeLe(uint8_t* buf, uint64_t value, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        buf[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+static uint64_t readLe(const uint8_t* buf, size_t len) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; ++i) {
+        value |= uint64_t(buf[i]) << (8 * i);
+    }
+    return value;
+}
+
+void encodeTraceRecord(const TraceRecord& record, uint8_t* buf) {
+    buf[0] = record.type;
+    buf[1] = record.ecn;
+    writeLe(buf + 2, record.sequence, 2);
+    writeLe(buf + 4, record.size, 4);
+    writeLe(buf + 8, record.timeUs, 8);
+    writeLe(buf + 16, record.rxTimestampUs, 8);
+}
+
+void decodeTraceRecord(const uint8_t* buf, TraceRecord& record) {
+    record.type = buf[0];
+    record.ecn = buf[1];
+    record.sequence = uint16_t(readLe(buf + 2, 2));
+    record.size = uint32_t(readLe(buf + 4, 4));
+    record.timeUs = readLe(buf + 8, 8);
+    record.rxTimestampUs = readLe(buf + 16, 8);
+}
+
+ControllerTraceReader::ControllerTraceReader()
+: m_in{},
+  m_binary{false},
+  m_lineNo{0},
+  m_error{} {}
+
+ControllerTraceReader::~ControllerTraceReader() {}
+
+bool ControllerTraceReader::open(const std::string& path) {
+    m_in.open(path.c_str(), std::ios::in | std::ios::binary);
+    if (!m_in.is_open()) {
+        m_error = "cannot open " + path;
+        return false;
+    }
+
+    char magic[CONTROLLER_TRACE_MAGIC_LEN];
+    m_in.read(magic, CONTROLLER_TRACE_MAGIC_LEN);
+    m_binary = (size_t(m_in.gcount()) == CONTROLLER_TRACE_MAGIC_LEN &&
+                std::memcmp(magic, CONTROLLER_TRACE_MAGIC,
+                            CONTROLLER_TRACE_MAGIC_LEN) == 0);
+    if (!m_binary) {
+        // Text trace: start over
+        m_in.clear();
+        m_in.seekg(0);
+    }
+    m_lineNo = 0;
+    m_error.clear();
+    return true;
+}
+
+bool ControllerTraceReader::next(TraceRecord& record) {
+    if (!m_in.is_open() || !m_error.empty()) {
+        return false;
+    }
+    return m_binary ? nextBinary(record) : nextText(record);
+}
+
+bool ControllerTraceReader::isBinary() const {
+    return m_binary;
+}
+
+const std::string& ControllerTraceReader::getError() const {
+    return m_error;
+}
+
+bool ControllerTraceReader::nextBinary(TraceRecord& record) {
+    uint8_t buf[CONTROLLER_TRACE_RECORD_LEN];
+    m_in.read(reinterpret_cast<char*>(buf), CONTROLLER_TRACE_RECORD_LEN);
+    const size_t len = size_t(m_in.gcount());
+    if (len == 0) {
+        return false; // end of trace
+    }
+    if (len != CONTROLLER_TRACE_RECORD_LEN) {
+        m_error = "truncated record at end of trace";
+        return false;
+    }
+    decodeTraceRecord(buf, record);
+    if (record.type != TraceRecord::TRACE_RECORD_SEND &&
+        record.type != TraceRecord::TRACE_RECORD_FEEDBACK) {
+        std::ostringstream os;
+        os << "unknown record type " << int(record.type);
+        m_error = os.str();
+        return false;
+    }
+    return true;
+}
+
+bool ControllerTraceReader::nextText(TraceRecord& record) {
+    std::string line;
+    while (std::getline(m_in, line)) {
+        ++m_lineNo;
+        std::istringstream is{line};
+        std::string type;
+        if (!(is >> type) || type[0] == '#') {
+            continue;
+        }
+
+        uint64_t seq = 0;
+        bool ok = false;
+        record = TraceRecord{};
+        if (type == "tx") {
+            record.type = TraceRecord::TRACE_RECORD_SEND;
+            ok = bool(is >> record.timeUs >> seq >> record.size);
+        } else if (type == "fb") {
+            unsigned int ecn = 0;
+            record.type = TraceRecord::TRACE_RECORD_FEEDBACK;
+            ok = bool(is >> record.timeUs >> seq >> record.rxTimestampUs >> ecn);
+            ok = ok && ecn <= 0x03;
+            record.ecn = uint8_t(ecn);
+        }
+        ok = ok && seq <= 0xffff;
+
+        if (!ok) {
+            std::ostringstream os;
+            os << "malformed line " << m_lineNo << ": " << line;
+            m_error = os.str();
+            return false;
+        }
+        record.sequence = uint16_t(seq);
+        return true;
+    }
+    return false;
+}
+
+ControllerTraceWriter::ControllerTraceWriter()
+: m_file{NULL},
+  m_batchBytes{0},
+  m_filling{},
+  m_flushing{},
+  m_flushPending{false},
+  m_stop{false},
+  m_mutex{},
+  m_cond{},
+  m_thread{} {}
+
+ControllerTraceWriter::~ControllerTraceWriter() {
+    close();
+}
+
+bool ControllerTraceWriter::open(const std::string& path, size_t batchRecords) {
+    close();
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == NULL) {
+        return false;
+    }
+    std::fwrite(CONTROLLER_TRACE_MAGIC, 1, CONTROLLER_TRACE_MAGIC_LEN, m_file);
+
+    m_batchBytes = std::max<size_t>(batchRecords, 1) * CONTROLLER_TRACE_RECORD_LEN;
+    m_filling.clear();
+    m_filling.reserve(m_batchBytes);
+    m_flushing.clear();
+    m_flushing.reserve(m_batchBytes);
+    m_flushPending = false;
+    m_stop = false;
+    m_thread = std::thread{&ControllerTraceWriter::writerLoop, this};
+    return true;
+}
+
+void ControllerTraceWriter::write(const TraceRecord& record) {
+    if (m_file == NULL) {
+        return;
+    }
+    const size_t offset = m_filling.size();
+    m_filling.resize(offset + CONTROLLER_TRACE_RECORD_LEN);
+    encodeTraceRecord(record, &m_filling[offset]);
+    if (m_filling.size() >= m_batchBytes) {
+        handOver();
+    }
+}
+
+void ControllerTraceWriter::close() {
+    if (m_file == NULL) {
+        return;
+    }
+    if (!m_filling.empty()) {
+        handOver();
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+    std::fclose(m_file);
+    m_file = NULL;
+}
+
+bool ControllerTraceWriter::isOpen() const {
+    return m_file != NULL;
+}
+
+void ControllerTraceWriter::handOver() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    // Only blocks if the disk is slower than the caller fills a batch
+    m_cond.wait(lock, [this] { return !m_flushPending; });
+    m_filling.swap(m_flushing);
+    m_flushPending = true;
+    lock.unlock();
+    m_cond.notify_all();
+}
+
+void ControllerTraceWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (true) {
+        m_cond.wait(lock, [this] { return m_flushPending || m_stop; });
+        if (!m_flushPending) {
+            break; // stopped, nothing left to write
+        }
+        // The caller does not touch m_flushing until m_flushPending is reset
+        lock.unlock();
+        std::fwrite(m_flushing.data(), 1, m_flushing.size(), m_file);
+        m_flushing.clear();
+        lock.lock();
+        m_flushPending = false;
+        m_cond.notify_all();
+    }
+    std::fflush(m_file);
+}
+
+}
@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Record format for the input events of a sender-based controller, and
+ * reader for files containing such records. Traces can be replayed
+ * offline against any controller, without running the simulator.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef CONTROLLER_TRACE_H
+#define CONTROLLER_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+
+namespace rmcat {
+
+/**
+ * One input event of a sender-based controller. Depending on the type,
+ * the record stands for a call to
+ * SenderBasedController::processSendPacket (#TRACE_RECORD_SEND), or for
+ * one item of a call to SenderBasedController::processFeedbackBatch
+ * (#TRACE_RECORD_FEEDBACK). Feedback items belonging to the same batch
+ * share the same #timeUs
+ */
+struct TraceRecord {
+    enum Type {
+        TRACE_RECORD_SEND = 1,
+        TRACE_RECORD_FEEDBACK = 2,
+    };
+
+    uint8_t type;
+    uint8_t ecn;            /**< feedback only: ECN bits seen by the receiver */
+    uint16_t sequence;
+    uint32_t size;          /**< send only: packet size in bytes */
+    uint64_t timeUs;        /**< send time, or time the feedback was processed */
+    uint64_t rxTimestampUs; /**< feedback only: receive timestamp */
+};
+
+/** Magic string at the beginning of binary trace files */
+const char CONTROLLER_TRACE_MAGIC[] = "RMCATTR1";
+const size_t CONTROLLER_TRACE_MAGIC_LEN = 8;
+
+/** Size, in bytes, of a record in a binary trace file */
+const size_t CONTROLLER_TRACE_RECORD_LEN = 24;
+
+/** Default number of records written to disk at once */
+const size_t CONTROLLER_TRACE_BATCH_RECORDS = 4096;
+
+/**
+ * Serialize a record into exactly #CONTROLLER_TRACE_RECORD_LEN bytes.
+ * Multi-byte fields are written in little-endian order, so that binary
+ * traces can be exchanged between hosts
+ */
+void encodeTraceRecord(const TraceRecord& record, uint8_t* buf);
+
+/** Inverse of #encodeTraceRecord */
+void decodeTraceRecord(const uint8_t* buf, TraceRecord& record);
+
+/**
+ * Sequential reader of controller traces. Two formats are accepted:
+ *
+ *  - binary: the #CONTROLLER_TRACE_MAGIC string followed by fixed-size
+ *    records, as written by the sender application's capture facility
+ *  - text: one event per line, either
+ *    "tx <txTimestampUs> <sequence> <size>" or
+ *    "fb <nowUs> <sequence> <rxTimestampUs> <ecn>".
+ *    Empty lines and lines starting with '#' are ignored
+ *
+ * The format is detected when the file is opened.
+ */
+class ControllerTraceReader {
+public:
+    /** Class constructor */
+    ControllerTraceReader();
+
+    /** Class destructor */
+    ~ControllerTraceReader();
+
+    /**
+     * Open a trace file and detect its format
+     *
+     * @param [in] path Path to the trace file
+     * @retval false if the file could not be opened
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Read the next record from the trace
+     *
+     * @param [out] record The record read
+     * @retval false at the end of the trace, or if a malformed record
+     *         was found (see #getError)
+     */
+    bool next(TraceRecord& record);
+
+    /** True if the trace being read is in binary format */
+    bool isBinary() const;
+
+    /** Description of the last error found, empty if none */
+    const std::string& getError() const;
+
+private:
+    bool nextBinary(TraceRecord& record);
+    bool nextText(TraceRecord& record);
+
+    std::ifstream m_in;
+    bool m_binary;
+    uint64_t m_lineNo;
+    std::string m_error;
+};
+
+/**
+ * Append-only writer of binary controller traces. Records are encoded into
+ * an in-memory batch; full batches are handed over to a background thread
+ * that writes them to disk while the next batch is being filled (double
+ * buffering). This keeps file I/O off the caller's path, so capturing does
+ * not noticeably slow down a simulation.
+ */
+class ControllerTraceWriter {
+public:
+    /** Class constructor */
+    ControllerTraceWriter();
+
+    /** Class destructor. Flushes and closes the trace, if open */
+    ~ControllerTraceWriter();
+
+    /**
+     * Create (or truncate) a trace file and start the writer thread
+     *
+     * @param [in] path Path to the trace file
+     * @param [in] batchRecords Number of records per batch written to disk
+     * @retval false if the file could not be created
+     */
+    bool open(const std::string& path,
+              size_t batchRecords = CONTROLLER_TRACE_BATCH_RECORDS);
+
+    /** Append one record to the trace */
+    void write(const TraceRecord& record);
+
+    /** Flush pending records, stop the writer thread and close the file */
+    void close();
+
+    /** True if the trace is open for writing */
+    bool isOpen() const;
+
+private:
+    void handOver();
+    void writerLoop();
+
+    FILE* m_file;
+    size_t m_batchBytes;
+    std::vector<uint8_t> m_filling;  /**< batch being filled by the caller */
+    std::vector<uint8_t> m_flushing; /**< batch being written by the thread */
+    bool m_flushPending;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_thread;
+};
+
+}
+
+#endif /* CONTROLLER_TRACE_H */
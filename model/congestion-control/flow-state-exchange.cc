@@ -0,0 +1,225 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Flow State Exchange implementation for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#include "flow-state-exchange.h"
+#include <iostream>
+#include <vector>
+
+namespace rmcat {
+
+FlowStateExchange::FlowStateExchange() :
+    m_flows{},
+    m_sumRate{},
+    m_nextId{0},
+    m_sbd{} {}
+
+uint32_t FlowStateExchange::registerFlow(float initRate, float priority) {
+    const uint32_t flowId = m_nextId++;
+    const FlowState state = {
+        priority > 0 ? priority : 1.f,
+        -1.f,
+        initRate,
+        m_sbd ? flowId : 0,   // uncoupled until detected otherwise
+    };
+    m_flows[flowId] = state;
+    m_sumRate[state.group] += initRate;
+    if (m_sbd) {
+        m_sbd->registerFlow(flowId);
+    }
+    return flowId;
+}
+
+void FlowStateExchange::deregisterFlow(uint32_t flowId) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end()) {
+        return;
+    }
+    const auto group = it->second.group;
+    m_flows.erase(it);
+    if (m_sbd) {
+        m_sbd->deregisterFlow(flowId);
+    }
+    bool groupEmpty = true;
+    for (const auto& flow : m_flows) {
+        if (flow.second.group == group) {
+            groupEmpty = false;
+            break;
+        }
+    }
+    if (groupEmpty) {
+        m_sumRate.erase(group);
+    }
+}
+
+void FlowStateExchange::setPriority(uint32_t flowId, float priority) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end() || priority <= 0) {
+        std::cerr << "FlowStateExchange::setPriority,"
+                  << " invalid flow " << flowId
+                  << " or priority " << priority << std::endl;
+        return;
+    }
+    it->second.priority = priority;
+}
+
+void FlowStateExchange::setDesiredRate(uint32_t flowId, float desiredRate) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end()) {
+        std::cerr << "FlowStateExchange::setDesiredRate,"
+                  << " unknown flow " << flowId << std::endl;
+        return;
+    }
+    it->second.desiredRate = desiredRate;
+}
+
+void FlowStateExchange::setGroup(uint32_t flowId, uint32_t group) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end()) {
+        std::cerr << "FlowStateExchange::setGroup,"
+                  << " unknown flow " << flowId << std::endl;
+        return;
+    }
+    auto& state = it->second;
+    if (state.group == group) {
+        return;
+    }
+    const auto oldGroup = state.group;
+    m_sumRate[oldGroup] -= state.fseRate;
+    m_sumRate[group] += state.fseRate;
+    state.group = group;
+    bool groupEmpty = true;
+    for (const auto& flow : m_flows) {
+        if (flow.second.group == oldGroup) {
+            groupEmpty = false;
+            break;
+        }
+    }
+    if (groupEmpty) {
+        m_sumRate.erase(oldGroup);
+    }
+}
+
+void FlowStateExchange::enableSharedBottleneckDetection() {
+    if (!m_flows.empty()) {
+        std::cerr << "FlowStateExchange::enableSharedBottleneckDetection,"
+                  << " flows already registered" << std::endl;
+        return;
+    }
+    m_sbd.reset(new SharedBottleneckDetector{});
+}
+
+bool FlowStateExchange::isSbdEnabled() const {
+    return static_cast<bool>(m_sbd);
+}
+
+void FlowStateExchange::addOwdSample(uint32_t flowId, uint16_t sequence, uint64_t owdUs) {
+    if (m_sbd) {
+        m_sbd->addSample(flowId, sequence, owdUs);
+    }
+}
+
+void FlowStateExchange::updateGroups(uint64_t nowUs) {
+    if (!m_sbd || !m_sbd->update(nowUs)) {
+        return;
+    }
+    // Collect ids first, as setGroup may touch the group sums
+    std::vector<uint32_t> flowIds{};
+    for (const auto& flow : m_flows) {
+        flowIds.push_back(flow.first);
+    }
+    for (const auto flowId : flowIds) {
+        setGroup(flowId, m_sbd->getGroup(flowId));
+    }
+}
+
+float FlowStateExchange::update(uint32_t flowId, float ccRate) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end()) {
+        std::cerr << "FlowStateExchange::update,"
+                  << " unknown flow " << flowId << std::endl;
+        return ccRate;
+    }
+    auto& state = it->second;
+    auto& sumRate = m_sumRate[state.group];
+    sumRate += ccRate - state.fseRate;
+    if (sumRate < 0) {
+        sumRate = 0;
+    }
+    allocate(state.group);
+    return state.fseRate;
+}
+
+/**
+ * Share the group's aggregate rate in proportion to priorities. Flows
+ * whose desired rate is below their share get their desired rate, and
+ * the leftover is shared again among the remaining flows (this iterates
+ * the single redistribution step of rfc8699 until no flow is capped)
+ */
+void FlowStateExchange::allocate(uint32_t group) {
+    std::vector<FlowState*> open{};
+    float sumPriority = 0;
+    for (auto& flow : m_flows) {
+        if (flow.second.group == group) {
+            open.push_back(&flow.second);
+            sumPriority += flow.second.priority;
+        }
+    }
+    float available = m_sumRate[group];
+
+    bool capped = true;
+    while (capped && !open.empty()) {
+        capped = false;
+        for (auto it = open.begin(); it != open.end(); ++it) {
+            auto* state = *it;
+            const float share = available * state->priority / sumPriority;
+            if (state->desiredRate >= 0 && state->desiredRate < share) {
+                state->fseRate = state->desiredRate;
+                available -= state->desiredRate;
+                sumPriority -= state->priority;
+                open.erase(it);
+                capped = true;
+                break;
+            }
+        }
+    }
+    for (auto* state : open) {
+        state->fseRate = available * state->priority / sumPriority;
+    }
+}
+
+float FlowStateExchange::getRate(uint32_t flowId) const {
+    const auto it = m_flows.find(flowId);
+    return (it == m_flows.end()) ? 0.f : it->second.fseRate;
+}
+
+uint32_t FlowStateExchange::getGroup(uint32_t flowId) const {
+    const auto it = m_flows.find(flowId);
+    return (it == m_flows.end()) ? 0 : it->second.group;
+}
+
+size_t FlowStateExchange::getNumFlows() const {
+    return m_flows.size();
+}
+
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Flow State Exchange (FSE) coupling the congestion controllers of
+ * several rmcat flows sent from the same host.
+ *
+ * Coupled Congestion Control for RTP Media
+ * https://tools.ietf.org/html/rfc8699
+ *
+ * @version 0.1.1
+ */
+
+#ifndef FLOW_STATE_EXCHANGE_H
+#define FLOW_STATE_EXCHANGE_H
+
+#include "shared-bottleneck-detector.h"
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+
+namespace rmcat {
+
+/**
+ * Active Flow State Exchange, as specified in Section 5.2 of rfc8699.
+ *
+ * Each flow registers with a priority. Every time a flow's congestion
+ * controller comes up with a new rate, the flow calls #update : the
+ * rate change is applied to the sum of the rates of its flow group,
+ * which is then shared among the flows of the group in proportion to
+ * their priorities. Flows needing less than their share (see
+ * #setDesiredRate) leave the remainder to the others. The flow should
+ * then use the coupled rate, and also feed it back to its controller
+ * (see SenderBasedController::setCurrentBw), so that the flows do not
+ * compete against each other in the shared bottleneck.
+ *
+ * Flow groups stand for the set of flows sharing a bottleneck. By
+ * default, all flows are in group 0. Alternatively, groups can be
+ * determined by shared bottleneck detection (rfc8382, see
+ * #enableSharedBottleneckDetection): each flow then starts in a group
+ * of its own, i.e., uncoupled, until the detector groups it.
+ */
+class FlowStateExchange {
+public:
+    FlowStateExchange();
+
+    /**
+     * Register a new flow
+     *
+     * @param [in] initRate Initial rate of the flow's controller, in bps
+     * @param [in] priority Weight of the flow, must be positive
+     * @retval the flow's id, to be passed to the other member functions
+     */
+    uint32_t registerFlow(float initRate, float priority);
+
+    /**
+     * Remove a flow, e.g., when it stops or pauses. Its share of the
+     * group's rate goes to the other flows of the group
+     */
+    void deregisterFlow(uint32_t flowId);
+
+    /** Change the weight of a flow; takes effect upon the next #update */
+    void setPriority(uint32_t flowId, float priority);
+
+    /**
+     * Set the maximum rate a flow can make use of (e.g., the maximum
+     * encoder rate), in bps. Flows have no limit by default
+     */
+    void setDesiredRate(uint32_t flowId, float desiredRate);
+
+    /** Move a flow to another flow group, along with its current rate */
+    void setGroup(uint32_t flowId, uint32_t group);
+
+    /**
+     * Have a #SharedBottleneckDetector determine the flow groups. Must be
+     * called before registering any flow
+     */
+    void enableSharedBottleneckDetection();
+
+    /** Whether flow groups are determined by shared bottleneck detection */
+    bool isSbdEnabled() const;
+
+    /**
+     * Feed the one-way delay of an acknowledged packet of a flow to the
+     * shared bottleneck detector
+     */
+    void addOwdSample(uint32_t flowId, uint16_t sequence, uint64_t owdUs);
+
+    /**
+     * Let the shared bottleneck detector regroup the flows, if due
+     *
+     * @param [in] nowUs Current time
+     */
+    void updateGroups(uint64_t nowUs);
+
+    /**
+     * Apply a new rate computed by a flow's congestion controller, and
+     * recompute the coupled rates of all flows in its group
+     *
+     * @param [in] flowId Id of the flow
+     * @param [in] ccRate New rate of the flow's controller, in bps
+     * @retval the coupled rate the flow should use, in bps
+     */
+    float update(uint32_t flowId, float ccRate);
+
+    /** Current coupled rate of a flow, in bps; 0 if unknown */
+    float getRate(uint32_t flowId) const;
+
+    /** Group a flow belongs to */
+    uint32_t getGroup(uint32_t flowId) const;
+
+    /** Number of flows currently registered */
+    size_t getNumFlows() const;
+
+private:
+    struct FlowState {
+        float priority;
+        float desiredRate;   /**< negative if unlimited */
+        float fseRate;       /**< coupled rate, FSE_R in rfc8699 */
+        uint32_t group;
+    };
+
+    void allocate(uint32_t group);
+
+    std::map<uint32_t, FlowState> m_flows;
+    std::map<uint32_t, float> m_sumRate;  /**< per group, S_CR in rfc8699 */
+    uint32_t m_nextId;
+    std::unique_ptr<SharedBottleneckDetector> m_sbd;
+};
+
+}
+
+#endif /* FLOW_STATE_EXCHANGE_H */
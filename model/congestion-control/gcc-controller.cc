@@ -0,0 +1,433 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * GCC controller implementation for rmcat ns3 module.
+ *
+ * Implementation of the congestion control scheme documented in the
+ * following IETF draft (rmcat-gcc), with the trendline filter and
+ * sender-side estimation of libwebrtc:
+ *
+ * A Google Congestion Control Algorithm for Real-Time Communication
+ * https://tools.ietf.org/html/draft-ietf-rmcat-gcc-02
+ *
+ * @version 0.1.1
+ */
+
+#include "gcc-controller.h"
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+
+/* rate update interval when feedback is not aggregated */
+const uint64_t GCC_UPDATE_INTERVAL_US = 100 * 1000;
+/* acknowledged bitrate window */
+const int64_t GCC_ACKED_RATE_WINDOW_MS = 1000;
+
+/* loss-based control, see Section 6 of rmcat-gcc */
+const float GCC_LOSS_HIGH = 0.1f;   /**< decrease above this loss ratio */
+const float GCC_LOSS_LOW = 0.02f;   /**< increase below this loss ratio */
+const float GCC_LOSS_INCR = 1.05f;  /**< increase factor */
+const uint64_t GCC_LOSS_UPDATE_US = 300 * 1000; /**< min interval between updates, plus RTT */
+
+/* bandwidth probing, as libwebrtc's ProbeController */
+const float GCC_PROBE_INIT_FACTORS[] = {3.f, 6.f};  /**< of the initial rate */
+const float GCC_PROBE_FURTHER_THRESH = 0.7f;  /**< of the probed rate, to probe further */
+const float GCC_PROBE_FURTHER_FACTOR = 2.f;   /**< of the probe result */
+const uint64_t GCC_PROBE_PERIOD_US = 5000 * 1000;
+const float GCC_PROBE_PERIODIC_FACTOR = 2.f;  /**< of the current estimate */
+const uint32_t GCC_PROBE_MIN_PACKETS = 5;
+const uint64_t GCC_PROBE_MIN_DURATION_US = 15 * 1000;
+
+namespace rmcat {
+
+GccController::GccController() :
+    SenderBasedController{},
+    m_interArrival{},
+    m_trendline{},
+    m_detector{},
+    m_aimd{},
+    m_ackedRate{GCC_ACKED_RATE_WINDOW_MS, webrtc::RateStatistics::kBpsScale},
+    m_lastSeqValid{false},
+    m_lastSeq{0},
+    m_lastRxMs{0},
+    m_inBatch{false},
+    m_lastTimeCalcUs{0},
+    m_lastTimeCalcValid{false},
+    m_lastLossUpdateUs{0},
+    m_lastLossUpdateValid{false},
+    m_bwValid{false},
+    m_delayBw{0.f},
+    m_lossBw{0.f},
+    m_currBw{m_initBw},
+    m_probeInitSent{0},
+    m_probeFurtherBps{0.f},
+    m_lastProbeBps{0.f},
+    m_lastProbeUs{0},
+    m_lastProbeValid{false},
+    m_QdelayUs{0},
+    m_RttUs{0},
+    m_ploss{0},
+    m_plr{0.f},
+    m_RecvR{0.f},
+    m_ackedBps{0.f},
+    m_avgInt{0.f},
+    m_currInt{0} {}
+
+GccController::~GccController() {}
+
+void GccController::setCurrentBw(float newBw) {
+    m_delayBw = newBw;
+    m_lossBw = newBw;
+    m_currBw = newBw;
+    m_bwValid = true;
+    m_aimd.setBounds(m_minBw, m_maxBw);
+    m_aimd.setBitrate(newBw);
+}
+
+void GccController::reset() {
+    m_interArrival.reset();
+    m_trendline.reset();
+    m_detector.reset();
+    m_aimd.reset();
+    m_ackedRate.Reset();
+    m_lastSeqValid = false;
+    m_lastSeq = 0;
+    m_lastRxMs = 0;
+    m_inBatch = false;
+    m_lastTimeCalcUs = 0;
+    m_lastTimeCalcValid = false;
+    m_lastLossUpdateUs = 0;
+    m_lastLossUpdateValid = false;
+    m_bwValid = false;
+    m_delayBw = 0.f;
+    m_lossBw = 0.f;
+    m_probeInitSent = 0;
+    m_probeFurtherBps = 0.f;
+    m_lastProbeBps = 0.f;
+    m_lastProbeUs = 0;
+    m_lastProbeValid = false;
+    m_QdelayUs = 0;
+    m_RttUs = 0;
+    m_ploss = 0;
+    m_plr = 0.f;
+    m_RecvR = 0.f;
+    m_ackedBps = 0.f;
+    m_avgInt = 0.f;
+    m_currInt = 0;
+    SenderBasedController::reset();
+    m_currBw = m_initBw;
+}
+
+/**
+ * Feed one feedback item to the superclass, and then, if it matched
+ * a packet in flight, to the delay-based estimators
+ */
+bool GccController::processFeedbackItem(uint64_t nowUs,
+                                        uint16_t sequence,
+                                        uint64_t rxTimestampUs,
+                                        uint8_t ecn) {
+    if (!SenderBasedController::processFeedback(nowUs,
+                                                sequence,
+                                                rxTimestampUs,
+                                                ecn)) {
+        return false;
+    }
+
+    /* The superclass accepts (and ignores) duplicate and out of order
+     * feedback; only packets it added to the history are new */
+    if (m_packetHistory.empty() || m_packetHistory.back().sequence != sequence) {
+        return true;
+    }
+    if (m_lastSeqValid && !lessThan(m_lastSeq, sequence)) {
+        return true;
+    }
+    m_lastSeq = sequence;
+    m_lastSeqValid = true;
+
+    const PacketRecord& packet = m_packetHistory.back();
+
+    /* receive timestamps come from the receiver's clock, which is monotonic */
+    const uint64_t rxMs = rxTimestampUs / 1000;
+    if (m_lastRxMs <= rxMs) {
+        m_ackedRate.Update(packet.size, int64_t(rxMs));
+        m_lastRxMs = rxMs;
+    }
+
+    int64_t sendDeltaUs = 0;
+    int64_t arrivalDeltaUs = 0;
+    if (m_interArrival.computeDeltas(packet.txTimestampUs, rxTimestampUs, packet.size,
+                                     sendDeltaUs, arrivalDeltaUs)) {
+        m_trendline.update(sendDeltaUs, arrivalDeltaUs, rxTimestampUs);
+        m_detector.detect(m_trendline.getModifiedTrend(), sendDeltaUs,
+                          m_trendline.getNumDeltas(), nowUs);
+    }
+    return true;
+}
+
+/**
+ * Implementation of the #processFeedback API
+ * in the SenderBasedController class
+ */
+bool GccController::processFeedback(uint64_t nowUs,
+                                     uint16_t sequence,
+                                     uint64_t rxTimestampUs,
+                                     uint8_t ecn) {
+    if (!processFeedbackItem(nowUs, sequence, rxTimestampUs, ecn)) {
+        return false;
+    }
+    /* the rate is updated at the end of the batch */
+    if (m_inBatch) {
+        return true;
+    }
+
+    /* First time receiving a feedback message */
+    if (!m_lastTimeCalcValid) {
+        m_lastTimeCalcUs = nowUs;
+        m_lastTimeCalcValid = true;
+        return true;
+    }
+
+    assert(lessThan(m_lastTimeCalcUs, nowUs + 1));
+    const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
+    /* react to overuse right away */
+    if (deltaUs >= GCC_UPDATE_INTERVAL_US ||
+        m_detector.getState() == GCC_BW_OVERUSING) {
+        updateMetrics();
+        updateBw(nowUs);
+        logStats(nowUs, deltaUs);
+
+        m_lastTimeCalcUs = nowUs;
+    }
+    return true;
+}
+
+bool GccController::processFeedbackBatch(uint64_t nowUs,
+                                         const std::vector<FeedbackItem>& feedbackBatch) {
+    /* The superclass loops over #processFeedback */
+    m_inBatch = true;
+    const bool ok = SenderBasedController::processFeedbackBatch(nowUs, feedbackBatch);
+    m_inBatch = false;
+    if (!ok) {
+        return false;
+    }
+
+    /* First time receiving a feedback message */
+    if (!m_lastTimeCalcValid) {
+        m_lastTimeCalcUs = nowUs;
+        m_lastTimeCalcValid = true;
+        return true;
+    }
+
+    assert(lessThan(m_lastTimeCalcUs, nowUs + 1));
+    const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
+    updateMetrics();
+    updateBw(nowUs);
+    logStats(nowUs, deltaUs);
+
+    m_lastTimeCalcUs = nowUs;
+    return true;
+}
+
+/**
+ * Implementation of the #getBandwidth API
+ * in the SenderBasedController class
+ */
+float GccController::getBandwidth(uint64_t nowUs) const {
+    return m_currBw;
+}
+
+void GccController::updateMetrics() {
+    uint64_t qdelayUs = 0;
+    if (getCurrentQdelay(qdelayUs)) m_QdelayUs = qdelayUs;
+
+    uint64_t rttUs = 0;
+    if (getCurrentRTT(rttUs)) m_RttUs = rttUs;
+
+    float rrate = 0.f;
+    if (getCurrentRecvRate(rrate)) m_RecvR = rrate;
+
+    float plr = 0.f;
+    uint32_t nLoss = 0;
+    if (getPktLossInfo(nLoss, plr)) {
+        m_ploss = nLoss;
+        m_plr = plr;
+    }
+
+    float avgInt;
+    uint16_t currentInt;
+    if (getLossIntervalInfo(avgInt, currentInt)) {
+        m_avgInt = avgInt;
+        m_currInt = currentInt;
+    }
+
+    m_ackedBps = float(m_ackedRate.Rate(int64_t(m_lastRxMs)));
+}
+
+/**
+ * The sending rate is the minimum of the delay-based
+ * and loss-based estimates (see Section 4 of rmcat-gcc)
+ */
+void GccController::updateBw(uint64_t nowUs) {
+    if (!m_bwValid) {
+        m_delayBw = m_initBw;
+        m_lossBw = m_initBw;
+        m_bwValid = true;
+    }
+
+    m_aimd.setBounds(m_minBw, m_maxBw);
+    if (!m_aimd.isBitrateValid()) {
+        m_aimd.setBitrate(m_delayBw);
+    }
+    m_delayBw = m_aimd.update(m_detector.getState(), m_ackedBps, m_RttUs, nowUs);
+
+    /* Scalable (L4S-style) response to CE marks, at most once per RTT */
+    float ecnFactor = 1.f;
+    if (getEcnReduction(ecnFactor)) {
+        m_aimd.setBitrate(m_delayBw * ecnFactor);
+        m_delayBw = m_aimd.getBitrate();
+    }
+
+    applyProbeResult();
+    updateLossBasedBw(nowUs);
+
+    /* clip final rate within range */
+    m_currBw = std::min(m_delayBw, m_lossBw);
+    m_currBw = std::min(m_currBw, m_maxBw);
+    m_currBw = std::max(m_currBw, m_minBw);
+}
+
+/**
+ * Loss-based controller, see Section 6 of rmcat-gcc:
+ *
+ *          / As(i-1) (1 - 0.5 p),  if p > 0.1;
+ *          |
+ * As(i) = <  1.05 As(i-1),         if p < 0.02;
+ *          |
+ *          \ As(i-1),              otherwise.
+ */
+void GccController::updateLossBasedBw(uint64_t nowUs) {
+    if (m_lastLossUpdateValid &&
+        nowUs - m_lastLossUpdateUs < GCC_LOSS_UPDATE_US + m_RttUs) {
+        return;
+    }
+    m_lastLossUpdateUs = nowUs;
+    m_lastLossUpdateValid = true;
+
+    if (m_plr > GCC_LOSS_HIGH) {
+        m_lossBw *= (1.f - 0.5f * m_plr);
+    } else if (m_plr < GCC_LOSS_LOW) {
+        m_lossBw *= GCC_LOSS_INCR;
+    }
+    m_lossBw = std::min(m_lossBw, m_maxBw);
+    m_lossBw = std::max(m_lossBw, m_minBw);
+}
+
+/**
+ * Probe for bandwidth: twice at start, further while the
+ * probes are not saturating the path, and then periodically
+ */
+bool GccController::getProbeRequest(uint64_t nowUs, ProbeCluster& cluster) {
+    if (m_detector.getState() == GCC_BW_OVERUSING || m_plr > GCC_LOSS_LOW) {
+        return false;
+    }
+
+    const uint32_t numInit = sizeof(GCC_PROBE_INIT_FACTORS) / sizeof(GCC_PROBE_INIT_FACTORS[0]);
+    float rateBps = 0.f;
+    if (m_probeInitSent < numInit) {
+        rateBps = m_initBw * GCC_PROBE_INIT_FACTORS[m_probeInitSent];
+        ++m_probeInitSent;
+    } else if (m_probeFurtherBps > 0.f) {
+        rateBps = m_probeFurtherBps;
+        m_probeFurtherBps = 0.f;
+    } else if (m_lastProbeValid && nowUs - m_lastProbeUs >= GCC_PROBE_PERIOD_US) {
+        rateBps = m_currBw * GCC_PROBE_PERIODIC_FACTOR;
+    } else {
+        return false;
+    }
+
+    rateBps = std::min(rateBps, m_maxBw);
+    if (rateBps <= m_currBw) {
+        /* Nothing to find */
+        return false;
+    }
+    m_lastProbeBps = rateBps;
+    m_lastProbeUs = nowUs;
+    m_lastProbeValid = true;
+    newProbeCluster(nowUs, rateBps, GCC_PROBE_MIN_PACKETS, GCC_PROBE_MIN_DURATION_US, cluster);
+
+    std::ostringstream os;
+    os << " algo:gcc " << m_id
+       << " ts: "     << (nowUs / 1000)
+       << " probe: "  << cluster.id
+       << " rate: "   << rateBps;
+    logMessage(os.str());
+    return true;
+}
+
+/**
+ * A probe result above the current estimate is taken as the new
+ * delay-based estimate, unless the path is overused
+ */
+void GccController::applyProbeResult() {
+    float probeBps = 0.f;
+    if (!getProbeResult(probeBps) || m_detector.getState() == GCC_BW_OVERUSING) {
+        return;
+    }
+    if (probeBps > m_delayBw) {
+        m_aimd.setBitrate(probeBps);
+        m_delayBw = m_aimd.getBitrate();
+        m_lossBw = std::max(m_lossBw, m_delayBw);
+    }
+    if (probeBps > GCC_PROBE_FURTHER_THRESH * m_lastProbeBps) {
+        m_probeFurtherBps = GCC_PROBE_FURTHER_FACTOR * probeBps;
+    }
+}
+
+void GccController::logStats(uint64_t nowUs, uint64_t deltaUs) const {
+
+    std::ostringstream os;
+    os << std::fixed;
+    os.precision(RMCAT_LOG_PRINT_PRECISION);
+
+    /* log packet stats: the common ones, plus the positive part of
+     * the delay trend in place of NADA's xcurr, then GCC-specific ones */
+    const double trend = m_trendline.getModifiedTrend();
+    os << " algo:gcc " << m_id
+       << " ts: "     << (nowUs / 1000)
+       << " loglen: " << m_packetHistory.size()
+       << " qdel: "   << (m_QdelayUs / 1000)
+       << " rtt: "    << (m_RttUs / 1000)
+       << " ploss: "  << m_ploss
+       << " plr: "    << m_plr
+       << " xcurr: "  << std::max(trend, 0.)
+       << " rrate: "  << m_RecvR
+       << " srate: "  << m_currBw
+       << " avgint: " << m_avgInt
+       << " curint: " << m_currInt
+       << " delta: "  << (deltaUs / 1000)
+       << " trend: "  << trend
+       << " thresh: " << m_detector.getThreshold()
+       << " usage: "  << int(m_detector.getState())
+       << " arate: "  << m_ackedBps
+       << " dbw: "    << m_delayBw
+       << " lbw: "    << m_lossBw;
+    logMessage(os.str());
+}
+
+}
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * GCC controller interface for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef GCC_CONTROLLER_H
+#define GCC_CONTROLLER_H
+
+#include "sender-based-controller.h"
+#include "gcc-estimators.h"
+#include "rate_statistics.h"
+
+namespace rmcat {
+
+/**
+ * Sender-based implementation of the Google Congestion Control (GCC)
+ * algorithm, as found in libwebrtc with transport-wide feedback:
+ *
+ *  - The delay-based controller groups packets by send time, estimates
+ *    the one-way delay variation trend with a trendline filter, detects
+ *    overuse with an adaptive threshold, and drives an AIMD rate
+ *    controller.
+ *  - The loss-based controller bounds the rate depending on the packet
+ *    loss ratio reported by SenderBasedController.
+ *
+ * The acknowledged bitrate, used as reference on rate decreases, is
+ * measured with webrtc::RateStatistics on the receive timestamps.
+ *
+ * As libwebrtc's ProbeController, it asks the sender for probe clusters
+ * at start, further on while probes keep finding more bandwidth, and
+ * then periodically, so that the rate does not have to wait for the
+ * media to ramp up. A probe result above the current estimate becomes
+ * the new estimate.
+ */
+class GccController: public SenderBasedController
+{
+public:
+    /** Class constructor */
+    GccController();
+
+    /** Class destructor */
+    virtual ~GccController();
+
+    /**
+     * Set the current bandwidth estimation. This can be useful in test environments
+     * to temporarily disrupt the current bandwidth estimation
+     *
+     * @param [in] newBw Bandwidth estimation to overwrite the current estimation
+     */
+    virtual void setCurrentBw(float newBw);
+
+    /**
+     * Reset the internal state of the congestion controller
+     */
+    virtual void reset();
+
+    /**
+     * GCC's realization of the processFeedback API: feed the estimators
+     * with the packet, and update the rate at regular intervals
+     */
+    virtual bool processFeedback(uint64_t nowUs,
+                                 uint16_t sequence,
+                                 uint64_t rxTimestampUs,
+                                 uint8_t ecn=0);
+
+    /**
+     * GCC's realization of the processFeedbackBatch API: feed the
+     * estimators with all packets, and update the rate once per batch
+     */
+    virtual bool processFeedbackBatch(uint64_t nowUs,
+                                      const std::vector<FeedbackItem>& feedbackBatch);
+
+    /**
+     * GCC's realization of the getBandwidth API: the minimum of the
+     * delay-based and loss-based estimates
+     */
+    virtual float getBandwidth(uint64_t nowUs) const;
+
+    /**
+     * GCC's realization of the getProbeRequest API: initial, further
+     * (exponential) and periodic probing, unless the path is congested
+     */
+    virtual bool getProbeRequest(uint64_t nowUs, ProbeCluster& cluster);
+
+private:
+    bool processFeedbackItem(uint64_t nowUs,
+                             uint16_t sequence,
+                             uint64_t rxTimestampUs,
+                             uint8_t ecn);
+    void updateMetrics();
+    void updateBw(uint64_t nowUs);
+    void updateLossBasedBw(uint64_t nowUs);
+    void applyProbeResult();
+    void logStats(uint64_t nowUs, uint64_t deltaUs) const;
+
+    GccInterArrival m_interArrival;
+    GccTrendlineEstimator m_trendline;
+    GccOveruseDetector m_detector;
+    GccAimdRateControl m_aimd;
+    webrtc::RateStatistics m_ackedRate;
+
+    bool m_lastSeqValid;
+    uint16_t m_lastSeq;     /**< latest sequence fed to the estimators */
+    uint64_t m_lastRxMs;    /**< latest receive timestamp, in ms */
+    bool m_inBatch;         /**< processing a feedback batch */
+
+    uint64_t m_lastTimeCalcUs;
+    bool m_lastTimeCalcValid;
+    uint64_t m_lastLossUpdateUs;
+    bool m_lastLossUpdateValid;
+
+    bool m_bwValid;         /**< m_delayBw and m_lossBw have been initialized */
+    float m_delayBw;        /**< delay-based estimate in bps */
+    float m_lossBw;         /**< loss-based estimate in bps */
+    float m_currBw;         /**< final estimate in bps */
+
+    uint32_t m_probeInitSent;   /**< initial probe clusters requested */
+    float m_probeFurtherBps;    /**< rate of the next further probe, 0 if none */
+    float m_lastProbeBps;       /**< rate of the last cluster requested */
+    uint64_t m_lastProbeUs;
+    bool m_lastProbeValid;
+
+    uint64_t m_QdelayUs;    /**< estimated queuing delay in microseconds */
+    uint64_t m_RttUs;       /**< estimated RTT in microseconds */
+    uint32_t m_ploss;       /**< packet loss count within packet history */
+    float m_plr;            /**< packet loss ratio within packet history */
+    float m_RecvR;          /**< updated receiving rate in bps */
+    float m_ackedBps;       /**< acknowledged bitrate in bps, 0 if unknown */
+    float m_avgInt;         /**< average inter-loss interval in packets */
+    uint16_t m_currInt;     /**< most recent inter-loss interval in packets */
+};
+
+}
+
+#endif /* GCC_CONTROLLER_H */
@@ -0,0 +1,412 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Building blocks of the Google Congestion Control (GCC) algorithm for
+ * rmcat ns3 module.
+ *
+ * Default values follow the rmcat-gcc draft and libwebrtc.
+ *
+ * @version 0.1.1
+ */
+
+#include "gcc-estimators.h"
+#include <algorithm>
+#include <cmath>
+
+/* packet grouping */
+const uint64_t GCC_BURST_GROUP_US = 5 * 1000; /**< max send time span of a group */
+const int64_t GCC_BURST_ARRIVAL_US = 5 * 1000; /**< max arrival gap within a burst */
+
+/* trendline filter */
+const size_t GCC_TREND_WINDOW = 20;        /**< samples in the linear regression */
+const double GCC_TREND_SMOOTHING = 0.9;    /**< smoothing of the accumulated delay */
+const double GCC_TREND_GAIN = 4.;          /**< gain applied to the trend */
+const uint32_t GCC_TREND_MAX_DELTAS = 60;  /**< cap on the sample count scaling the trend */
+
+/* overuse detector */
+const double GCC_THRESH_INIT_MS = 12.5;    /**< initial threshold */
+const double GCC_THRESH_MIN_MS = 6.;
+const double GCC_THRESH_MAX_MS = 600.;
+const double GCC_THRESH_K_UP = 0.0087;     /**< threshold gain when trend is above it */
+const double GCC_THRESH_K_DOWN = 0.039;    /**< threshold gain when trend is below it */
+const double GCC_THRESH_MAX_JUMP_MS = 15.; /**< trend excursions ignored by adaptation */
+const double GCC_THRESH_MAX_STEP_MS = 100.;
+const double GCC_OVERUSE_TIME_MS = 10.;    /**< time over threshold to signal overuse */
+
+/* AIMD rate control */
+const float GCC_AIMD_BETA = 0.85f;         /**< multiplicative decrease factor */
+const float GCC_AIMD_MULT_INCR = 1.08f;    /**< multiplicative increase, per second */
+const float GCC_AIMD_MIN_INCR_BPS = 1000.f;
+const float GCC_AIMD_PACKET_BITS = 1200.f * 8.f; /**< additive increase, per response time */
+const uint64_t GCC_AIMD_RESPONSE_EXTRA_US = 100 * 1000; /**< response time = RTT + this */
+const float GCC_CAPACITY_SMOOTHING = 0.95f;
+const float GCC_CAPACITY_VAR_MIN = 0.4f;
+const float GCC_CAPACITY_VAR_MAX = 2.5f;
+
+namespace rmcat {
+
+GccInterArrival::GccInterArrival() :
+    m_current{false, 0, 0, 0, 0, 0},
+    m_previous{false, 0, 0, 0, 0, 0} {}
+
+void GccInterArrival::reset() {
+    m_current = Group{false, 0, 0, 0, 0, 0};
+    m_previous = Group{false, 0, 0, 0, 0, 0};
+}
+
+bool GccInterArrival::belongsToBurst(uint64_t sendTimeUs, uint64_t arrivalTimeUs) const {
+    /* Packets arriving back-to-back after being delayed together (e.g., by
+     * a wireless link) are considered part of the same group */
+    const int64_t arrivalDeltaUs = int64_t(arrivalTimeUs - m_current.lastArrivalUs);
+    const int64_t sendDeltaUs = int64_t(sendTimeUs - m_current.lastSendUs);
+    if (sendDeltaUs == 0) {
+        return true;
+    }
+    const int64_t propagationDeltaUs = arrivalDeltaUs - sendDeltaUs;
+    return propagationDeltaUs < 0 && arrivalDeltaUs <= GCC_BURST_ARRIVAL_US;
+}
+
+bool GccInterArrival::computeDeltas(uint64_t sendTimeUs,
+                                    uint64_t arrivalTimeUs,
+                                    uint32_t size,
+                                    int64_t& sendDeltaUs,
+                                    int64_t& arrivalDeltaUs) {
+    bool complete = false;
+    if (!m_current.valid) {
+        m_current = Group{true, sendTimeUs, sendTimeUs, arrivalTimeUs, arrivalTimeUs, 0};
+    } else if (int64_t(sendTimeUs - m_current.firstSendUs) < 0) {
+        /* reordered packet */
+        return false;
+    } else if (int64_t(sendTimeUs - m_current.firstSendUs) > int64_t(GCC_BURST_GROUP_US) &&
+               !belongsToBurst(sendTimeUs, arrivalTimeUs)) {
+        /* new group: the current one is complete */
+        if (m_previous.valid) {
+            sendDeltaUs = int64_t(m_current.lastSendUs - m_previous.lastSendUs);
+            arrivalDeltaUs = int64_t(m_current.lastArrivalUs - m_previous.lastArrivalUs);
+            complete = true;
+        }
+        m_previous = m_current;
+        m_current = Group{true, sendTimeUs, sendTimeUs, arrivalTimeUs, arrivalTimeUs, 0};
+    }
+    m_current.lastSendUs = std::max(m_current.lastSendUs, sendTimeUs);
+    m_current.lastArrivalUs = arrivalTimeUs;
+    m_current.size += size;
+    return complete;
+}
+
+GccTrendlineEstimator::GccTrendlineEstimator() :
+    m_numDeltas{0},
+    m_firstArrivalValid{false},
+    m_firstArrivalUs{0},
+    m_accumulatedDelayMs{0.},
+    m_smoothedDelayMs{0.},
+    m_window{},
+    m_trend{0.} {}
+
+void GccTrendlineEstimator::reset() {
+    m_numDeltas = 0;
+    m_firstArrivalValid = false;
+    m_firstArrivalUs = 0;
+    m_accumulatedDelayMs = 0.;
+    m_smoothedDelayMs = 0.;
+    m_window.clear();
+    m_trend = 0.;
+}
+
+void GccTrendlineEstimator::update(int64_t sendDeltaUs,
+                                   int64_t arrivalDeltaUs,
+                                   uint64_t arrivalTimeUs) {
+    const double deltaMs = double(arrivalDeltaUs - sendDeltaUs) / 1000.;
+    m_numDeltas = std::min(m_numDeltas + 1, 1000u);
+    if (!m_firstArrivalValid) {
+        m_firstArrivalUs = arrivalTimeUs;
+        m_firstArrivalValid = true;
+    }
+
+    m_accumulatedDelayMs += deltaMs;
+    m_smoothedDelayMs = GCC_TREND_SMOOTHING * m_smoothedDelayMs +
+                        (1. - GCC_TREND_SMOOTHING) * m_accumulatedDelayMs;
+
+    const double timeMs = double(arrivalTimeUs - m_firstArrivalUs) / 1000.;
+    m_window.push_back(std::make_pair(timeMs, m_smoothedDelayMs));
+    if (m_window.size() > GCC_TREND_WINDOW) {
+        m_window.pop_front();
+    }
+    if (m_window.size() < GCC_TREND_WINDOW) {
+        return;
+    }
+
+    /* least squares slope; keep the previous trend if it's undefined */
+    double sumX = 0., sumY = 0.;
+    for (const auto& point : m_window) {
+        sumX += point.first;
+        sumY += point.second;
+    }
+    const double avgX = sumX / m_window.size();
+    const double avgY = sumY / m_window.size();
+    double num = 0., den = 0.;
+    for (const auto& point : m_window) {
+        num += (point.first - avgX) * (point.second - avgY);
+        den += (point.first - avgX) * (point.first - avgX);
+    }
+    if (den != 0.) {
+        m_trend = num / den;
+    }
+}
+
+double GccTrendlineEstimator::getModifiedTrend() const {
+    return std::min(m_numDeltas, GCC_TREND_MAX_DELTAS) * m_trend * GCC_TREND_GAIN;
+}
+
+uint32_t GccTrendlineEstimator::getNumDeltas() const {
+    return m_numDeltas;
+}
+
+GccOveruseDetector::GccOveruseDetector() :
+    m_threshold{GCC_THRESH_INIT_MS},
+    m_lastUpdateValid{false},
+    m_lastUpdateUs{0},
+    m_prevTrend{0.},
+    m_timeOverUsingMs{-1.},
+    m_overuseCounter{0},
+    m_state{GCC_BW_NORMAL} {}
+
+void GccOveruseDetector::reset() {
+    m_threshold = GCC_THRESH_INIT_MS;
+    m_lastUpdateValid = false;
+    m_lastUpdateUs = 0;
+    m_prevTrend = 0.;
+    m_timeOverUsingMs = -1.;
+    m_overuseCounter = 0;
+    m_state = GCC_BW_NORMAL;
+}
+
+GccBandwidthUsage GccOveruseDetector::detect(double modifiedTrend,
+                                             int64_t sendDeltaUs,
+                                             uint32_t numDeltas,
+                                             uint64_t nowUs) {
+    if (numDeltas < 2) {
+        return GCC_BW_NORMAL;
+    }
+
+    if (modifiedTrend > m_threshold) {
+        const double sendDeltaMs = double(sendDeltaUs) / 1000.;
+        if (m_timeOverUsingMs < 0.) {
+            /* assume we have been overusing for half of the last delta */
+            m_timeOverUsingMs = sendDeltaMs / 2.;
+        } else {
+            m_timeOverUsingMs += sendDeltaMs;
+        }
+        ++m_overuseCounter;
+        if (m_timeOverUsingMs > GCC_OVERUSE_TIME_MS && m_overuseCounter > 1 &&
+            modifiedTrend >= m_prevTrend) {
+            m_timeOverUsingMs = 0.;
+            m_overuseCounter = 0;
+            m_state = GCC_BW_OVERUSING;
+        }
+    } else if (modifiedTrend < -m_threshold) {
+        m_timeOverUsingMs = -1.;
+        m_overuseCounter = 0;
+        m_state = GCC_BW_UNDERUSING;
+    } else {
+        m_timeOverUsingMs = -1.;
+        m_overuseCounter = 0;
+        m_state = GCC_BW_NORMAL;
+    }
+    m_prevTrend = modifiedTrend;
+
+    updateThreshold(modifiedTrend, nowUs);
+    return m_state;
+}
+
+void GccOveruseDetector::updateThreshold(double modifiedTrend, uint64_t nowUs) {
+    if (!m_lastUpdateValid) {
+        m_lastUpdateUs = nowUs;
+        m_lastUpdateValid = true;
+    }
+
+    const double absTrend = std::fabs(modifiedTrend);
+    if (absTrend > m_threshold + GCC_THRESH_MAX_JUMP_MS) {
+        /* avoid adapting the threshold to sudden, large delay spikes */
+        m_lastUpdateUs = nowUs;
+        return;
+    }
+
+    const double k = absTrend < m_threshold ? GCC_THRESH_K_DOWN : GCC_THRESH_K_UP;
+    const double elapsedMs = std::min(double(nowUs - m_lastUpdateUs) / 1000.,
+                                      GCC_THRESH_MAX_STEP_MS);
+    m_threshold += k * (absTrend - m_threshold) * elapsedMs;
+    m_threshold = std::max(m_threshold, GCC_THRESH_MIN_MS);
+    m_threshold = std::min(m_threshold, GCC_THRESH_MAX_MS);
+    m_lastUpdateUs = nowUs;
+}
+
+GccBandwidthUsage GccOveruseDetector::getState() const {
+    return m_state;
+}
+
+double GccOveruseDetector::getThreshold() const {
+    return m_threshold;
+}
+
+GccAimdRateControl::GccAimdRateControl() :
+    m_state{STATE_HOLD},
+    m_bitrate{0.f},
+    m_bitrateValid{false},
+    m_minBps{0.f},
+    m_maxBps{0.f},
+    m_capacityAvgBps{-1.f},
+    m_capacityVar{GCC_CAPACITY_VAR_MIN},
+    m_lastChangeUs{0},
+    m_lastChangeValid{false},
+    m_lastDecreaseUs{0},
+    m_lastDecreaseValid{false} {}
+
+void GccAimdRateControl::reset() {
+    m_state = STATE_HOLD;
+    m_bitrate = 0.f;
+    m_bitrateValid = false;
+    m_capacityAvgBps = -1.f;
+    m_capacityVar = GCC_CAPACITY_VAR_MIN;
+    m_lastChangeUs = 0;
+    m_lastChangeValid = false;
+    m_lastDecreaseUs = 0;
+    m_lastDecreaseValid = false;
+}
+
+void GccAimdRateControl::setBounds(float minBps, float maxBps) {
+    m_minBps = minBps;
+    m_maxBps = maxBps;
+}
+
+void GccAimdRateControl::setBitrate(float bps) {
+    m_bitrate = std::max(m_minBps, std::min(bps, m_maxBps));
+    m_bitrateValid = true;
+}
+
+bool GccAimdRateControl::isBitrateValid() const {
+    return m_bitrateValid;
+}
+
+float GccAimdRateControl::getBitrate() const {
+    return m_bitrate;
+}
+
+bool GccAimdRateControl::nearCapacity(float bps) const {
+    if (m_capacityAvgBps < 0.f) {
+        return false;
+    }
+    /* standard deviation of the estimate, in bps */
+    const float stdBps = std::sqrt(m_capacityVar * m_capacityAvgBps * 1000.f);
+    return bps < m_capacityAvgBps + 3.f * stdBps;
+}
+
+void GccAimdRateControl::onOveruse(float ackedBps) {
+    if (m_capacityAvgBps < 0.f) {
+        m_capacityAvgBps = ackedBps;
+    } else {
+        m_capacityAvgBps = GCC_CAPACITY_SMOOTHING * m_capacityAvgBps +
+                           (1.f - GCC_CAPACITY_SMOOTHING) * ackedBps;
+    }
+    /* variance is normalized by the average, in kbps */
+    const float avgKbps = std::max(m_capacityAvgBps / 1000.f, 1.f);
+    const float errKbps = (m_capacityAvgBps - ackedBps) / 1000.f;
+    m_capacityVar = GCC_CAPACITY_SMOOTHING * m_capacityVar +
+                    (1.f - GCC_CAPACITY_SMOOTHING) * errKbps * errKbps / avgKbps;
+    m_capacityVar = std::max(m_capacityVar, GCC_CAPACITY_VAR_MIN);
+    m_capacityVar = std::min(m_capacityVar, GCC_CAPACITY_VAR_MAX);
+}
+
+float GccAimdRateControl::update(GccBandwidthUsage usage,
+                                 float ackedBps,
+                                 uint64_t rttUs,
+                                 uint64_t nowUs) {
+    if (!m_lastChangeValid) {
+        m_lastChangeUs = nowUs;
+        m_lastChangeValid = true;
+    }
+
+    /* state transitions, see Figure 2 in the rmcat-gcc draft */
+    switch (usage) {
+    case GCC_BW_NORMAL:
+        if (m_state == STATE_HOLD) {
+            m_state = STATE_INCREASE;
+        }
+        break;
+    case GCC_BW_OVERUSING:
+        /* give the previous decrease one RTT to take effect */
+        if (m_lastDecreaseValid && nowUs - m_lastDecreaseUs < rttUs) {
+            m_state = STATE_HOLD;
+        } else {
+            m_state = STATE_DECREASE;
+        }
+        break;
+    case GCC_BW_UNDERUSING:
+        m_state = STATE_HOLD;
+        break;
+    }
+
+    float bitrate = m_bitrate;
+    const uint64_t elapsedUs = nowUs - m_lastChangeUs;
+    switch (m_state) {
+    case STATE_HOLD:
+        break;
+    case STATE_INCREASE: {
+        if (ackedBps > 0.f && m_capacityAvgBps >= 0.f && !nearCapacity(ackedBps)) {
+            /* the link capacity estimate is obsolete */
+            m_capacityAvgBps = -1.f;
+        }
+        if (nearCapacity(bitrate)) {
+            const float responseUs = float(rttUs + GCC_AIMD_RESPONSE_EXTRA_US);
+            bitrate += std::max(GCC_AIMD_MIN_INCR_BPS,
+                                GCC_AIMD_PACKET_BITS * float(elapsedUs) / responseUs);
+        } else {
+            const float elapsedS = std::min(float(elapsedUs) / 1e6f, 1.f);
+            const float alpha = std::pow(GCC_AIMD_MULT_INCR, elapsedS);
+            bitrate += std::max(GCC_AIMD_MIN_INCR_BPS, bitrate * (alpha - 1.f));
+        }
+        /* don't go too far above what the receiver actually gets */
+        if (ackedBps > 0.f) {
+            bitrate = std::min(bitrate, 1.5f * ackedBps + 10000.f);
+        }
+        break;
+    }
+    case STATE_DECREASE: {
+        const float ref = ackedBps > 0.f ? ackedBps : m_bitrate;
+        bitrate = GCC_AIMD_BETA * ref;
+        if (bitrate > m_bitrate && m_capacityAvgBps >= 0.f) {
+            bitrate = GCC_AIMD_BETA * m_capacityAvgBps;
+        }
+        bitrate = std::min(bitrate, m_bitrate);
+        if (ackedBps > 0.f) {
+            onOveruse(ackedBps);
+        }
+        m_lastDecreaseUs = nowUs;
+        m_lastDecreaseValid = true;
+        m_state = STATE_HOLD;
+        break;
+    }
+    }
+
+    setBitrate(bitrate);
+    m_lastChangeUs = nowUs;
+    return m_bitrate;
+}
+
+}
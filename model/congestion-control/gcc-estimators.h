@@ -0,0 +1,246 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Building blocks of the Google Congestion Control (GCC) algorithm for
+ * rmcat ns3 module: packet group inter-arrival, trendline filter,
+ * overuse detector and AIMD rate control.
+ *
+ * They are independent from where the algorithm runs, so that both a
+ * sender-based (see #GccController) and a receiver-based deployment
+ * can be built out of them.
+ *
+ * A Google Congestion Control Algorithm for Real-Time Communication
+ * https://tools.ietf.org/html/draft-ietf-rmcat-gcc-02
+ *
+ * @version 0.1.1
+ */
+
+#ifndef GCC_ESTIMATORS_H
+#define GCC_ESTIMATORS_H
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace rmcat {
+
+/** Network state signaled by the overuse detector */
+enum GccBandwidthUsage {
+    GCC_BW_NORMAL,
+    GCC_BW_UNDERUSING,
+    GCC_BW_OVERUSING,
+};
+
+/**
+ * Groups packets sent within a short burst, and computes the difference
+ * in send and arrival times between consecutive groups (see Section 5.1
+ * of the rmcat-gcc draft). Timestamps are in microseconds; arrival
+ * timestamps can be taken with a clock not synchronized with the sender's
+ */
+class GccInterArrival {
+public:
+    GccInterArrival();
+
+    /** Forget all groups, as in a newly created object */
+    void reset();
+
+    /**
+     * Feed a packet's timestamps. Packets must be fed in send order;
+     * reordered packets are ignored
+     *
+     * @param [in] sendTimeUs Time at which the packet was sent
+     * @param [in] arrivalTimeUs Time at which the packet was received
+     * @param [in] size Size of the packet in bytes
+     * @param [out] sendDeltaUs Send time difference between the last two
+     *                          complete groups
+     * @param [out] arrivalDeltaUs Arrival time difference between the last
+     *                             two complete groups
+     * @retval true if this packet completed a group, so that the output
+     *         parameters are valid. False otherwise
+     */
+    bool computeDeltas(uint64_t sendTimeUs,
+                       uint64_t arrivalTimeUs,
+                       uint32_t size,
+                       int64_t& sendDeltaUs,
+                       int64_t& arrivalDeltaUs);
+
+private:
+    struct Group {
+        bool valid;
+        uint64_t firstSendUs;
+        uint64_t lastSendUs;
+        uint64_t firstArrivalUs;
+        uint64_t lastArrivalUs;
+        uint32_t size;
+    };
+
+    bool belongsToBurst(uint64_t sendTimeUs, uint64_t arrivalTimeUs) const;
+
+    Group m_current;
+    Group m_previous;
+};
+
+/**
+ * Estimates the trend of one-way delay variation as the slope of a
+ * linear regression on the accumulated, smoothed, inter-group delay
+ * variations (the "trendline filter" used by libwebrtc, which replaces
+ * the Kalman filter of the rmcat-gcc draft)
+ */
+class GccTrendlineEstimator {
+public:
+    GccTrendlineEstimator();
+
+    /** Forget all samples, as in a newly created object */
+    void reset();
+
+    /**
+     * Feed the deltas of a complete group
+     *
+     * @param [in] sendDeltaUs Inter-group send time difference
+     * @param [in] arrivalDeltaUs Inter-group arrival time difference
+     * @param [in] arrivalTimeUs Arrival time of the group
+     */
+    void update(int64_t sendDeltaUs, int64_t arrivalDeltaUs, uint64_t arrivalTimeUs);
+
+    /**
+     * Current trend, scaled by the number of samples seen (up to a
+     * maximum) and by a constant gain, so that it can be compared against
+     * the overuse detector's threshold
+     */
+    double getModifiedTrend() const;
+
+    /** Number of group deltas fed so far (capped) */
+    uint32_t getNumDeltas() const;
+
+private:
+    uint32_t m_numDeltas;
+    bool m_firstArrivalValid;
+    uint64_t m_firstArrivalUs;
+    double m_accumulatedDelayMs;
+    double m_smoothedDelayMs;
+    /** (arrival time in ms since first arrival, smoothed delay in ms) */
+    std::deque<std::pair<double, double> > m_window;
+    double m_trend;
+};
+
+/**
+ * Compares the delay trend against an adaptive threshold to decide
+ * whether the path is overused, underused or normal (see Sections 5.4
+ * and 5.5 of the rmcat-gcc draft)
+ */
+class GccOveruseDetector {
+public:
+    GccOveruseDetector();
+
+    /** Back to initial state and threshold */
+    void reset();
+
+    /**
+     * Run detection on a new trend sample
+     *
+     * @param [in] modifiedTrend Trend as given by
+     *                           GccTrendlineEstimator::getModifiedTrend
+     * @param [in] sendDeltaUs Send time difference of the groups that
+     *                         produced the sample
+     * @param [in] numDeltas Number of samples the trend is based upon
+     * @param [in] nowUs Current time
+     * @retval the detected network state
+     */
+    GccBandwidthUsage detect(double modifiedTrend,
+                             int64_t sendDeltaUs,
+                             uint32_t numDeltas,
+                             uint64_t nowUs);
+
+    /** Last detected network state */
+    GccBandwidthUsage getState() const;
+
+    /** Current (adaptive) threshold, in ms */
+    double getThreshold() const;
+
+private:
+    void updateThreshold(double modifiedTrend, uint64_t nowUs);
+
+    double m_threshold;
+    bool m_lastUpdateValid;
+    uint64_t m_lastUpdateUs;
+    double m_prevTrend;
+    double m_timeOverUsingMs;
+    uint32_t m_overuseCounter;
+    GccBandwidthUsage m_state;
+};
+
+/**
+ * Additive increase, multiplicative decrease rate controller driven
+ * by the overuse detector's output (see Section 5.5 of the rmcat-gcc
+ * draft), with libwebrtc's estimation of the link capacity to switch
+ * from multiplicative to additive increase
+ */
+class GccAimdRateControl {
+public:
+    GccAimdRateControl();
+
+    /** Back to initial state; the bitrate becomes invalid */
+    void reset();
+
+    /** Set the bounds of the bitrate, in bps */
+    void setBounds(float minBps, float maxBps);
+
+    /** Set the current bitrate, in bps */
+    void setBitrate(float bps);
+
+    /** Whether a bitrate has been set yet */
+    bool isBitrateValid() const;
+
+    /**
+     * Update the bitrate
+     *
+     * @param [in] usage Current network state
+     * @param [in] ackedBps Rate at which the receiver is acknowledging
+     *                      packets, 0 if unknown
+     * @param [in] rttUs Current round trip time
+     * @param [in] nowUs Current time
+     * @retval the new bitrate, in bps
+     */
+    float update(GccBandwidthUsage usage, float ackedBps, uint64_t rttUs, uint64_t nowUs);
+
+    /** Current bitrate, in bps */
+    float getBitrate() const;
+
+private:
+    enum State { STATE_HOLD, STATE_INCREASE, STATE_DECREASE };
+
+    void onOveruse(float ackedBps);
+    bool nearCapacity(float bps) const;
+
+    State m_state;
+    float m_bitrate;
+    bool m_bitrateValid;
+    float m_minBps;
+    float m_maxBps;
+    float m_capacityAvgBps;  /**< link capacity estimate, negative if unknown */
+    float m_capacityVar;     /**< normalized variance of m_capacityAvgBps */
+    uint64_t m_lastChangeUs;
+    bool m_lastChangeValid;
+    uint64_t m_lastDecreaseUs;
+    bool m_lastDecreaseValid;
+};
+
+}
+
+#endif /* GCC_ESTIMATORS_H */
@@ -40,62 +40,12 @@
 #include <cmath>
 
 
-/*
- * Default parameter values of the NADA algorithm,
- * corresponding to Figure 3 in the rmcat-nada draft
- */
-/* default parameters for core algorithm (gradual rate update) */
-
-const float NADA_PARAM_PRIO = 1.0;  /**< Weight of priority of the flow  */
-const float  NADA_PARAM_XREF = 10.0; /**< Reference congestion level (in ms) */
-
-const float NADA_PARAM_KAPPA = 0.5; /**< Scaling parameter for gradual rate update calculation (dimensionless) */
-const float NADA_PARAM_ETA = 2.0; /**< Scaling parameter for gradual rate update calculation (dimensionless) */
-const float NADA_PARAM_TAU = 500.; /**< Upper bound of RTT (in ms) in gradual rate update calculation */
-
-/**
- * Target interval for receiving feedback from receiver
- * or update rate calculation (in microseconds)
- */
-const uint64_t NADA_PARAM_DELTA_US = 100 * 1000;
-
-/* default parameters for accelerated ramp-up */
-
-/**  Threshold (microseconds) for allowed queuing delay build up at receiver during accelerated ramp-up mode */
-const uint64_t NADA_PARAM_QEPS_US = 10 * 1000;
-const uint64_t NADA_PARAM_DFILT_US = 120 * 1000; /**< Bound on filtering delay (in microseconds) */
-/** Upper bound on rate increase ratio in accelerated ramp-up mode (dimensionless) */
-const float NADA_PARAM_GAMMA_MAX = 0.5;
-/** Upper bound on self-inflicted queuing delay during ramp up (in ms) */
-const float NADA_PARAM_QBOUND = 50.;
-
-/* default parameters for non-linear warping of queuing delay */
-
-/** multiplier of observed average loss intervals, as a measure
- * of tolerance of missing observed loss events (dimensionless)
- */
-const float NADA_PARAM_MULTILOSS = 7.;
-
-const float NADA_PARAM_QTH = 50.; /**< Queuing delay threshold for invoking non-linear warping (in ms) */
-const float NADA_PARAM_LAMBDA = 0.5; /**< Exponent of the non-linear warping (dimensionless) */
-
-/* default parameters for calculating aggregated congestion signal */
-
-/**
- * Reference delay penalty (in ms) in terms of value
- * of congestion price when packet loss ratio is at PLRREF
- */
-const float NADA_PARAM_DLOSS = 10.;
-const float NADA_PARAM_PLRREF = 0.01; /**> Reference packet loss ratio (dimensionless) */
-const float NADA_PARAM_XMAX = 500.; /**> Maximum value of aggregate congestion signal (in ms) */
-
-/** Smoothing factor in exponential smoothing of packet loss and marking ratios */
-const float NADA_PARAM_ALPHA = 0.1;
-
 namespace rmcat {
 
-NadaController::NadaController() :
+template<class Params>
+NadaControllerT<Params>::NadaControllerT() :
     SenderBasedController{},
+    m_params{},
     m_ploss{0},
     m_plr{0.f},
     m_warpMode{false},
@@ -111,9 +61,11 @@ NadaController::NadaController() :
     m_currInt{0},
     m_lossesSeen{false} {}
 
-NadaController::~NadaController() {}
+template<class Params>
+NadaControllerT<Params>::~NadaControllerT() {}
 
-void NadaController::setCurrentBw(float newBw) {
+template<class Params>
+void NadaControllerT<Params>::setCurrentBw(float newBw) {
     m_currBw = newBw;
 }
 
@@ -121,7 +73,8 @@ void NadaController::setCurrentBw(float newBw) {
  * Implementation of the #reset API: reset all state variables
  * to default values
  */
-void NadaController::reset() {
+template<class Params>
+void NadaControllerT<Params>::reset() {
     m_ploss = 0;
     m_plr = 0.f;
     m_warpMode = false;
@@ -139,7 +92,8 @@ void NadaController::reset() {
     SenderBasedController::reset();
 }
 
-bool NadaController::processSendPacket(uint64_t txTimestampUs,
+template<class Params>
+bool NadaControllerT<Params>::processSendPacket(uint64_t txTimestampUs,
                                        uint16_t sequence,
                                        uint32_t size) { // in Bytes
     /* First of all, call the superclass */
@@ -160,10 +114,9 @@ bool NadaController::processSendPacket(uint64_t txTimestampUs,
 /**
  * Implementation of the #processFeedback API
  * in the SenderBasedController class
- *
- * TODO (deferred): Add support for ECN marking
  */
-bool NadaController::processFeedback(uint64_t nowUs,
+template<class Params>
+bool NadaControllerT<Params>::processFeedback(uint64_t nowUs,
                                      uint16_t sequence,
                                      uint64_t rxTimestampUs,
                                      uint8_t ecn) {
@@ -176,7 +129,7 @@ bool NadaController::processFeedback(uint64_t nowUs,
     }
 
     /* Update calculation of reference rate (r_ref)
-     * if last calculation occurred more than NADA_PARAM_DELTA_US
+     * if last calculation occurred more than DELTA_US
      * (target update interval in microseconds) ago
      */
 
@@ -190,7 +143,7 @@ bool NadaController::processFeedback(uint64_t nowUs,
     assert(lessThan(m_lastTimeCalcUs, nowUs + 1));
     /* calculate time since last update */
     const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
-    if (deltaUs >= NADA_PARAM_DELTA_US) {
+    if (deltaUs >= m_params.DELTA_US) {
         /* log & update rate calculation */
         updateMetrics();
         updateBw(deltaUs);
@@ -201,7 +154,8 @@ bool NadaController::processFeedback(uint64_t nowUs,
     return true;
 }
 
-bool NadaController::processFeedbackBatch(uint64_t nowUs,
+template<class Params>
+bool NadaControllerT<Params>::processFeedbackBatch(uint64_t nowUs,
                                           const std::vector<FeedbackItem>& feedbackBatch) {
     /* First of all, call the superclass */
     if (!SenderBasedController::processFeedbackBatch(nowUs, feedbackBatch)) {
@@ -209,7 +163,7 @@ bool NadaController::processFeedbackBatch(uint64_t nowUs,
     }
 
     /* Update calculation of reference rate (r_ref)
-     * Make sure that last calculation occurred more than NADA_PARAM_DELTA_US
+     * Make sure that last calculation occurred more than DELTA_US
      * (target update interval in microseconds) ago. Apply with some leniency
      * so that calculation time coincides with aggregate feedback processing
      * most of the time.
@@ -226,7 +180,7 @@ bool NadaController::processFeedbackBatch(uint64_t nowUs,
     /* calculate time since last update */
     const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
     /* 50% leniency */
-    if (deltaUs < NADA_PARAM_DELTA_US * .5) {
+    if (deltaUs < m_params.DELTA_US * .5) {
         return true;
     }
     /* log & update rate calculation */
@@ -244,7 +198,8 @@ bool NadaController::processFeedbackBatch(uint64_t nowUs,
  * returns the calculated reference rate
  * (r_ref in rmcat-nada)
  */
-float NadaController::getBandwidth(uint64_t nowUs) const {
+template<class Params>
+float NadaControllerT<Params>::getBandwidth(uint64_t nowUs) const {
     return m_currBw;
 }
 
@@ -254,7 +209,8 @@ float NadaController::getBandwidth(uint64_t nowUs) const {
  * control algorithm as specified in the rmcat-nada
  * draft (see Section 4)
  */
-void NadaController::updateBw(uint64_t deltaUs) {
+template<class Params>
+void NadaControllerT<Params>::updateBw(uint64_t deltaUs) {
 
     int rmode = getRampUpMode();
     if (rmode == 0) {
@@ -263,6 +219,12 @@ void NadaController::updateBw(uint64_t deltaUs) {
         calcGradualRateUpdate(deltaUs);
     }
 
+    /* Scalable (L4S-style) response to CE marks, at most once per RTT */
+    float ecnFactor = 1.f;
+    if (getEcnReduction(ecnFactor)) {
+        m_currBw *= ecnFactor;
+    }
+
     /* clip final rate within range */
     m_currBw = std::min(m_currBw, m_maxBw);
     m_currBw = std::max(m_currBw, m_minBw);
@@ -274,7 +236,8 @@ void NadaController::updateBw(uint64_t deltaUs) {
  * rate from the base class SenderBasedController
  * and saves them to local member variables.
  */
-void NadaController::updateMetrics() {
+template<class Params>
+void NadaControllerT<Params>::updateMetrics() {
 
     /* Obtain packet stats in terms of loss and delay */
     uint64_t qdelayUs = 0;
@@ -295,7 +258,7 @@ void NadaController::updateMetrics() {
     if (plrOK) {
         m_ploss = nLoss;
         // Exponential filtering of loss stats
-        m_plr += NADA_PARAM_ALPHA * (plr - m_plr);
+        m_plr += m_params.ALPHA * (plr - m_plr);
     }
 
     float avgInt;
@@ -313,7 +276,8 @@ void NadaController::updateMetrics() {
 
 }
 
-void NadaController::logStats(uint64_t nowUs, uint64_t deltaUs) const {
+template<class Params>
+void NadaControllerT<Params>::logStats(uint64_t nowUs, uint64_t deltaUs) const {
 
     std::ostringstream os;
     os << std::fixed;
@@ -351,14 +315,15 @@ void NadaController::logStats(uint64_t nowUs, uint64_t deltaUs) const {
  *            \ QTH exp(-LAMBDA ---------------), otherwise.
  *                                    QTH
  */
-float NadaController::calcDtilde() const {
+template<class Params>
+float NadaControllerT<Params>::calcDtilde() const {
     const float qDelay = float(m_QdelayUs) / 1000.f;
     float xval = qDelay;
 
-    if (m_QdelayUs / 1000 > NADA_PARAM_QTH) {
-        float ratio = (qDelay - NADA_PARAM_QTH) / NADA_PARAM_QTH;
-        ratio = NADA_PARAM_LAMBDA * ratio;
-        xval = float(NADA_PARAM_QTH * exp(-ratio));
+    if (m_QdelayUs / 1000 > m_params.QTH) {
+        float ratio = (qDelay - m_params.QTH) / m_params.QTH;
+        ratio = m_params.LAMBDA * ratio;
+        xval = float(m_params.QTH * exp(-ratio));
     }
 
     return xval;
@@ -371,7 +336,8 @@ float NadaController::calcDtilde() const {
  * invoking the non-linear warping of queuing
  * delay is described in Sec. 4.2 of the draft.
  */
-void NadaController::updateXcurr() {
+template<class Params>
+void NadaControllerT<Params>::updateXcurr() {
 
     float xdel = float(m_QdelayUs) / 1000.f; // pure delay-based
     float xtilde = calcDtilde();             // warped version
@@ -382,10 +348,10 @@ void NadaController::updateXcurr() {
      * time window for last observed loss self-adapts
      * with previously observed loss intervals
      * */
-    if (m_lossesSeen && currInt < NADA_PARAM_MULTILOSS * m_avgInt) {
+    if (m_lossesSeen && currInt < m_params.MULTILOSS * m_avgInt) {
         /* last loss observed within the time window
-         * NADA_PARAM_MULTILOSS * m_avgInt; allowing us to
-         * miss up to NADA_PARAM_MULTILOSS-1 loss events
+         * MULTILOSS * m_avgInt; allowing us to
+         * miss up to MULTILOSS-1 loss events
          */
         m_Xcurr = xtilde;
         m_warpMode = true;
@@ -394,11 +360,11 @@ void NadaController::updateXcurr() {
           * to non-warped queuing delay over the course
           * of one average packet loss interval (m_avgInt)
           */
-        if (currInt < (NADA_PARAM_MULTILOSS + 1.f) * m_avgInt) {
+        if (currInt < (m_params.MULTILOSS + 1.f) * m_avgInt) {
             /* transition period: linearly blending
              * warped and non-warped values for congestion
              * price */
-            const float alpha = (currInt - NADA_PARAM_MULTILOSS * m_avgInt) / m_avgInt;
+            const float alpha = (currInt - m_params.MULTILOSS * m_avgInt) / m_avgInt;
             m_Xcurr = alpha * xdel + (1.f - alpha) * xtilde;
         } else {
             /* after transition period: switch completely
@@ -416,12 +382,12 @@ void NadaController::updateXcurr() {
     /* Add additional loss penalty for the aggregate
      * congestion signal, following Eq.(2) in Sec.4.2 of
      * rmcat-nada draft */
-    float plr0 = m_plr / NADA_PARAM_PLRREF;
-    m_Xcurr += NADA_PARAM_DLOSS * plr0 * plr0;
+    float plr0 = m_plr / m_params.PLRREF;
+    m_Xcurr += m_params.DLOSS * plr0 * plr0;
 
     /* Clip final congestion signal within range */
-    if (m_Xcurr > NADA_PARAM_XMAX) {
-        m_Xcurr = NADA_PARAM_XMAX;
+    if (m_Xcurr > m_params.XMAX) {
+        m_Xcurr = m_params.XMAX;
     }
 
 }
@@ -444,7 +410,8 @@ void NadaController::updateXcurr() {
  *               - KAPPA*ETA*---------*r_ref         (7)
  *                              TAU
  */
-void NadaController::calcGradualRateUpdate(uint64_t deltaUs) {
+template<class Params>
+void NadaControllerT<Params>::calcGradualRateUpdate(uint64_t deltaUs) {
 
     float x_curr = m_Xcurr;
     float x_prev = m_Xprev;
@@ -454,16 +421,16 @@ void NadaController::calcGradualRateUpdate(uint64_t deltaUs) {
     float r_offset = m_currBw;
     float r_diff = m_currBw;
 
-    x_offset -= NADA_PARAM_PRIO * NADA_PARAM_XREF * m_maxBw / m_currBw;
+    x_offset -= m_params.PRIO * m_params.XREF * m_maxBw / m_currBw;
 
-    r_offset *= NADA_PARAM_KAPPA;
+    r_offset *= m_params.KAPPA;
     const float delta = float(deltaUs) / 1000.;
-    r_offset *= delta / NADA_PARAM_TAU;
-    r_offset *= x_offset / NADA_PARAM_TAU;
+    r_offset *= delta / m_params.TAU;
+    r_offset *= x_offset / m_params.TAU;
 
-    r_diff *= NADA_PARAM_KAPPA;
-    r_diff *= NADA_PARAM_ETA;
-    r_diff *= x_diff / NADA_PARAM_TAU;
+    r_diff *= m_params.KAPPA;
+    r_diff *= m_params.ETA;
+    r_diff *= x_diff / m_params.TAU;
 
     m_currBw = m_currBw - r_offset - r_diff;
 }
@@ -479,19 +446,20 @@ void NadaController::calcGradualRateUpdate(uint64_t deltaUs) {
  *
  * r_ref = max(r_ref, (1+gamma) r_recv)           (4)
  */
-void NadaController::calcAcceleratedRampUp( ) {
+template<class Params>
+void NadaControllerT<Params>::calcAcceleratedRampUp( ) {
 
     float gamma = 1.0;
 
     uint64_t denom = m_RttUs;
-    denom += NADA_PARAM_DELTA_US;
-    denom += NADA_PARAM_DFILT_US;
+    denom += m_params.DELTA_US;
+    denom += m_params.DFILT_US;
     denom /= 1000; // Us --> ms
 
-    gamma = NADA_PARAM_QBOUND / float(denom);
+    gamma = m_params.QBOUND / float(denom);
 
-    if (gamma > NADA_PARAM_GAMMA_MAX) {
-        gamma = NADA_PARAM_GAMMA_MAX;
+    if (gamma > m_params.GAMMA_MAX) {
+        gamma = m_params.GAMMA_MAX;
     }
 
     float rnew = (1.f + gamma) * m_RecvR;
@@ -511,7 +479,8 @@ void NadaController::calcAcceleratedRampUp( ) {
  * o No build-up of queuing delay: d_fwd-d_base < QEPS for all previous
  *   delay samples within the observation window LOGWIN.
  */
-int NadaController::getRampUpMode() {
+template<class Params>
+int NadaControllerT<Params>::getRampUpMode() {
     int rmode = 0;
 
     /* If losses are observed, stay with gradual update */
@@ -524,11 +493,21 @@ int NadaController::getRampUpMode() {
               ++rit) {
 
         const uint64_t qDelayCurrentUs = rit->owdUs - m_baseDelayUs;
-        if (qDelayCurrentUs > NADA_PARAM_QEPS_US ) {
+        if (qDelayCurrentUs > m_params.QEPS_US ) {
             rmode = 1;  /* Gradual update if queuing delay exceeds threshold*/
         }
+        if (rit->ecn == RMCAT_ECN_CE) {
+            rmode = 1;  /* Gradual update if the bottleneck marks packets */
+        }
     }
     return rmode;
 }
 
+/* Parameter policies shipped with the module */
+template class NadaControllerT<NadaDefaultParams>;
+template class NadaControllerT<NadaLowLatencyParams>;
+template class NadaControllerT<NadaHighThroughputParams>;
+template class NadaControllerT<NadaWirelessParams>;
+template class NadaControllerT<NadaRuntimeParams>;
+
 }
@@ -32,6 +32,125 @@
 
 namespace rmcat {
 
+/**
+ * Default parameter values of the NADA algorithm,
+ * corresponding to Figure 3 in the rmcat-nada draft.
+ *
+ * NADA is parameterized by a policy class (see #NadaControllerT)
+ * providing the members below. Policies like this one, with static
+ * constexpr members, are resolved at compile time; see
+ * #NadaRuntimeParams for a policy that can be changed at run time.
+ */
+struct NadaDefaultParams {
+    /* default parameters for core algorithm (gradual rate update) */
+
+    static constexpr float PRIO = 1.0;  /**< Weight of priority of the flow  */
+    static constexpr float XREF = 10.0; /**< Reference congestion level (in ms) */
+
+    static constexpr float KAPPA = 0.5; /**< Scaling parameter for gradual rate update calculation (dimensionless) */
+    static constexpr float ETA = 2.0; /**< Scaling parameter for gradual rate update calculation (dimensionless) */
+    static constexpr float TAU = 500.; /**< Upper bound of RTT (in ms) in gradual rate update calculation */
+
+    /**
+     * Target interval for receiving feedback from receiver
+     * or update rate calculation (in microseconds)
+     */
+    static constexpr uint64_t DELTA_US = 100 * 1000;
+
+    /* default parameters for accelerated ramp-up */
+
+    /**  Threshold (microseconds) for allowed queuing delay build up at receiver during accelerated ramp-up mode */
+    static constexpr uint64_t QEPS_US = 10 * 1000;
+    static constexpr uint64_t DFILT_US = 120 * 1000; /**< Bound on filtering delay (in microseconds) */
+    /** Upper bound on rate increase ratio in accelerated ramp-up mode (dimensionless) */
+    static constexpr float GAMMA_MAX = 0.5;
+    /** Upper bound on self-inflicted queuing delay during ramp up (in ms) */
+    static constexpr float QBOUND = 50.;
+
+    /* default parameters for non-linear warping of queuing delay */
+
+    /** multiplier of observed average loss intervals, as a measure
+     * of tolerance of missing observed loss events (dimensionless)
+     */
+    static constexpr float MULTILOSS = 7.;
+
+    static constexpr float QTH = 50.; /**< Queuing delay threshold for invoking non-linear warping (in ms) */
+    static constexpr float LAMBDA = 0.5; /**< Exponent of the non-linear warping (dimensionless) */
+
+    /* default parameters for calculating aggregated congestion signal */
+
+    /**
+     * Reference delay penalty (in ms) in terms of value
+     * of congestion price when packet loss ratio is at PLRREF
+     */
+    static constexpr float DLOSS = 10.;
+    static constexpr float PLRREF = 0.01; /**> Reference packet loss ratio (dimensionless) */
+    static constexpr float XMAX = 500.; /**> Maximum value of aggregate congestion signal (in ms) */
+
+    /** Smoothing factor in exponential smoothing of packet loss and marking ratios */
+    static constexpr float ALPHA = 0.1;
+};
+
+/**
+ * Keeps queuing delay low, at the expense of throughput when
+ * competing with other flows: lower reference congestion level,
+ * and less queuing delay tolerated during ramp-up
+ */
+struct NadaLowLatencyParams: public NadaDefaultParams {
+    static constexpr float XREF = 5.0;
+    static constexpr uint64_t QEPS_US = 5 * 1000;
+    static constexpr float QBOUND = 25.;
+    static constexpr float QTH = 25.;
+};
+
+/**
+ * Favors throughput over queuing delay: higher reference congestion
+ * level, and more queuing delay tolerated before rate decreases
+ */
+struct NadaHighThroughputParams: public NadaDefaultParams {
+    static constexpr float XREF = 20.0;
+    static constexpr float QBOUND = 100.;
+    static constexpr float QTH = 100.;
+};
+
+/**
+ * Tuned for wireless links, where delay jitter and losses not caused by
+ * congestion are common: ramp-up tolerates more jitter, and losses are
+ * penalized less
+ */
+struct NadaWirelessParams: public NadaDefaultParams {
+    static constexpr uint64_t QEPS_US = 20 * 1000;
+    static constexpr uint64_t DFILT_US = 200 * 1000;
+    static constexpr float MULTILOSS = 10.;
+    static constexpr float DLOSS = 5.;
+    static constexpr float PLRREF = 0.02;
+};
+
+/**
+ * Parameter policy whose values can be changed at run time, e.g., to
+ * sweep parameters without recompiling (see ns3::NadaParamsProfile).
+ * Defaults are those of #NadaDefaultParams
+ */
+struct NadaRuntimeParams {
+    float PRIO = NadaDefaultParams::PRIO;
+    float XREF = NadaDefaultParams::XREF;
+    float KAPPA = NadaDefaultParams::KAPPA;
+    float ETA = NadaDefaultParams::ETA;
+    float TAU = NadaDefaultParams::TAU;
+    uint64_t DELTA_US = NadaDefaultParams::DELTA_US;
+    uint64_t QEPS_US = NadaDefaultParams::QEPS_US;
+    uint64_t DFILT_US = NadaDefaultParams::DFILT_US;
+    float GAMMA_MAX = NadaDefaultParams::GAMMA_MAX;
+    float QBOUND = NadaDefaultParams::QBOUND;
+    float MULTILOSS = NadaDefaultParams::MULTILOSS;
+    float QTH = NadaDefaultParams::QTH;
+    float LAMBDA = NadaDefaultParams::LAMBDA;
+    float DLOSS = NadaDefaultParams::DLOSS;
+    float PLRREF = NadaDefaultParams::PLRREF;
+    float XMAX = NadaDefaultParams::XMAX;
+    float ALPHA = NadaDefaultParams::ALPHA;
+};
+
 /**
  * This class corresponds to the congestion control scheme
  * named Network-Assisted Dynamic Adaptation (NADA). Details
@@ -41,14 +160,26 @@ namespace rmcat {
  * NADA: A Unified Congestion Control Scheme for Real-Time Media
  * https://tools.ietf.org/html/draft-ietf-rmcat-nada-04
  *
+ * The algorithm's parameters are provided by the Params policy, e.g.,
+ * #NadaDefaultParams. The implementation is explicitly instantiated for
+ * the policies declared in this file only.
  */
-class NadaController: public SenderBasedController {
+template<class Params>
+class NadaControllerT: public SenderBasedController {
 public:
     /* class constructor */
-    NadaController();
+    NadaControllerT();
 
     /* class destructor */
-    virtual ~NadaController();
+    virtual ~NadaControllerT();
+
+    /**
+     * Set the algorithm's parameters. Only meaningful for run time
+     * policies such as #NadaRuntimeParams; call before the flow starts
+     *
+     * @param [in] params New parameter values
+     */
+    void setParams(const Params& params) { m_params = params; }
 
     /**
      * Set the current bandwidth estimation. This can be useful in test environments
@@ -170,6 +301,7 @@ private:
      * packet loss/delay information, as well as operational
      * mode of the NADA algorithm
      */
+    Params m_params; /**< parameter policy; empty for compile-time policies */
     uint32_t m_ploss; /**< packet loss count within configured window */
     float m_plr;     /**< packet loss ratio within packet history window */
     bool m_warpMode;  /**< whether to perform non-linear warping of queuing delay */
@@ -191,6 +323,9 @@ private:
     bool m_lossesSeen; /**< Whether packet losses/reorderings have been detected so far */
 };
 
+/** NADA with the parameters of the rmcat-nada draft */
+typedef NadaControllerT<NadaDefaultParams> NadaController;
+
 }
 
 #endif /* NADA_CONTROLLER_H */
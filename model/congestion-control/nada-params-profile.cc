@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Run time NADA parameters, as ns3 attributes.
+ *
+ * @version 0.1.1
+ */
+
+#include "nada-params-profile.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (NadaParamsProfile);
+
+TypeId NadaParamsProfile::GetTypeId ()
+{
+    // Attributes live in the rmcat::NadaRuntimeParams base
+    const rmcat::NadaRuntimeParams defaults{};
+    static TypeId tid = TypeId ("ns3::NadaParamsProfile")
+        .SetParent<Object> ()
+        .SetGroupName ("Applications")
+        .AddConstructor<NadaParamsProfile> ()
+        .AddAttribute ("Prio",
+                       "Weight of priority of the flow",
+                       DoubleValue (defaults.PRIO),
+                       MakeDoubleAccessor (&NadaParamsProfile::PRIO),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Xref",
+                       "Reference congestion level (in ms)",
+                       DoubleValue (defaults.XREF),
+                       MakeDoubleAccessor (&NadaParamsProfile::XREF),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Kappa",
+                       "Scaling parameter for gradual rate update calculation",
+                       DoubleValue (defaults.KAPPA),
+                       MakeDoubleAccessor (&NadaParamsProfile::KAPPA),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Eta",
+                       "Scaling parameter for gradual rate update calculation",
+                       DoubleValue (defaults.ETA),
+                       MakeDoubleAccessor (&NadaParamsProfile::ETA),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Tau",
+                       "Upper bound of RTT (in ms) in gradual rate update calculation",
+                       DoubleValue (defaults.TAU),
+                       MakeDoubleAccessor (&NadaParamsProfile::TAU),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("DeltaUs",
+                       "Target interval for rate update calculation (in microseconds)",
+                       UintegerValue (defaults.DELTA_US),
+                       MakeUintegerAccessor (&NadaParamsProfile::DELTA_US),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("QepsUs",
+                       "Threshold for queuing delay build up during accelerated ramp-up (in microseconds)",
+                       UintegerValue (defaults.QEPS_US),
+                       MakeUintegerAccessor (&NadaParamsProfile::QEPS_US),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("DfiltUs",
+                       "Bound on filtering delay (in microseconds)",
+                       UintegerValue (defaults.DFILT_US),
+                       MakeUintegerAccessor (&NadaParamsProfile::DFILT_US),
+                       MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("GammaMax",
+                       "Upper bound on rate increase ratio in accelerated ramp-up mode",
+                       DoubleValue (defaults.GAMMA_MAX),
+                       MakeDoubleAccessor (&NadaParamsProfile::GAMMA_MAX),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Qbound",
+                       "Upper bound on self-inflicted queuing delay during ramp up (in ms)",
+                       DoubleValue (defaults.QBOUND),
+                       MakeDoubleAccessor (&NadaParamsProfile::QBOUND),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Multiloss",
+                       "Multiplier of observed average loss intervals for non-linear warping",
+                       DoubleValue (defaults.MULTILOSS),
+                       MakeDoubleAccessor (&NadaParamsProfile::MULTILOSS),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Qth",
+                       "Queuing delay threshold for invoking non-linear warping (in ms)",
+                       DoubleValue (defaults.QTH),
+                       MakeDoubleAccessor (&NadaParamsProfile::QTH),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Lambda",
+                       "Exponent of the non-linear warping",
+                       DoubleValue (defaults.LAMBDA),
+                       MakeDoubleAccessor (&NadaParamsProfile::LAMBDA),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Dloss",
+                       "Reference delay penalty (in ms) when packet loss ratio is at PLRREF",
+                       DoubleValue (defaults.DLOSS),
+                       MakeDoubleAccessor (&NadaParamsProfile::DLOSS),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Plrref",
+                       "Reference packet loss ratio",
+                       DoubleValue (defaults.PLRREF),
+                       MakeDoubleAccessor (&NadaParamsProfile::PLRREF),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Xmax",
+                       "Maximum value of aggregate congestion signal (in ms)",
+                       DoubleValue (defaults.XMAX),
+                       MakeDoubleAccessor (&NadaParamsProfile::XMAX),
+                       MakeDoubleChecker<float> ())
+        .AddAttribute ("Alpha",
+                       "Smoothing factor of packet loss and marking ratios",
+                       DoubleValue (defaults.ALPHA),
+                       MakeDoubleAccessor (&NadaParamsProfile::ALPHA),
+                       MakeDoubleChecker<float> ());
+    return tid;
+}
+
+NadaParamsProfile::NadaParamsProfile ()
+: Object{}
+, rmcat::NadaRuntimeParams{}
+{}
+
+NadaParamsProfile::~NadaParamsProfile ()
+{}
+
+rmcat::NadaRuntimeParams NadaParamsProfile::GetParams () const
+{
+    return *this;
+}
+
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Run time NADA parameters, as ns3 attributes.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef NADA_PARAMS_PROFILE_H
+#define NADA_PARAMS_PROFILE_H
+
+#include "nada-controller.h"
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * Exposes #rmcat::NadaRuntimeParams as ns3 attributes, so that NADA
+ * can be tuned without recompiling, e.g., from the command line:
+ *
+ *   --ns3::NadaParamsProfile::Xref=20
+ *
+ * Attribute names are the rmcat-nada parameter names, in camel case.
+ * Create a profile once the attribute defaults are set, and pass its
+ * parameters to a rmcat::NadaControllerT<rmcat::NadaRuntimeParams>.
+ */
+class NadaParamsProfile : public Object, public rmcat::NadaRuntimeParams
+{
+public:
+    static TypeId GetTypeId ();
+
+    NadaParamsProfile ();
+    virtual ~NadaParamsProfile ();
+
+    rmcat::NadaRuntimeParams GetParams () const;
+};
+
+}
+
+#endif /* NADA_PARAMS_PROFILE_H */
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Probe cluster delivery rate estimation implementation for rmcat ns3
+ * module.
+ *
+ * @version 0.1.1
+ */
+
+#include "probe-bitrate-estimator.h"
+#include <algorithm>
+
+namespace rmcat {
+
+/* Parameters from libwebrtc's ProbeBitrateEstimator */
+const float PROBE_MIN_RECEIVED_PACKETS_RATIO = 0.8f; /**< of the cluster's minimum */
+const float PROBE_MIN_RECEIVED_BYTES_RATIO = 0.8f;   /**< of the cluster's minimum */
+const float PROBE_MAX_VALID_RATIO = 2.f;     /**< receive rate to send rate */
+const float PROBE_MIN_RATIO_UNSATURATED = 0.9f;
+const float PROBE_TARGET_UTILIZATION = 0.95f;
+const uint64_t PROBE_MAX_INTERVAL_US = 1000 * 1000;
+const uint64_t PROBE_MAX_CLUSTER_AGE_US = 1000 * 1000;
+
+ProbeBitrateEstimator::ProbeBitrateEstimator() :
+    m_clusters{} {}
+
+void ProbeBitrateEstimator::reset() {
+    m_clusters.clear();
+}
+
+void ProbeBitrateEstimator::addCluster(const ProbeCluster& cluster, uint64_t nowUs) {
+    /* Old clusters are not expected to receive more acknowledgments */
+    while (!m_clusters.empty() &&
+           m_clusters.front().createdUs + PROBE_MAX_CLUSTER_AGE_US < nowUs) {
+        m_clusters.pop_front();
+    }
+    ClusterState state{};
+    state.cluster = cluster;
+    state.createdUs = nowUs;
+    m_clusters.push_back(state);
+}
+
+bool ProbeBitrateEstimator::update(uint32_t clusterId,
+                                   uint64_t txTimestampUs,
+                                   uint64_t rxTimestampUs,
+                                   uint32_t size,
+                                   uint64_t nowUs,
+                                   float& deliveryBps) {
+    /* Few clusters are alive at any time */
+    auto it = std::find_if(m_clusters.begin(), m_clusters.end(),
+                           [clusterId](const ClusterState& s) {
+                               return s.cluster.id == clusterId;
+                           });
+    if (it == m_clusters.end() || it->createdUs + PROBE_MAX_CLUSTER_AGE_US < nowUs) {
+        return false;
+    }
+    ClusterState& state = *it;
+
+    if (state.numPackets == 0 || txTimestampUs < state.firstSendUs) {
+        state.firstSendUs = txTimestampUs;
+    }
+    if (state.numPackets == 0 || txTimestampUs >= state.lastSendUs) {
+        state.lastSendUs = txTimestampUs;
+        state.sizeLastSend = size;
+    }
+    if (state.numPackets == 0 || rxTimestampUs < state.firstRecvUs) {
+        state.firstRecvUs = rxTimestampUs;
+        state.sizeFirstRecv = size;
+    }
+    if (state.numPackets == 0 || rxTimestampUs > state.lastRecvUs) {
+        state.lastRecvUs = rxTimestampUs;
+    }
+    ++state.numPackets;
+    state.totalBytes += size;
+
+    if (state.numPackets < PROBE_MIN_RECEIVED_PACKETS_RATIO * state.cluster.minPackets ||
+        state.totalBytes < PROBE_MIN_RECEIVED_BYTES_RATIO * state.cluster.minBytes) {
+        return false;
+    }
+
+    const uint64_t sendIntervalUs = state.lastSendUs - state.firstSendUs;
+    const uint64_t recvIntervalUs = state.lastRecvUs - state.firstRecvUs;
+    if (sendIntervalUs == 0 || sendIntervalUs > PROBE_MAX_INTERVAL_US ||
+        recvIntervalUs == 0 || recvIntervalUs > PROBE_MAX_INTERVAL_US) {
+        return false;
+    }
+
+    /* The last packet sent and the first received do not
+     * take up any of their respective intervals */
+    const float sendBps = 8.f * float(state.totalBytes - state.sizeLastSend) * 1e6f /
+                          float(sendIntervalUs);
+    const float recvBps = 8.f * float(state.totalBytes - state.sizeFirstRecv) * 1e6f /
+                          float(recvIntervalUs);
+    if (recvBps > PROBE_MAX_VALID_RATIO * sendBps) {
+        /* Compressed on the way, e.g., by a burst of delayed packets */
+        return false;
+    }
+
+    deliveryBps = std::min(sendBps, recvBps);
+    if (recvBps < PROBE_MIN_RATIO_UNSATURATED * sendBps) {
+        /* The path is saturated, the receive rate is the capacity */
+        deliveryBps = PROBE_TARGET_UTILIZATION * recvBps;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Probe cluster delivery rate estimation for rmcat ns3 module: the
+ * sender sends bursts of packets (probe clusters) faster than the
+ * media, and their acknowledgments tell how fast the path can deliver.
+ *
+ * The estimation follows libwebrtc's ProbeBitrateEstimator.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef PROBE_BITRATE_ESTIMATOR_H
+#define PROBE_BITRATE_ESTIMATOR_H
+
+#include <cstdint>
+#include <deque>
+
+namespace rmcat {
+
+/**
+ * A burst of packets a controller asks the sender to send at a given
+ * rate, on top of the media, to probe for available bandwidth. The
+ * cluster is complete once both minimums are reached
+ */
+struct ProbeCluster {
+    uint32_t id;          /**< unique per controller; 0 means no cluster */
+    float rateBps;        /**< rate at which to send the cluster's packets */
+    uint32_t minPackets;  /**< packets to send at least */
+    uint32_t minBytes;    /**< bytes to send at least */
+};
+
+/**
+ * Estimates the rate at which the path delivered each probe cluster,
+ * out of the send and receive timestamps of its acknowledged packets.
+ * The estimate is the minimum of the send and receive rates; if the
+ * packets were received notably slower than sent, the path is
+ * saturated, and the estimate is slightly below the receive rate
+ */
+class ProbeBitrateEstimator {
+public:
+    ProbeBitrateEstimator();
+
+    /** Forget all clusters, as in a newly created object */
+    void reset();
+
+    /**
+     * Start tracking a cluster handed out to the sender
+     *
+     * @param [in] cluster The new cluster
+     * @param [in] nowUs Current time
+     */
+    void addCluster(const ProbeCluster& cluster, uint64_t nowUs);
+
+    /**
+     * Account for an acknowledged packet of a cluster
+     *
+     * @param [in] clusterId Cluster the packet was sent in
+     * @param [in] txTimestampUs Time at which the packet was sent
+     * @param [in] rxTimestampUs Time at which the packet was received
+     * @param [in] size Size of the packet in bytes
+     * @param [in] nowUs Current time
+     * @param [out] deliveryBps Delivery rate of the cluster so far
+     * @retval true if enough of the cluster has been acknowledged for
+     *         the estimate to be valid. False otherwise (e.g., unknown
+     *         or expired cluster)
+     */
+    bool update(uint32_t clusterId,
+                uint64_t txTimestampUs,
+                uint64_t rxTimestampUs,
+                uint32_t size,
+                uint64_t nowUs,
+                float& deliveryBps);
+
+private:
+    struct ClusterState {
+        ProbeCluster cluster;
+        uint64_t createdUs;
+        uint32_t numPackets;
+        uint32_t totalBytes;
+        uint64_t firstSendUs;
+        uint64_t lastSendUs;
+        uint64_t firstRecvUs;
+        uint64_t lastRecvUs;
+        uint32_t sizeLastSend;   /**< not part of the send rate */
+        uint32_t sizeFirstRecv;  /**< not part of the receive rate */
+    };
+
+    std::deque<ClusterState> m_clusters;  /**< in creation order */
+};
+
+}
+
+#endif /* PROBE_BITRATE_ESTIMATOR_H */
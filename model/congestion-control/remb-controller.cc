@@ -0,0 +1,72 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * REMB controller implementation for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#include "remb-controller.h"
+#include <sstream>
+#include <algorithm>
+
+namespace rmcat {
+
+RembController::RembController() :
+    SenderBasedController{},
+    m_currBwValid{false},
+    m_currBw{0.f} {}
+
+RembController::~RembController() {}
+
+void RembController::setCurrentBw(float newBw) {
+    m_currBw = newBw;
+    m_currBwValid = true;
+}
+
+void RembController::reset() {
+    m_currBwValid = false;
+    m_currBw = 0.f;
+    SenderBasedController::reset();
+}
+
+void RembController::processRemb(uint64_t nowUs, float rembBps) {
+    m_currBw = std::min(std::max(rembBps, m_minBw), m_maxBw);
+    m_currBwValid = true;
+    logStats(nowUs, rembBps);
+}
+
+float RembController::getBandwidth(uint64_t nowUs) const {
+    return m_currBwValid ? m_currBw : m_initBw;
+}
+
+void RembController::logStats(uint64_t nowUs, float rembBps) const {
+
+    std::ostringstream os;
+    os << std::fixed;
+    os.precision(RMCAT_LOG_PRINT_PRECISION);
+
+    os << " algo:remb " << m_id
+       << " ts: "     << (nowUs / 1000)
+       << " srate: "  << m_currBw
+       << " remb: "   << rembBps;
+    logMessage(os.str());
+}
+
+}
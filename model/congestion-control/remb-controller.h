@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * REMB controller interface for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef REMB_CONTROLLER_H
+#define REMB_CONTROLLER_H
+
+#include "sender-based-controller.h"
+
+namespace rmcat {
+
+/**
+ * Sender side of receiver-side bandwidth estimation: the receiver runs
+ * the estimator (see ns3::RmcatRembReceiver) and reports its estimate in
+ * REMB messages (draft-alvestrand-rmcat-remb), which this controller
+ * merely applies, within the configured bounds. Until the first REMB
+ * message, the bandwidth is the initial one.
+ *
+ * There is no per-packet feedback, so that the metrics computed by
+ * SenderBasedController (delay, loss, receive rate) are not available.
+ */
+class RembController: public SenderBasedController
+{
+public:
+    /** Class constructor */
+    RembController();
+
+    /** Class destructor */
+    virtual ~RembController();
+
+    /**
+     * Set the current bandwidth estimation. This can be useful in test environments
+     * to temporarily disrupt the current bandwidth estimation
+     *
+     * @param [in] newBw Bandwidth estimation to overwrite the current estimation
+     */
+    virtual void setCurrentBw(float newBw);
+
+    /**
+     * Reset the internal state of the congestion controller
+     */
+    virtual void reset();
+
+    /**
+     * Take the receiver's estimate, as carried by a REMB message
+     *
+     * @param [in] nowUs Current time
+     * @param [in] rembBps Estimate in bps
+     */
+    void processRemb(uint64_t nowUs, float rembBps);
+
+    /**
+     * REMB's realization of the getBandwidth API: the latest receiver's
+     * estimate, within bounds
+     */
+    virtual float getBandwidth(uint64_t nowUs) const;
+
+private:
+    void logStats(uint64_t nowUs, float rembBps) const;
+
+    bool m_currBwValid;
+    float m_currBw;     /**< current estimate in bps */
+};
+
+}
+
+#endif /* REMB_CONTROLLER_H */
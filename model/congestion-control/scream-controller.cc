@@ -0,0 +1,408 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * SCReAM controller implementation for rmcat ns3 module.
+ *
+ * Window-based congestion control along the lines of rfc8298:
+ *
+ * Self-Clocked Rate Adaptation for Multimedia
+ * https://tools.ietf.org/html/rfc8298
+ *
+ * Only the network congestion control and a simplified media rate
+ * control are implemented; the RTP queue is the sender application's
+ * rate shaping buffer.
+ *
+ * @version 0.1.1
+ */
+
+#include "scream-controller.h"
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+
+/* See Section 4.1.1 of rfc8298 for the default values */
+const uint64_t SCREAM_QDELAY_TARGET_US = 100 * 1000; /**< QDELAY_TARGET_LO */
+const float SCREAM_GAIN = 1.f;              /**< window gain */
+const float SCREAM_BETA_LOSS = 0.8f;        /**< window reduction upon loss */
+const float SCREAM_MSS = 1000.f;            /**< max segment size, in bytes */
+const float SCREAM_MIN_CWND = 3000.f;       /**< in bytes */
+const float SCREAM_BYTES_IN_FLIGHT_HEAD_ROOM = 2.f;
+const float SCREAM_RAMP_UP_SPEED = 200000.f; /**< max target bitrate increase, in bps per second */
+/* fast start ends when queuing delay exceeds this fraction of the target */
+const float SCREAM_FAST_START_QDELAY_FRACTION = 0.25f;
+/* target bitrate update interval when feedback is not aggregated */
+const uint64_t SCREAM_RATE_UPDATE_US = 100 * 1000;
+/* feedback timeout, in smoothed RTTs */
+const uint64_t SCREAM_FEEDBACK_TIMEOUT_SRTTS = 2;
+/* lower bound of the feedback timeout: above the longest feedback period */
+const uint64_t SCREAM_FEEDBACK_TIMEOUT_MIN_US = 500 * 1000;
+
+namespace rmcat {
+
+ScreamController::ScreamController() :
+    SenderBasedController{},
+    m_cwnd{SCREAM_MIN_CWND},
+    m_fastStart{true},
+    m_targetRate{m_initBw},
+    m_sRttUs{0},
+    m_sRttValid{false},
+    m_QdelayUs{0},
+    m_maxBytesInFlight{0},
+    m_maxBytesInFlightPrev{0},
+    m_lastAckedValid{false},
+    m_lastAckedSeq{0},
+    m_lastLossEventUs{0},
+    m_lastLossEventValid{false},
+    m_lossEvents{0},
+    m_inBatch{false},
+    m_lastFeedbackUs{0},
+    m_lastFeedbackValid{false},
+    m_feedbackTimeouts{0},
+    m_lastTimeCalcUs{0},
+    m_lastTimeCalcValid{false},
+    m_RttUs{0},
+    m_ploss{0},
+    m_plr{0.f},
+    m_RecvR{0.f},
+    m_avgInt{0.f},
+    m_currInt{0} {}
+
+ScreamController::~ScreamController() {}
+
+void ScreamController::setCurrentBw(float newBw) {
+    m_targetRate = newBw;
+}
+
+void ScreamController::reset() {
+    m_cwnd = SCREAM_MIN_CWND;
+    m_fastStart = true;
+    m_sRttUs = 0;
+    m_sRttValid = false;
+    m_QdelayUs = 0;
+    m_maxBytesInFlight = 0;
+    m_maxBytesInFlightPrev = 0;
+    m_lastAckedValid = false;
+    m_lastAckedSeq = 0;
+    m_lastLossEventUs = 0;
+    m_lastLossEventValid = false;
+    m_lossEvents = 0;
+    m_inBatch = false;
+    m_lastFeedbackUs = 0;
+    m_lastFeedbackValid = false;
+    m_feedbackTimeouts = 0;
+    m_lastTimeCalcUs = 0;
+    m_lastTimeCalcValid = false;
+    m_RttUs = 0;
+    m_ploss = 0;
+    m_plr = 0.f;
+    m_RecvR = 0.f;
+    m_avgInt = 0.f;
+    m_currInt = 0;
+    SenderBasedController::reset();
+    m_targetRate = m_initBw;
+}
+
+bool ScreamController::processSendPacket(uint64_t txTimestampUs,
+                                         uint16_t sequence,
+                                         uint32_t size) { // in Bytes
+    /* First of all, call the superclass */
+    if (!SenderBasedController::processSendPacket(txTimestampUs, sequence, size)) {
+        return false;
+    }
+
+    /* The initial bandwidth may have been set after the last reset */
+    if (!m_lastTimeCalcValid) {
+        m_targetRate = m_initBw;
+        m_lastTimeCalcUs = txTimestampUs;
+        m_lastTimeCalcValid = true;
+    }
+    m_maxBytesInFlight = std::max(m_maxBytesInFlight, getBytesInFlight());
+    return true;
+}
+
+/**
+ * Implementation of the #processFeedback API
+ * in the SenderBasedController class
+ */
+bool ScreamController::processFeedback(uint64_t nowUs,
+                                       uint16_t sequence,
+                                       uint64_t rxTimestampUs,
+                                       uint8_t ecn) {
+    /* First of all, call the superclass */
+    if (!SenderBasedController::processFeedback(nowUs,
+                                                sequence,
+                                                rxTimestampUs,
+                                                ecn)) {
+        return false;
+    }
+    m_lastFeedbackUs = nowUs;
+    m_lastFeedbackValid = true;
+
+    /* The superclass accepts (and ignores) duplicate and out of order
+     * feedback; only packets it added to the history are newly acked */
+    if (!m_packetHistory.empty() && m_packetHistory.back().sequence == sequence &&
+        (!m_lastAckedValid || lessThan(m_lastAckedSeq, sequence))) {
+        onPacketAcked(nowUs, m_packetHistory.back());
+    }
+
+    /* the target bitrate is updated at the end of the batch */
+    if (m_inBatch || !m_lastTimeCalcValid) {
+        return true;
+    }
+
+    assert(lessThan(m_lastTimeCalcUs, nowUs + 1));
+    const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
+    if (deltaUs >= SCREAM_RATE_UPDATE_US) {
+        updateTargetRate(nowUs, deltaUs);
+        logStats(nowUs, deltaUs);
+
+        m_lastTimeCalcUs = nowUs;
+    }
+    return true;
+}
+
+bool ScreamController::processFeedbackBatch(uint64_t nowUs,
+                                            const std::vector<FeedbackItem>& feedbackBatch) {
+    /* The superclass loops over #processFeedback */
+    m_inBatch = true;
+    const bool ok = SenderBasedController::processFeedbackBatch(nowUs, feedbackBatch);
+    m_inBatch = false;
+    if (!ok) {
+        return false;
+    }
+
+    if (!m_lastTimeCalcValid) {
+        return true;
+    }
+
+    assert(lessThan(m_lastTimeCalcUs, nowUs + 1));
+    const uint64_t deltaUs = nowUs - m_lastTimeCalcUs; // subtraction will wrap correctly
+    updateTargetRate(nowUs, deltaUs);
+    logStats(nowUs, deltaUs);
+
+    m_lastTimeCalcUs = nowUs;
+    return true;
+}
+
+/**
+ * Implementation of the #getBandwidth API
+ * in the SenderBasedController class
+ */
+float ScreamController::getBandwidth(uint64_t nowUs) const {
+    return m_targetRate;
+}
+
+/**
+ * Implementation of the #canSendPacket API
+ * in the SenderBasedController class. At least
+ * one packet is always allowed in flight
+ */
+bool ScreamController::canSendPacket(uint64_t nowUs, uint32_t size) {
+    checkFeedbackTimeout(nowUs);
+    const uint32_t bytesInFlight = getBytesInFlight();
+    return bytesInFlight == 0 || float(bytesInFlight + size) <= m_cwnd;
+}
+
+/**
+ * If neither feedback has been received, nor packets have been put in
+ * flight, for a while, the feedback is not coming: the window would stay
+ * full forever. Give up on the packets in flight, and restart from the
+ * minimum window, as rfc8298 does upon lack of feedback
+ */
+void ScreamController::checkFeedbackTimeout(uint64_t nowUs) {
+    if (m_inTransitPackets.empty()) {
+        return;
+    }
+
+    uint64_t timeoutUs = SCREAM_FEEDBACK_TIMEOUT_MIN_US;
+    if (m_sRttValid) {
+        timeoutUs = std::max(timeoutUs, SCREAM_FEEDBACK_TIMEOUT_SRTTS * m_sRttUs);
+    }
+
+    /* The oldest packet in flight was sent after the latest feedback
+     * if the sender was idle */
+    uint64_t refUs = m_inTransitPackets.front().txTimestampUs;
+    if (m_lastFeedbackValid && lessThan(refUs, m_lastFeedbackUs)) {
+        refUs = m_lastFeedbackUs;
+    }
+    if (lessThan(nowUs, refUs + timeoutUs)) {
+        return;
+    }
+
+    clearInTransitPackets();
+    m_cwnd = SCREAM_MIN_CWND;
+    m_fastStart = false;
+    m_maxBytesInFlight = 0;
+    m_maxBytesInFlightPrev = 0;
+    ++m_feedbackTimeouts;
+}
+
+void ScreamController::onPacketAcked(uint64_t nowUs, const PacketRecord& packet) {
+    /* smoothed RTT, as in TCP */
+    if (m_sRttValid) {
+        m_sRttUs = (7 * m_sRttUs + packet.rttUs) / 8;
+    } else {
+        m_sRttUs = packet.rttUs;
+        m_sRttValid = true;
+    }
+
+    /* A gap in the acknowledged sequences is a loss event. React
+     * at most once per RTT (see Section 4.1.2.2 of rfc8298) */
+    if (m_lastAckedValid && packet.sequence != uint16_t(m_lastAckedSeq + 1)) {
+        if (!m_lastLossEventValid || nowUs - m_lastLossEventUs >= m_sRttUs) {
+            m_cwnd = std::max(SCREAM_MIN_CWND, m_cwnd * SCREAM_BETA_LOSS);
+            m_fastStart = false;
+            m_lastLossEventUs = nowUs;
+            m_lastLossEventValid = true;
+            ++m_lossEvents;
+        }
+    }
+    m_lastAckedSeq = packet.sequence;
+    m_lastAckedValid = true;
+
+    /* Scalable (L4S-style) response to CE marks, at most once per RTT */
+    float ecnFactor = 1.f;
+    if (getEcnReduction(ecnFactor)) {
+        m_cwnd = std::max(SCREAM_MIN_CWND, m_cwnd * ecnFactor);
+        m_fastStart = false;
+    }
+
+    updateCwnd(nowUs, packet.size);
+}
+
+/**
+ * Window update upon acknowledgement of new bytes,
+ * see Section 4.1.2.2 of rfc8298:
+ *
+ *                QDELAY_TARGET - qdelay
+ * off_target = -----------------------
+ *                    QDELAY_TARGET
+ *
+ * cwnd += GAIN * off_target * bytes_newly_acked * MSS / cwnd
+ */
+void ScreamController::updateCwnd(uint64_t nowUs, uint32_t bytesAcked) {
+    uint64_t qdelayUs = 0;
+    if (getCurrentQdelay(qdelayUs)) m_QdelayUs = qdelayUs;
+
+    const float qdelay = float(m_QdelayUs);
+    const float target = float(SCREAM_QDELAY_TARGET_US);
+
+    if (m_fastStart && qdelay > SCREAM_FAST_START_QDELAY_FRACTION * target) {
+        m_fastStart = false;
+    }
+
+    if (m_fastStart) {
+        /* slow start-like increase */
+        m_cwnd += float(bytesAcked);
+    } else {
+        const float offTarget = (target - qdelay) / target;
+        m_cwnd += SCREAM_GAIN * offTarget * float(bytesAcked) * SCREAM_MSS / m_cwnd;
+    }
+
+    /* Don't let the window grow far beyond what is actually used */
+    const uint32_t maxBytesInFlight = std::max(m_maxBytesInFlight, m_maxBytesInFlightPrev);
+    if (maxBytesInFlight > 0) {
+        m_cwnd = std::min(m_cwnd, SCREAM_BYTES_IN_FLIGHT_HEAD_ROOM * float(maxBytesInFlight));
+    }
+    m_cwnd = std::max(m_cwnd, SCREAM_MIN_CWND);
+}
+
+/**
+ * Simplified media rate control: the target bitrate follows the rate
+ * allowed by the window over the smoothed RTT, immediately when that
+ * rate is lower, and at a bounded speed when it is higher. Under
+ * congestion, it is also bounded by the receive rate
+ */
+void ScreamController::updateTargetRate(uint64_t nowUs, uint64_t deltaUs) {
+    uint64_t rttUs = 0;
+    if (getCurrentRTT(rttUs)) m_RttUs = rttUs;
+
+    float rrate = 0.f;
+    if (getCurrentRecvRate(rrate)) m_RecvR = rrate;
+
+    float plr = 0.f;
+    uint32_t nLoss = 0;
+    if (getPktLossInfo(nLoss, plr)) {
+        m_ploss = nLoss;
+        m_plr = plr;
+    }
+
+    float avgInt;
+    uint16_t currentInt;
+    if (getLossIntervalInfo(avgInt, currentInt)) {
+        m_avgInt = avgInt;
+        m_currInt = currentInt;
+    }
+
+    if (m_sRttValid && m_sRttUs > 0) {
+        const float cwndRate = m_cwnd * 8.f * 1e6f / float(m_sRttUs);
+        if (cwndRate < m_targetRate) {
+            m_targetRate = cwndRate;
+        } else {
+            const float rampUp = SCREAM_RAMP_UP_SPEED * float(deltaUs) / 1e6f;
+            m_targetRate = std::min(cwndRate, m_targetRate + rampUp);
+        }
+    }
+
+    /* Past half the queuing delay target, the network is the bottleneck:
+     * don't produce media faster than it gets delivered, or it will pile
+     * up in the sender's queue, held back by the window */
+    if (m_QdelayUs > SCREAM_QDELAY_TARGET_US / 2 && m_RecvR > 0.f) {
+        m_targetRate = std::min(m_targetRate, m_RecvR);
+    }
+
+    /* clip final rate within range */
+    m_targetRate = std::min(m_targetRate, m_maxBw);
+    m_targetRate = std::max(m_targetRate, m_minBw);
+
+    m_maxBytesInFlightPrev = m_maxBytesInFlight;
+    m_maxBytesInFlight = getBytesInFlight();
+}
+
+void ScreamController::logStats(uint64_t nowUs, uint64_t deltaUs) const {
+
+    std::ostringstream os;
+    os << std::fixed;
+    os.precision(RMCAT_LOG_PRINT_PRECISION);
+
+    /* log packet stats: the common ones, with the queuing delay that
+     * drives the window as xcurr, then SCReAM-specific ones */
+    os << " algo:scream " << m_id
+       << " ts: "     << (nowUs / 1000)
+       << " loglen: " << m_packetHistory.size()
+       << " qdel: "   << (m_QdelayUs / 1000)
+       << " rtt: "    << (m_RttUs / 1000)
+       << " ploss: "  << m_ploss
+       << " plr: "    << m_plr
+       << " xcurr: "  << (float(m_QdelayUs) / 1000.f)
+       << " rrate: "  << m_RecvR
+       << " srate: "  << m_targetRate
+       << " avgint: " << m_avgInt
+       << " curint: " << m_currInt
+       << " delta: "  << (deltaUs / 1000)
+       << " cwnd: "   << m_cwnd
+       << " inflight: " << getBytesInFlight()
+       << " srtt: "   << (m_sRttUs / 1000)
+       << " faststart: " << m_fastStart
+       << " lossev: " << m_lossEvents
+       << " fbtimeouts: " << m_feedbackTimeouts;
+    logMessage(os.str());
+}
+
+}
@@ -0,0 +1,147 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * SCReAM controller interface for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef SCREAM_CONTROLLER_H
+#define SCREAM_CONTROLLER_H
+
+#include "sender-based-controller.h"
+
+namespace rmcat {
+
+/**
+ * Self-clocked, window-based congestion controller along the lines of
+ * Self-Clocked Rate Adaptation for Multimedia (SCReAM, rfc8298):
+ *
+ *  - A congestion window, in bytes, grows while the queuing delay is below
+ *    a target, and shrinks in proportion to how far above the target it
+ *    is. It is cut multiplicatively upon packet loss.
+ *  - Packets are only sent while the bytes in flight fit in the window
+ *    (see #canSendPacket), so the sender is clocked by the feedback. If
+ *    no feedback arrives for about two smoothed RTTs, the packets in
+ *    flight are deemed lost and the window falls back to its minimum.
+ *  - The media target bitrate follows the rate the window allows over the
+ *    smoothed RTT, with a bounded ramp-up speed.
+ */
+class ScreamController: public SenderBasedController
+{
+public:
+    /** Class constructor */
+    ScreamController();
+
+    /** Class destructor */
+    virtual ~ScreamController();
+
+    /**
+     * Set the current bandwidth estimation. This can be useful in test environments
+     * to temporarily disrupt the current bandwidth estimation
+     *
+     * @param [in] newBw Bandwidth estimation to overwrite the current estimation
+     */
+    virtual void setCurrentBw(float newBw);
+
+    /**
+     * Reset the internal state of the congestion controller
+     */
+    virtual void reset();
+
+    /**
+     * SCReAM's realization of the processSendPacket API: keeps track of
+     * the maximum bytes in flight, which bounds the window
+     */
+    virtual bool processSendPacket(uint64_t txTimestampUs,
+                                   uint16_t sequence,
+                                   uint32_t size); // in Bytes
+
+    /**
+     * SCReAM's realization of the processFeedback API: updates the window
+     * for every newly acknowledged packet, and the target bitrate at
+     * regular intervals
+     */
+    virtual bool processFeedback(uint64_t nowUs,
+                                 uint16_t sequence,
+                                 uint64_t rxTimestampUs,
+                                 uint8_t ecn=0);
+
+    /**
+     * SCReAM's realization of the processFeedbackBatch API: updates the
+     * window for every newly acknowledged packet, and the target bitrate
+     * once per batch
+     */
+    virtual bool processFeedbackBatch(uint64_t nowUs,
+                                      const std::vector<FeedbackItem>& feedbackBatch);
+
+    /**
+     * SCReAM's realization of the getBandwidth API: returns the media
+     * target bitrate
+     */
+    virtual float getBandwidth(uint64_t nowUs) const;
+
+    /**
+     * SCReAM's realization of the canSendPacket API: the packet can be
+     * sent if it fits in the congestion window. If feedback is overdue,
+     * the packets in flight are given up on and the window is reset to
+     * its minimum first
+     */
+    virtual bool canSendPacket(uint64_t nowUs, uint32_t size);
+
+private:
+    void checkFeedbackTimeout(uint64_t nowUs);
+    void onPacketAcked(uint64_t nowUs, const PacketRecord& packet);
+    void updateCwnd(uint64_t nowUs, uint32_t bytesAcked);
+    void updateTargetRate(uint64_t nowUs, uint64_t deltaUs);
+    void logStats(uint64_t nowUs, uint64_t deltaUs) const;
+
+    float m_cwnd;               /**< congestion window in bytes */
+    bool m_fastStart;           /**< still in the initial fast increase phase */
+    float m_targetRate;         /**< media target bitrate in bps */
+    uint64_t m_sRttUs;          /**< smoothed round trip time */
+    bool m_sRttValid;
+    uint64_t m_QdelayUs;        /**< estimated queuing delay in microseconds */
+    uint32_t m_maxBytesInFlight;     /**< since the last target bitrate update */
+    uint32_t m_maxBytesInFlightPrev; /**< before the last target bitrate update */
+
+    bool m_lastAckedValid;
+    uint16_t m_lastAckedSeq;    /**< latest sequence acknowledged */
+    uint64_t m_lastLossEventUs;
+    bool m_lastLossEventValid;
+    uint32_t m_lossEvents;      /**< loss events reacted upon */
+    bool m_inBatch;             /**< processing a feedback batch */
+    uint64_t m_lastFeedbackUs;  /**< latest time feedback was received */
+    bool m_lastFeedbackValid;
+    uint32_t m_feedbackTimeouts; /**< times in-flight packets were given up on */
+
+    uint64_t m_lastTimeCalcUs;
+    bool m_lastTimeCalcValid;
+
+    uint64_t m_RttUs;           /**< estimated RTT in microseconds */
+    uint32_t m_ploss;           /**< packet loss count within packet history */
+    float m_plr;                /**< packet loss ratio within packet history */
+    float m_RecvR;              /**< updated receiving rate in bps */
+    float m_avgInt;             /**< average inter-loss interval in packets */
+    uint16_t m_currInt;         /**< most recent inter-loss interval in packets */
+};
+
+}
+
+#endif /* SCREAM_CONTROLLER_H */
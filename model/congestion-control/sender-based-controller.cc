@@ -40,6 +40,7 @@ const uint64_t DEFAULT_HISTORY_LENGTH_US = 500 * 1000; /**< default time window
 const float RMCAT_CC_DEFAULT_RINIT = 150000.; /**< Initial BW in bps: 150Kbps */
 const float RMCAT_CC_DEFAULT_RMIN = 150000.;  /**< in bps: 150Kbps */
 const float RMCAT_CC_DEFAULT_RMAX = 1500000.; /**< in bps: 1.5Mbps */
+const float ECN_ALPHA_GAIN = 1.f / 16.f;      /**< g in rfc8257 */
 
 InterLossState::InterLossState()
 : intervals{}
@@ -49,6 +50,54 @@ InterLossState::InterLossState()
     intervals.push_front(0);
 }
 
+ScalableEcnResponse::ScalableEcnResponse()
+: m_alpha{0.f}
+, m_lastFraction{0.f}
+, m_acked{0}
+, m_marked{0}
+, m_windowStartUs{0}
+, m_windowStartValid{false}
+{}
+
+void ScalableEcnResponse::reset() {
+    *this = ScalableEcnResponse{};
+}
+
+bool ScalableEcnResponse::update(uint64_t nowUs, uint8_t ecn, uint64_t windowUs) {
+    if (!m_windowStartValid) {
+        m_windowStartUs = nowUs;
+        m_windowStartValid = true;
+    }
+    ++m_acked;
+    if (ecn == RMCAT_ECN_CE) {
+        ++m_marked;
+    }
+    if (nowUs - m_windowStartUs < windowUs) {
+        return false;
+    }
+
+    // Close the observation window
+    m_lastFraction = float(m_marked) / float(m_acked);
+    m_alpha = (1.f - ECN_ALPHA_GAIN) * m_alpha + ECN_ALPHA_GAIN * m_lastFraction;
+    const bool marked = m_marked > 0;
+    m_acked = 0;
+    m_marked = 0;
+    m_windowStartUs = nowUs;
+    return marked;
+}
+
+float ScalableEcnResponse::getAlpha() const {
+    return m_alpha;
+}
+
+float ScalableEcnResponse::getMarkedFraction() const {
+    return m_lastFraction;
+}
+
+float ScalableEcnResponse::getReductionFactor() const {
+    return 1.f - m_alpha / 2.f;
+}
+
 void SenderBasedController::setDefaultId() {
     // By default, the id is the object's address
     std::stringstream ss;
@@ -61,6 +110,7 @@ SenderBasedController::SenderBasedController()
   m_lastSequence{0},
   m_baseDelayUs{0},
   m_inTransitPackets{},
+  m_inTransitBytes{0},
   m_packetHistory{},
   m_pktSizeSum{0},
   m_id{},
@@ -69,7 +119,15 @@ SenderBasedController::SenderBasedController()
   m_maxBw{RMCAT_CC_DEFAULT_RMAX},
   m_logCallback{NULL},
   m_ilState{},
-  m_historyLengthUs{DEFAULT_HISTORY_LENGTH_US} {
+  m_ecnResponse{},
+  m_ecnReductionDue{false},
+  m_historyLengthUs{DEFAULT_HISTORY_LENGTH_US},
+  m_numAcked{0},
+  m_numAckedReported{0},
+  m_probeEstimator{},
+  m_lastProbeClusterId{0},
+  m_probeResultDue{false},
+  m_probeResultBps{0.f} {
       setDefaultId();
 }
 
@@ -100,6 +158,7 @@ void SenderBasedController::reset() {
     m_lastSequence = 0;
     m_baseDelayUs = 0;
     m_inTransitPackets.clear();
+    m_inTransitBytes = 0;
     m_packetHistory.clear();
     m_pktSizeSum = 0;
     m_initBw = RMCAT_CC_DEFAULT_RINIT;
@@ -107,7 +166,15 @@ void SenderBasedController::reset() {
     m_maxBw = RMCAT_CC_DEFAULT_RMAX;
     m_logCallback = NULL;
     m_ilState = InterLossState{};
+    m_ecnResponse.reset();
+    m_ecnReductionDue = false;
     m_historyLengthUs = DEFAULT_HISTORY_LENGTH_US;
+    m_numAcked = 0;
+    m_numAckedReported = 0;
+    m_probeEstimator.reset();
+    m_lastProbeClusterId = 0;
+    m_probeResultDue = false;
+    m_probeResultBps = 0.f;
     setDefaultId();
 }
 
@@ -158,14 +225,17 @@ bool SenderBasedController::processSendPacket(uint64_t txTimestampUs,
                                               txTimestampUs,
                                               size,
                                               0,
+                                              0,
+                                              RMCAT_ECN_NOT_ECT,
                                               0});
+    m_inTransitBytes += size;
     // Memory safety: timestamps of in-transit packets must be
     //  within (10 * MAX_INTER_PACKET_TIME)
     while (true) {
         const uint64_t firstTimestampUs = m_inTransitPackets.front().txTimestampUs;
         if (lessThan(firstTimestampUs + 10 * MAX_INTER_PACKET_TIME_US,
                      txTimestampUs)) {
-            m_inTransitPackets.pop_front();
+            popInTransitPacket();
         } else {
             break;
         }
@@ -197,7 +267,7 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
 
     while (lessThan(m_inTransitPackets.front().sequence, sequence)) {
         // Packet lost or out of order. Remove stale entry
-        m_inTransitPackets.pop_front();
+        popInTransitPacket();
         // Note: we can't tell whether the media (forward path) packet
         //     or the feedback (backward path) packet was lost.
         // Assuming media packet was lost for the time being
@@ -211,7 +281,7 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
     }
 
     PacketRecord packet = m_inTransitPackets.front();
-    m_inTransitPackets.pop_front();
+    popInTransitPacket();
     assert(sequence == packet.sequence);
 
     if (!m_packetHistory.empty()) {
@@ -241,6 +311,21 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
     // This subtraction can wrap if clocks aren't synchronized, but it's OK
     packet.owdUs = rxTimestampUs - packet.txTimestampUs;
     packet.rttUs = nowUs - packet.txTimestampUs;
+    packet.ecn = ecn;
+
+    if (packet.probeClusterId != 0) {
+        float deliveryBps = 0.f;
+        if (m_probeEstimator.update(packet.probeClusterId, packet.txTimestampUs,
+                                    rxTimestampUs, packet.size, nowUs, deliveryBps)) {
+            m_probeResultBps = deliveryBps;
+            m_probeResultDue = true;
+        }
+    }
+
+    // One observation window of CE marks per RTT
+    if (m_ecnResponse.update(nowUs, ecn, packet.rttUs)) {
+        m_ecnReductionDue = true;
+    }
 
     if (m_packetHistory.empty() || lessThan(packet.owdUs, m_baseDelayUs)) {
         m_baseDelayUs = packet.owdUs;
@@ -250,6 +335,7 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
 
     m_packetHistory.push_back(packet);
     m_pktSizeSum += packet.size;
+    ++m_numAcked;
 
     // Garbage collect history to keep its length within limits
     while (true) {
@@ -278,6 +364,79 @@ bool SenderBasedController::processFeedbackBatch(uint64_t nowUs,
     return true;
 }
 
+bool SenderBasedController::getEcnReduction(float& factor) {
+    if (!m_ecnReductionDue) {
+        return false;
+    }
+    m_ecnReductionDue = false;
+    factor = m_ecnResponse.getReductionFactor();
+    return true;
+}
+
+float SenderBasedController::getEcnMarkedFraction() const {
+    return m_ecnResponse.getAlpha();
+}
+
+bool SenderBasedController::canSendPacket(uint64_t nowUs, uint32_t size) {
+    return true;
+}
+
+bool SenderBasedController::getProbeRequest(uint64_t nowUs, ProbeCluster& cluster) {
+    return false;
+}
+
+bool SenderBasedController::markProbePacket(uint16_t sequence, uint32_t clusterId) {
+    if (m_inTransitPackets.empty() || m_inTransitPackets.back().sequence != sequence) {
+        std::cerr << "SenderBasedController::markProbePacket,"
+                  << " sequence: " << sequence
+                  << " is not the last packet sent" << std::endl;
+        return false;
+    }
+    m_inTransitPackets.back().probeClusterId = clusterId;
+    return true;
+}
+
+void SenderBasedController::newProbeCluster(uint64_t nowUs, float rateBps, uint32_t minPackets,
+                                            uint64_t minDurationUs, ProbeCluster& cluster) {
+    ++m_lastProbeClusterId;
+    if (m_lastProbeClusterId == 0) {
+        ++m_lastProbeClusterId; // 0 means no cluster
+    }
+    cluster.id = m_lastProbeClusterId;
+    cluster.rateBps = rateBps;
+    cluster.minPackets = minPackets;
+    cluster.minBytes = uint32_t(rateBps / 8.f * float(minDurationUs) / 1e6f);
+    m_probeEstimator.addCluster(cluster, nowUs);
+}
+
+bool SenderBasedController::getProbeResult(float& deliveryBps) {
+    if (!m_probeResultDue) {
+        return false;
+    }
+    m_probeResultDue = false;
+    deliveryBps = m_probeResultBps;
+    return true;
+}
+
+uint32_t SenderBasedController::getBytesInFlight() const {
+    return m_inTransitBytes;
+}
+
+void SenderBasedController::getNewAckedPackets(std::vector<PacketRecord>& packets) {
+    packets.clear();
+    const uint64_t numNew = std::min<uint64_t>(m_numAcked - m_numAckedReported,
+                                               m_packetHistory.size());
+    packets.assign(m_packetHistory.end() - numNew, m_packetHistory.end());
+    m_numAckedReported = m_numAcked;
+}
+
+void SenderBasedController::popInTransitPacket() {
+    const uint32_t size = m_inTransitPackets.front().size;
+    assert(m_inTransitBytes >= size);
+    m_inTransitBytes -= size;
+    m_inTransitPackets.pop_front();
+}
+
 void SenderBasedController::setHistoryLength(uint64_t lenUs) {
     m_historyLengthUs = lenUs;
 }
@@ -286,6 +445,11 @@ uint64_t SenderBasedController::getHistoryLength() const {
     return m_historyLengthUs;
 }
 
+void SenderBasedController::clearInTransitPackets() {
+    m_inTransitPackets.clear();
+    m_inTransitBytes = 0;
+}
+
 // These functions calculate different metrics based on the feedback received.
 // Although they could be considered part of the NADA algorithm, we have
 // defined them in the superclass because they could also be useful to other
@@ -29,6 +29,7 @@
 #ifndef SENDER_BASED_CONTROLLER_H
 #define SENDER_BASED_CONTROLLER_H
 
+#include "probe-bitrate-estimator.h"
 #include <cstdint>
 #include <string>
 #include <deque>
@@ -41,6 +42,12 @@ namespace rmcat {
 
 const uint32_t RMCAT_LOG_PRINT_PRECISION = 2;  /* default precision for logs */
 
+/* ECN codepoints, as in the two low-order bits of the IP TOS byte (rfc3168) */
+const uint8_t RMCAT_ECN_NOT_ECT = 0x00;
+const uint8_t RMCAT_ECN_ECT1 = 0x01;    /* used by L4S senders (rfc9331) */
+const uint8_t RMCAT_ECN_ECT0 = 0x02;
+const uint8_t RMCAT_ECN_CE = 0x03;
+
 /**
  * This class keeps track of the length of intervals between two packet
  * loss events, in the way TCP-friendly Rate Control (TFRC) calculates it
@@ -53,6 +60,50 @@ public:
     bool initialized; // did the first loss happen?
 };
 
+/**
+ * This class keeps track of the fraction of CE-marked packets, in the way
+ * DCTCP (rfc8257) and other L4S scalable congestion controls do: once per
+ * observation window (typically one RTT), the marked fraction F is folded
+ * into a moving average alpha = (1 - g) alpha + g F. If any packet was
+ * marked during the window, the controller should reduce its rate (or
+ * window) by a factor (1 - alpha / 2)
+ */
+class ScalableEcnResponse {
+public:
+    ScalableEcnResponse();
+
+    /** Back to initial state, as in a newly created object */
+    void reset();
+
+    /**
+     * Account for the ECN codepoint of a newly acknowledged packet
+     *
+     * @param [in] nowUs Current time, in microseconds
+     * @param [in] ecn ECN codepoint seen by the receiver
+     * @param [in] windowUs Length of the observation window, in microseconds
+     * @retval true if this closed an observation window containing CE marks,
+     *         i.e., a reduction is due. False otherwise
+     */
+    bool update(uint64_t nowUs, uint8_t ecn, uint64_t windowUs);
+
+    /** Moving average of the marked fraction */
+    float getAlpha() const;
+
+    /** Marked fraction in the last closed observation window */
+    float getMarkedFraction() const;
+
+    /** Multiplicative reduction factor to apply: 1 - alpha / 2 */
+    float getReductionFactor() const;
+
+private:
+    float m_alpha;
+    float m_lastFraction;
+    uint32_t m_acked;   /**< packets acknowledged in the current window */
+    uint32_t m_marked;  /**< of which CE-marked */
+    uint64_t m_windowStartUs;
+    bool m_windowStartValid;
+};
+
 /**
  * This is the base class to all congestion controllers. Any congestion
  * controller that is to use this NS3 component has to inherit from this
@@ -117,6 +168,8 @@ public:
         uint32_t size;
         uint64_t owdUs;
         uint64_t rttUs;
+        uint8_t ecn;
+        uint32_t probeClusterId; /**< 0 if not sent as part of a probe cluster */
     };
 
     /** Class constructor */
@@ -266,6 +319,93 @@ public:
      */
     virtual float getBandwidth(uint64_t nowUs) const =0;
 
+    /**
+     * The sender application calls this function before sending a media
+     * packet. Window-based congestion controllers can return false to hold
+     * the packet back until feedback acknowledges enough bytes in flight.
+     * The sender application keeps the packet in its rate shaping buffer
+     * and tries again later, or upon reception of feedback
+     *
+     * The base implementation always returns true, so rate-based controllers
+     * need not implement it. Window-based controllers may update their state
+     * here, e.g., give up on packets whose feedback is overdue, as they would
+     * otherwise hold packets back forever if all feedback is lost
+     *
+     * @param [in] nowUs The time at which this function is called, in microseconds
+     * @param [in] size Size of the packet to be sent, in bytes
+     * @retval true if the packet can be sent now, false otherwise
+     */
+    virtual bool canSendPacket(uint64_t nowUs, uint32_t size);
+
+    /**
+     * Get the number of bytes sent for which no feedback has been received
+     * yet. Packets deemed lost are not counted
+     *
+     * @retval The size, in bytes, of all packets in flight
+     */
+    uint32_t getBytesInFlight() const;
+
+    /**
+     * Get the records of the packets acknowledged since the last call to
+     * this function, in the order they were acknowledged, e.g., to feed
+     * their one-way delays to a shared bottleneck detector. Packets lost
+     * in between show up as sequence gaps. Packets already garbage
+     * collected from the history are not returned
+     *
+     * @param [out] packets The newly acknowledged packets
+     */
+    void getNewAckedPackets(std::vector<PacketRecord>& packets);
+
+    /**
+     * Calculate current round trip time (rtt)
+     *
+     * @param [out] rttUs Round trip time in microseconds during current history length
+     * @retval False if the current history is empty (output parameter is not
+     *         valid). True otherwise
+     */
+    bool getCurrentRTT(uint64_t& rttUs) const;
+
+    /**
+     * Calculate current info on packet losses
+     *
+     * @param [out] nLoss Number of packets lost during current history length
+     * @param [out] plr Loss ratio (losses per packet) for the current history
+     *                  length
+     * @retval False if the current history does not contain enough packets to
+     *         calculate the metrics (output parameter is not valid). True
+     *         otherwise
+     */
+    bool getPktLossInfo(uint32_t& nLoss, float& plr) const;
+
+    /**
+     * The sender application calls this function to know whether the
+     * congestion controller wants it to probe for more bandwidth, i.e.,
+     * send a burst of extra packets (a probe cluster) faster than the
+     * media. Once a cluster is complete, the sender application calls
+     * this function again for the next one, if any
+     *
+     * The base implementation never asks for probing
+     *
+     * @param [in] nowUs The time at which this function is called, in microseconds
+     * @param [out] cluster The probe cluster to send
+     * @retval true if a cluster is to be sent (output parameter is valid).
+     *         False otherwise
+     */
+    virtual bool getProbeRequest(uint64_t nowUs, ProbeCluster& cluster);
+
+    /**
+     * The sender application calls this function right after
+     * #processSendPacket for every packet sent as part of a probe
+     * cluster, so that the delivery rate of the cluster can be measured
+     * upon feedback (see #getProbeResult)
+     *
+     * @param [in] sequence The sequence number of the packet just sent
+     * @param [in] clusterId The id of the cluster the packet belongs to
+     * @retval true if all went well, false if the packet is not the last
+     *         one sent
+     */
+    bool markProbePacket(uint16_t sequence, uint32_t clusterId);
+
 protected:
     /** A "less than" operator for unsigned integers that supports wrapping */
     template <typename UINT>
@@ -293,6 +433,12 @@ protected:
      */
     uint64_t getHistoryLength() const;
 
+    /**
+     * Give up on all packets in flight, as if they were lost: they no longer
+     * count as bytes in flight, and late feedback on them is ignored
+     */
+    void clearInTransitPackets();
+
     /**
      * Function used to log messages. It calls the message logging callback
      * if has been set, otherwise it logs to stdout
@@ -316,27 +462,6 @@ protected:
      */
     bool getCurrentQdelay(uint64_t& qdelayUs) const;
 
-    /**
-     * Calculate current round trip time (rtt)
-     *
-     * @param [out] rttUs Round trip time in microseconds during current history length
-     * @retval False if the current history is empty (output parameter is not
-     *         valid). True otherwise
-     */
-    bool getCurrentRTT(uint64_t& rttUs) const;
-
-    /**
-     * Calculate current info on packet losses
-     *
-     * @param [out] nLoss Number of packets lost during current history length
-     * @param [out] plr Loss ratio (losses per packet) for the current history
-     *                  length
-     * @retval False if the current history does not contain enough packets to
-     *         calculate the metrics (output parameter is not valid). True
-     *         otherwise
-     */
-    bool getPktLossInfo(uint32_t& nLoss, float& plr) const;
-
     /**
      * Calculate current rate at which the receiver is receiving the media
      * packets (receive rate), in bits per second
@@ -364,6 +489,50 @@ protected:
      */
     bool getLossIntervalInfo(float& avgInterval, uint16_t& currentInterval) const;
 
+    /**
+     * Get the multiplicative reduction that the CE marks received
+     * call for, as per #ScalableEcnResponse . A reduction is due at
+     * most once per RTT, and is returned once: the next call will return
+     * false until more marks are received
+     *
+     * @param [out] factor Factor (between 0.5 and 1) by which to multiply
+     *                     the rate or window
+     * @retval True if a reduction is due (output parameter is valid).
+     *         False otherwise
+     */
+    bool getEcnReduction(float& factor);
+
+    /**
+     * Get the current moving average of the fraction of CE-marked packets
+     *
+     * @retval The average CE-marked fraction, between 0 and 1
+     */
+    float getEcnMarkedFraction() const;
+
+    /**
+     * Hand out a new probe cluster, and start measuring its delivery
+     * rate. Meant for implementations of #getProbeRequest
+     *
+     * @param [in] nowUs Current time, in microseconds
+     * @param [in] rateBps Rate at which to send the cluster
+     * @param [in] minPackets Packets the cluster is to contain at least
+     * @param [in] minDurationUs Time the cluster is to last at least
+     * @param [out] cluster The new cluster
+     */
+    void newProbeCluster(uint64_t nowUs, float rateBps, uint32_t minPackets,
+                         uint64_t minDurationUs, ProbeCluster& cluster);
+
+    /**
+     * Get the delivery rate of the latest probe cluster, as per
+     * #ProbeBitrateEstimator . A new estimate is returned once: the next
+     * call will return false until more probe packets are acknowledged
+     *
+     * @param [out] deliveryBps Delivery rate of the cluster, in bps
+     * @retval True if a new estimate is available (output parameter is
+     *         valid). False otherwise
+     */
+    bool getProbeResult(float& deliveryBps);
+
     bool m_firstSend; /**< true if at least one packet has been sent */
     uint16_t m_lastSequence; /**< sequence of the last packet sent */
     /**
@@ -375,6 +544,11 @@ protected:
      * Sent packets for which feedback has not been received yet
      */
     std::deque<PacketRecord> m_inTransitPackets;
+    /**
+     * Maintains the sum of the size of all packets in #m_inTransitPackets .
+     * This is done for efficiency reasons
+     */
+    uint32_t m_inTransitBytes;
     /**
      * Packets for which feedback has already been received. Information
      * contained in these records will be used to calculate the different
@@ -397,11 +571,22 @@ protected:
 
     InterLossState m_ilState;
 
+    ScalableEcnResponse m_ecnResponse;
+    bool m_ecnReductionDue; /**< a reduction is due and not yet taken */
+
 private:
     uint64_t m_historyLengthUs; // in microseconds
+    uint64_t m_numAcked;        // packets ever added to m_packetHistory
+    uint64_t m_numAckedReported; // as of the last call to getNewAckedPackets
+
+    ProbeBitrateEstimator m_probeEstimator;
+    uint32_t m_lastProbeClusterId;
+    bool m_probeResultDue;      // a probe estimate is not yet returned
+    float m_probeResultBps;
 
     void setDefaultId();
     void updateInterLossData(uint16_t sequence);
+    void popInTransitPacket();
 };
 
 }
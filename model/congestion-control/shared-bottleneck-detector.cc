@@ -0,0 +1,278 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Shared bottleneck detection implementation for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#include "shared-bottleneck-detector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace rmcat {
+
+/* Parameters from Section 4 of rfc8382 */
+const uint64_t SBD_INTERVAL_US = 350 * 1000; /**< T: base time interval */
+const size_t SBD_NUM_INTERVALS = 50;         /**< N: intervals summarized */
+const float SBD_C_S = 0.1f;   /**< skewness threshold to deem a flow bottlenecked */
+const float SBD_C_H = 0.3f;   /**< hysteresis: skewness threshold to stay bottlenecked */
+const float SBD_P_L = 0.1f;   /**< loss threshold to deem a flow bottlenecked */
+const float SBD_P_F = 0.1f;   /**< grouping threshold on oscillation frequency */
+const float SBD_P_MAD = 0.1f; /**< grouping threshold on variability (relative) */
+const float SBD_P_S = 0.1f;   /**< grouping threshold on skewness */
+const float SBD_P_D = 0.1f;   /**< grouping threshold on loss (relative) */
+const float SBD_P_V = 0.7f;   /**< significant mean crossing, relative to variability */
+/* Not in rfc8382: a flow is not grouped before having some history, nor
+ * if its OWD barely varies (an idle bottleneck has a skewness of 0) */
+const uint32_t SBD_MIN_INTERVALS = 10;
+const float SBD_MIN_VAR_MS = 0.5f;
+
+SharedBottleneckDetector::SharedBottleneckDetector() :
+    m_flows{},
+    m_intervalStartUs{0},
+    m_intervalStartValid{false} {}
+
+void SharedBottleneckDetector::registerFlow(uint32_t flowId) {
+    FlowState flow{};
+    flow.group = flowId;
+    m_flows[flowId] = flow;
+}
+
+void SharedBottleneckDetector::deregisterFlow(uint32_t flowId) {
+    m_flows.erase(flowId);
+}
+
+void SharedBottleneckDetector::addSample(uint32_t flowId, uint16_t sequence, uint64_t owdUs) {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end()) {
+        return;
+    }
+    auto& flow = it->second;
+    auto& cur = flow.current;
+
+    if (!flow.seqValid) {
+        flow.seqValid = true;
+        flow.baseOwdUs = owdUs;
+    } else {
+        const uint16_t gap = sequence - flow.nextSeq;
+        if (gap >= 0x8000) {
+            return; // reordered, already accounted as lost
+        }
+        cur.numLost += gap;
+    }
+    flow.nextSeq = sequence + 1;
+
+    // Signed difference, so that non-synchronized clocks are fine
+    const double owdMs = double(int64_t(owdUs - flow.baseOwdUs)) / 1000.;
+    double meanMs = owdMs;
+    if (flow.sumSamples > 0) {
+        meanMs = flow.sumOwdMs / flow.sumSamples;
+    } else if (cur.numSamples > 0) {
+        meanMs = cur.sumOwdMs / cur.numSamples;
+    }
+    if (owdMs < meanMs) {
+        ++cur.skewBase;
+    } else if (owdMs > meanMs) {
+        --cur.skewBase;
+    }
+    cur.varBaseMs += std::fabs(owdMs - meanMs);
+    cur.sumOwdMs += owdMs;
+    ++cur.numSamples;
+}
+
+void SharedBottleneckDetector::closeInterval(FlowState& flow) {
+    auto cur = flow.current;
+    flow.current = IntervalSummary{};
+
+    flow.sumSamples += cur.numSamples;
+    flow.sumLost += cur.numLost;
+    flow.sumOwdMs += cur.sumOwdMs;
+    flow.sumSkewBase += cur.skewBase;
+    flow.sumVarBaseMs += cur.varBaseMs;
+
+    // Significant crossing of the long-term mean by this interval's mean
+    cur.crossing = false;
+    if (cur.numSamples > 0 && flow.sumSamples > 0) {
+        const double meanMs = flow.sumOwdMs / flow.sumSamples;
+        const double varMs = flow.sumVarBaseMs / flow.sumSamples;
+        const double intervalMeanMs = cur.sumOwdMs / cur.numSamples;
+        int8_t side = 0;
+        if (intervalMeanMs > meanMs + SBD_P_V * varMs) {
+            side = 1;
+        } else if (intervalMeanMs < meanMs - SBD_P_V * varMs) {
+            side = -1;
+        }
+        if (side != 0) {
+            cur.crossing = (flow.lastSide != 0 && side != flow.lastSide);
+            flow.lastSide = side;
+        }
+    }
+    flow.sumCrossings += cur.crossing ? 1 : 0;
+    flow.intervals.push_back(cur);
+
+    if (flow.intervals.size() > SBD_NUM_INTERVALS) {
+        const auto& old = flow.intervals.front();
+        flow.sumSamples -= old.numSamples;
+        flow.sumLost -= old.numLost;
+        flow.sumOwdMs -= old.sumOwdMs;
+        flow.sumSkewBase -= old.skewBase;
+        flow.sumVarBaseMs -= old.varBaseMs;
+        flow.sumCrossings -= old.crossing ? 1 : 0;
+        flow.intervals.pop_front();
+    }
+
+    auto& stats = flow.stats;
+    stats.numIntervals = flow.intervals.size();
+    stats.skewEst = (flow.sumSamples > 0) ? float(flow.sumSkewBase) / flow.sumSamples : 0.f;
+    stats.varEst = (flow.sumSamples > 0) ? float(flow.sumVarBaseMs / flow.sumSamples) : 0.f;
+    stats.freqEst = float(flow.sumCrossings) / stats.numIntervals;
+    const uint64_t sent = flow.sumSamples + flow.sumLost;
+    stats.pktLoss = (sent > 0) ? float(flow.sumLost) / sent : 0.f;
+}
+
+bool SharedBottleneckDetector::update(uint64_t nowUs) {
+    if (!m_intervalStartValid) {
+        m_intervalStartValid = true;
+        m_intervalStartUs = nowUs;
+        return false;
+    }
+    if (nowUs - m_intervalStartUs < SBD_INTERVAL_US) {
+        return false;
+    }
+    m_intervalStartUs += SBD_INTERVAL_US;
+    if (nowUs - m_intervalStartUs >= SBD_INTERVAL_US) {
+        m_intervalStartUs = nowUs; // no updates for a while: resynchronize
+    }
+
+    for (auto& flow : m_flows) {
+        closeInterval(flow.second);
+    }
+    regroup();
+    return true;
+}
+
+typedef std::vector<std::pair<uint32_t, const SbdFlowStats*> > SbdGroup;
+
+/**
+ * Sort each group by a statistic, and split it wherever two consecutive
+ * flows are too far apart
+ */
+template <typename Key, typename Separate>
+static std::vector<SbdGroup> splitGroups(const std::vector<SbdGroup>& groups,
+                                         Key key, Separate separate) {
+    std::vector<SbdGroup> result{};
+    for (auto group : groups) {
+        std::sort(group.begin(), group.end(),
+                  [&key](const SbdGroup::value_type& a, const SbdGroup::value_type& b) {
+                      return key(*a.second) < key(*b.second);
+                  });
+        SbdGroup current{};
+        for (const auto& flow : group) {
+            if (!current.empty() && separate(key(*current.back().second), key(*flow.second))) {
+                result.push_back(current);
+                current.clear();
+            }
+            current.push_back(flow);
+        }
+        if (!current.empty()) {
+            result.push_back(current);
+        }
+    }
+    return result;
+}
+
+void SharedBottleneckDetector::regroup() {
+    // Step 1: flows traversing a bottleneck
+    SbdGroup bottlenecked{};
+    for (auto& item : m_flows) {
+        auto& flow = item.second;
+        const auto& stats = flow.stats;
+        bool isBottlenecked = false;
+        if (stats.numIntervals >= SBD_MIN_INTERVALS) {
+            const bool skewed = stats.skewEst < SBD_C_S ||
+                                (flow.bottlenecked && stats.skewEst < SBD_C_H);
+            isBottlenecked = stats.pktLoss > SBD_P_L ||
+                             (skewed && stats.varEst > SBD_MIN_VAR_MS);
+        }
+        flow.bottlenecked = isBottlenecked;
+        flow.group = item.first;
+        if (isBottlenecked) {
+            bottlenecked.push_back(std::make_pair(item.first, &flow.stats));
+        }
+    }
+    if (bottlenecked.empty()) {
+        return;
+    }
+
+    // Steps 2 to 4: split by oscillation frequency, variability, and skewness
+    std::vector<SbdGroup> groups(1, bottlenecked);
+    groups = splitGroups(groups,
+                         [](const SbdFlowStats& s) { return s.freqEst; },
+                         [](float prev, float cur) { return cur - prev > SBD_P_F; });
+    groups = splitGroups(groups,
+                         [](const SbdFlowStats& s) { return s.varEst; },
+                         [](float prev, float cur) { return cur - prev > SBD_P_MAD * cur; });
+    groups = splitGroups(groups,
+                         [](const SbdFlowStats& s) { return s.skewEst; },
+                         [](float prev, float cur) { return cur - prev > SBD_P_S; });
+
+    // Step 5: split loss-dominated groups by packet loss
+    std::vector<SbdGroup> result{};
+    for (const auto& group : groups) {
+        bool lossy = true;
+        for (const auto& flow : group) {
+            lossy = lossy && (flow.second->pktLoss > SBD_P_L);
+        }
+        if (!lossy) {
+            result.push_back(group);
+            continue;
+        }
+        const auto split = splitGroups(std::vector<SbdGroup>(1, group),
+                                       [](const SbdFlowStats& s) { return s.pktLoss; },
+                                       [](float prev, float cur) { return cur - prev > SBD_P_D * cur; });
+        result.insert(result.end(), split.begin(), split.end());
+    }
+
+    for (const auto& group : result) {
+        uint32_t groupId = group.front().first;
+        for (const auto& flow : group) {
+            groupId = std::min(groupId, flow.first);
+        }
+        for (const auto& flow : group) {
+            m_flows[flow.first].group = groupId;
+        }
+    }
+}
+
+uint32_t SharedBottleneckDetector::getGroup(uint32_t flowId) const {
+    const auto it = m_flows.find(flowId);
+    return (it == m_flows.end()) ? flowId : it->second.group;
+}
+
+bool SharedBottleneckDetector::getFlowStats(uint32_t flowId, SbdFlowStats& stats) const {
+    const auto it = m_flows.find(flowId);
+    if (it == m_flows.end() || it->second.stats.numIntervals == 0) {
+        return false;
+    }
+    stats = it->second.stats;
+    return true;
+}
+
+}
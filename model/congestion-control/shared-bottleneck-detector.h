@@ -0,0 +1,145 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Shared bottleneck detection (SBD) for rmcat ns3 module, grouping
+ * flows that traverse a common bottleneck so that they can be coupled
+ * (see #FlowStateExchange).
+ *
+ * Shared Bottleneck Detection for Coupled Congestion Control for RTP
+ * Media
+ * https://tools.ietf.org/html/rfc8382
+ *
+ * @version 0.1.1
+ */
+
+#ifndef SHARED_BOTTLENECK_DETECTOR_H
+#define SHARED_BOTTLENECK_DETECTOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace rmcat {
+
+/** Summary statistics of a flow's one-way delay, as defined in rfc8382 */
+struct SbdFlowStats {
+    float skewEst;   /**< skewness: in [-1, 1], negative if the OWD is mostly above its mean */
+    float varEst;    /**< variability: mean absolute deviation of the OWD, in ms */
+    float freqEst;   /**< oscillation: significant mean crossings per interval */
+    float pktLoss;   /**< packet loss ratio */
+    uint32_t numIntervals; /**< intervals the statistics are based upon */
+};
+
+/**
+ * Shared bottleneck detector, following Section 3 of rfc8382.
+ *
+ * One-way delay (OWD) samples are fed per flow as they are acknowledged.
+ * They are summarized into per-interval (T) statistics, which are in
+ * turn aggregated over the last N intervals with running sums, so that
+ * the cost per sample is constant. At the end of each interval, the
+ * flows deemed to traverse a bottleneck are grouped by their OWD
+ * oscillation frequency, variability and skewness (and packet loss, if
+ * loss-dominated); this costs O(F log F) for F flows per interval.
+ *
+ * Group ids are the smallest flow id in the group. Flows that are not
+ * (yet) deemed to traverse a bottleneck are in a group of their own.
+ * The OWDs need not come from synchronized clocks, as only their
+ * variations are used.
+ */
+class SharedBottleneckDetector {
+public:
+    SharedBottleneckDetector();
+
+    /** Start tracking a flow, identified by the caller */
+    void registerFlow(uint32_t flowId);
+
+    /** Stop tracking a flow */
+    void deregisterFlow(uint32_t flowId);
+
+    /**
+     * Add the OWD sample of an acknowledged packet of a flow. Sequence
+     * gaps count as losses
+     *
+     * @param [in] flowId Id of the flow
+     * @param [in] sequence Sequence number of the packet
+     * @param [in] owdUs One-way delay of the packet, in microseconds
+     */
+    void addSample(uint32_t flowId, uint16_t sequence, uint64_t owdUs);
+
+    /**
+     * Close the current interval if it has elapsed, and regroup the flows
+     *
+     * @param [in] nowUs Current time
+     * @retval true if the flows were regrouped. False otherwise
+     */
+    bool update(uint64_t nowUs);
+
+    /** Group of a flow; its own id if ungrouped or unknown */
+    uint32_t getGroup(uint32_t flowId) const;
+
+    /**
+     * Summary statistics of a flow as of the last closed interval
+     *
+     * @retval false if the flow is unknown or has no statistics yet
+     */
+    bool getFlowStats(uint32_t flowId, SbdFlowStats& stats) const;
+
+private:
+    struct IntervalSummary {
+        uint32_t numSamples;
+        uint32_t numLost;
+        double sumOwdMs;
+        int32_t skewBase;
+        double varBaseMs;
+        bool crossing;
+    };
+
+    struct FlowState {
+        /* current interval */
+        IntervalSummary current;
+        bool seqValid;
+        uint16_t nextSeq;
+        uint64_t baseOwdUs;       // first OWD seen, to keep sums small
+        /* last N intervals, with running sums */
+        std::deque<IntervalSummary> intervals;
+        uint64_t sumSamples;
+        uint64_t sumLost;
+        double sumOwdMs;
+        int64_t sumSkewBase;
+        double sumVarBaseMs;
+        uint32_t sumCrossings;
+        int8_t lastSide;          // -1 below, 1 above the mean, 0 unknown
+        bool bottlenecked;
+        uint32_t group;
+        SbdFlowStats stats;
+    };
+
+    void closeInterval(FlowState& flow);
+    void regroup();
+
+    std::map<uint32_t, FlowState> m_flows;
+    uint64_t m_intervalStartUs;
+    bool m_intervalStartValid;
+};
+
+}
+
+#endif /* SHARED_BOTTLENECK_DETECTOR_H */
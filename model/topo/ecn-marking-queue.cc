@@ -0,0 +1,135 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Bottleneck queue marking packets with ECN Congestion Experienced
+ * implementation for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#include "ecn-marking-queue.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/ppp-header.h"
+#include "ns3/ipv4-header.h"
+
+NS_LOG_COMPONENT_DEFINE ("EcnMarkingQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (EcnMarkingQueue);
+
+static const uint16_t PPP_PROTOCOL_IPV4 = 0x0021;
+
+TypeId EcnMarkingQueue::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::EcnMarkingQueue")
+        .SetParent<Queue> ()
+        .SetGroupName ("Network")
+        .AddConstructor<EcnMarkingQueue> ()
+        .AddAttribute ("MarkingThreshold",
+                       "Sojourn time above which ECN-capable packets are marked CE",
+                       TimeValue (MilliSeconds (1)),
+                       MakeTimeAccessor (&EcnMarkingQueue::m_threshold),
+                       MakeTimeChecker ())
+        .AddTraceSource ("NumMarked",
+                         "Number of packets marked CE so far",
+                         MakeTraceSourceAccessor (&EcnMarkingQueue::m_numMarked),
+                         "ns3::TracedValueCallback::Uint32")
+    ;
+    return tid;
+}
+
+EcnMarkingQueue::EcnMarkingQueue ()
+: Queue{}
+, m_packets{}
+, m_threshold{MilliSeconds (1)}
+, m_numMarked{0}
+{}
+
+EcnMarkingQueue::~EcnMarkingQueue ()
+{}
+
+bool EcnMarkingQueue::DoEnqueue (Ptr<QueueItem> item)
+{
+    m_packets.push_back (std::make_pair (item, Simulator::Now ()));
+    return true;
+}
+
+Ptr<QueueItem> EcnMarkingQueue::DoDequeue (void)
+{
+    if (m_packets.empty ()) {
+        return 0;
+    }
+
+    const auto item = m_packets.front ().first;
+    const auto sojourn = Simulator::Now () - m_packets.front ().second;
+    m_packets.pop_front ();
+
+    if (sojourn > m_threshold && MarkPacket (item->GetPacket ())) {
+        ++m_numMarked;
+        NS_LOG_LOGIC ("Marked CE, sojourn time " << sojourn.GetMicroSeconds () << " us");
+    }
+    return item;
+}
+
+Ptr<QueueItem> EcnMarkingQueue::DoRemove (void)
+{
+    if (m_packets.empty ()) {
+        return 0;
+    }
+
+    const auto item = m_packets.front ().first;
+    m_packets.pop_front ();
+    return item;
+}
+
+Ptr<const QueueItem> EcnMarkingQueue::DoPeek (void) const
+{
+    if (m_packets.empty ()) {
+        return 0;
+    }
+    return m_packets.front ().first;
+}
+
+bool EcnMarkingQueue::MarkPacket (Ptr<Packet> packet) const
+{
+    PppHeader ppp;
+    if (!packet->PeekHeader (ppp) || ppp.GetProtocol () != PPP_PROTOCOL_IPV4) {
+        return false;
+    }
+    packet->RemoveHeader (ppp);
+
+    Ipv4Header ip;
+    packet->RemoveHeader (ip);
+    const auto ecn = ip.GetEcn ();
+    const bool mark = (ecn == Ipv4Header::ECN_ECT0 || ecn == Ipv4Header::ECN_ECT1);
+    if (mark) {
+        ip.SetEcn (Ipv4Header::ECN_CE);
+        if (Node::ChecksumEnabled ()) {
+            ip.EnableChecksum ();
+        }
+    }
+    packet->AddHeader (ip);
+    packet->AddHeader (ppp);
+    return mark;
+}
+
+}
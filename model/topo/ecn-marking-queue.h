@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Bottleneck queue marking packets with ECN Congestion Experienced
+ * for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef ECN_MARKING_QUEUE_H
+#define ECN_MARKING_QUEUE_H
+
+#include "ns3/queue.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-value.h"
+#include <deque>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * FIFO device queue that applies an L4S-style step marking: packets
+ * whose sojourn time in the queue exceeds a (shallow) threshold are
+ * marked as Congestion Experienced (CE) upon dequeue, provided that they
+ * are ECN-capable (ECT(0) or ECT(1)). Packets that are not ECN-capable
+ * are left untouched. Limits (and thus drops) are the same as those of
+ * a drop-tail queue, and are handled by the base class.
+ *
+ * It is meant to be installed as the queue of a point-to-point device,
+ * since ns-3's queue discs cannot mark packets yet. Hence packets are
+ * expected to carry a PPP header followed by an IPv4 header.
+ */
+class EcnMarkingQueue : public Queue
+{
+public:
+    static TypeId GetTypeId (void);
+
+    /** Class constructor */
+    EcnMarkingQueue ();
+
+    /** Class destructor */
+    virtual ~EcnMarkingQueue ();
+
+private:
+    virtual bool DoEnqueue (Ptr<QueueItem> item);
+    virtual Ptr<QueueItem> DoDequeue (void);
+    virtual Ptr<QueueItem> DoRemove (void);
+    virtual Ptr<const QueueItem> DoPeek (void) const;
+
+    /** Set the CE codepoint of an IPv4 packet, if it is ECN-capable */
+    bool MarkPacket (Ptr<Packet> packet) const;
+
+    std::deque<std::pair<Ptr<QueueItem>, Time> > m_packets; /**< packets and their enqueue time */
+    Time m_threshold;
+    TracedValue<uint32_t> m_numMarked;
+};
+
+}
+
+#endif /* ECN_MARKING_QUEUE_H */
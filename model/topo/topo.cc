@@ -29,8 +29,15 @@
 #include "ns3/rmcat-sender.h"
 #include "ns3/rmcat-receiver.h"
 #include "ns3/nada-controller.h"
+#include "ns3/gcc-controller.h"
+#include "ns3/scream-controller.h"
 #include "ns3/ccfs-controller.h"
+#include "ns3/ccfs-params-profile.h"
 #include "ns3/rmcat-ccfs-receiver.h"
+#include "ns3/remb-controller.h"
+#include "ns3/rmcat-remb-receiver.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/ipv4-static-routing-helper.h"
 #include <memory>
 #include <limits>
 #include <sys/stat.h>
@@ -64,6 +71,19 @@ static std::string GetPrefix (Ptr<Node> node,
     return os.str ();
 }
 
+/*
+ * In a distributed simulation every rank builds the whole topology, but
+ * applications are only attached to (and thus only run on) the nodes the
+ * rank owns. Application objects for remote nodes are still created, so
+ * that callers can configure them regardless of the rank they run on
+ */
+static Ptr<Application> InstallApplication (ObjectFactory& factory, Ptr<Node> node)
+{
+    auto app = factory.Create<Application> ();
+    Topo::AddApplication (node, app);
+    return app;
+}
+
 static Time GetIntervalFromBitrate (uint64_t bitrate, uint32_t packetSize)
 {
     if (bitrate == 0u) {
@@ -115,30 +135,36 @@ ApplicationContainer Topo::InstallTCP (const std::string& flowId,
                                        Ptr<Node> receiver,
                                        uint16_t serverPort)
 {
-    BulkSendHelper source ("ns3::TcpSocketFactory",
-                           InetSocketAddress{GetIpv4AddressOfNode (receiver, 1, 0), serverPort});
+    ObjectFactory source;
+    source.SetTypeId (BulkSendApplication::GetTypeId ());
+    source.Set ("Protocol", StringValue ("ns3::TcpSocketFactory"));
+    source.Set ("Remote", AddressValue (InetSocketAddress{GetIpv4AddressOfNode (receiver, 1, 0), serverPort}));
 
     // Set the amount of data to send in bytes. Zero denotes unlimited.
-    source.SetAttribute ("MaxBytes", UintegerValue (0));
-    source.SetAttribute ("SendSize", UintegerValue (DEFAULT_PACKET_SIZE));
+    source.Set ("MaxBytes", UintegerValue (0));
+    source.Set ("SendSize", UintegerValue (DEFAULT_PACKET_SIZE));
 
-    auto clientApps = source.Install (sender);
+    ApplicationContainer clientApps{InstallApplication (source, sender)};
     clientApps.Start (Seconds (0));
     clientApps.Stop (Seconds (T_MAX_S));
 
-    PacketSinkHelper sink ("ns3::TcpSocketFactory",
-                           InetSocketAddress{Ipv4Address::GetAny (), serverPort});
-    auto serverApps = sink.Install (receiver);
+    ObjectFactory sink;
+    sink.SetTypeId (PacketSink::GetTypeId ());
+    sink.Set ("Protocol", StringValue ("ns3::TcpSocketFactory"));
+    sink.Set ("Local", AddressValue (InetSocketAddress{Ipv4Address::GetAny (), serverPort}));
+    ApplicationContainer serverApps{InstallApplication (sink, receiver)};
     serverApps.Start (Seconds (0));
     serverApps.Stop (Seconds (T_MAX_S));
 
-    const auto interval = T_TCP_LOG;
-    Simulator::Schedule (Seconds (interval),
-                         &PacketSinkLogging,
-                         GetPrefix (sender, "tcp_log", flowId, serverPort),
-                         serverApps.Get (0),
-                         interval,
-                         0);
+    if (IsLocalNode (receiver)) {
+        const auto interval = T_TCP_LOG;
+        Simulator::Schedule (Seconds (interval),
+                             &PacketSinkLogging,
+                             GetPrefix (sender, "tcp_log", flowId, serverPort),
+                             serverApps.Get (0),
+                             interval,
+                             0);
+    }
 
     ApplicationContainer apps;
     apps.Add (clientApps);
@@ -153,18 +179,23 @@ ApplicationContainer Topo::InstallCBR (Ptr<Node> sender,
                                        uint64_t bitrate,
                                        uint32_t packetSize)
 {
-    UdpServerHelper server (serverPort);
-    ApplicationContainer serverApps = server.Install (receiver);
+    ObjectFactory server;
+    server.SetTypeId (UdpServer::GetTypeId ());
+    server.Set ("Port", UintegerValue (serverPort));
+    ApplicationContainer serverApps{InstallApplication (server, receiver)};
     serverApps.Start (Seconds (0));
     serverApps.Stop (Seconds (T_MAX_S));
 
     const auto interPacketInterval = GetIntervalFromBitrate (bitrate, packetSize);
     const auto maxPacketCount = std::numeric_limits<uint32_t>::max ();
-    UdpClientHelper client (GetIpv4AddressOfNode (receiver, 1, 0), serverPort);
-    client.SetAttribute ("MaxPackets", UintegerValue (maxPacketCount));
-    client.SetAttribute ("Interval", TimeValue (interPacketInterval));
-    client.SetAttribute ("PacketSize", UintegerValue (packetSize));
-    ApplicationContainer clientApps = client.Install (sender);
+    ObjectFactory client;
+    client.SetTypeId (UdpClient::GetTypeId ());
+    client.Set ("RemoteAddress", AddressValue (Address (GetIpv4AddressOfNode (receiver, 1, 0))));
+    client.Set ("RemotePort", UintegerValue (serverPort));
+    client.Set ("MaxPackets", UintegerValue (maxPacketCount));
+    client.Set ("Interval", TimeValue (interPacketInterval));
+    client.Set ("PacketSize", UintegerValue (packetSize));
+    ApplicationContainer clientApps{InstallApplication (client, sender)};
     clientApps.Start (Seconds (0));
     clientApps.Stop (Seconds (T_MAX_S));
 
@@ -186,8 +217,8 @@ ApplicationContainer Topo::InstallRMCAT_CCFS(const std::string& flowId,
     auto rmcatAppRecv = CreateObject<RmcatCcfsReceiver> ();
     auto ccfs = std::make_shared<rmcat::CcfsController> ();
 
-    sender->AddApplication (rmcatAppSend);
-    receiver->AddApplication (rmcatAppRecv);
+    AddApplication (sender, rmcatAppSend);
+    AddApplication (receiver, rmcatAppRecv);
 
     rmcatAppSend->SetController(ccfs);
     rmcatAppSend->SetControllerName("CCFS");
@@ -197,6 +228,7 @@ ApplicationContainer Topo::InstallRMCAT_CCFS(const std::string& flowId,
 
     ccfs->setLogCallback( logFromController );
     ccfs->setId( flowId );
+    ccfs->setParams( CreateObject<CcfsParamsProfile> ()->GetParams () );
 
     rmcatAppSend->SetStartTime (Seconds (0));
     rmcatAppSend->SetStopTime (Seconds (T_MAX_S));
@@ -215,22 +247,83 @@ ApplicationContainer Topo::InstallRMCAT_CCFS(const std::string& flowId,
     return apps;
 }
 
+ApplicationContainer Topo::InstallRMCAT_SenderBased (const std::string& flowId,
+                                                     std::shared_ptr<rmcat::SenderBasedController> controller,
+                                                     Ptr<Node> sender,
+                                                     Ptr<Node> receiver,
+                                                     uint16_t serverPort)
+{
+
+    auto rmcatAppSend = CreateObject<RmcatSender> ();
+    auto rmcatAppRecv = CreateObject<RmcatReceiver> ();
+    AddApplication (sender, rmcatAppSend);
+    AddApplication (receiver, rmcatAppRecv);
+
+    Ipv4Address serverIP = GetIpv4AddressOfNode (receiver, 1, 0);
+    rmcatAppSend->Setup (serverIP, serverPort);
+
+    /* configure congestion controller */
+    controller->setLogCallback (logFromController);
+    controller->setId (flowId);
+    rmcatAppSend->SetController (controller);
+
+    rmcatAppSend->SetStartTime (Seconds (0));
+    rmcatAppSend->SetStopTime (Seconds (T_MAX_S));
+
+    rmcatAppRecv->Setup (serverPort);
+    rmcatAppRecv->SetStartTime (Seconds (0));
+    rmcatAppRecv->SetStopTime (Seconds (T_MAX_S));
+
+    ApplicationContainer apps;
+    apps.Add (rmcatAppSend);
+    apps.Add (rmcatAppRecv);
+    return apps;
+}
+
 ApplicationContainer Topo::InstallRMCAT_NADA (const std::string& flowId,
                                               Ptr<Node> sender,
                                               Ptr<Node> receiver,
                                               uint16_t serverPort)
 {
+    auto controller = std::make_shared<rmcat::NadaController> ();
+    return InstallRMCAT_SenderBased (flowId, controller, sender, receiver, serverPort);
+}
 
+ApplicationContainer Topo::InstallRMCAT_GCC (const std::string& flowId,
+                                             Ptr<Node> sender,
+                                             Ptr<Node> receiver,
+                                             uint16_t serverPort)
+{
+    auto controller = std::make_shared<rmcat::GccController> ();
+    return InstallRMCAT_SenderBased (flowId, controller, sender, receiver, serverPort);
+}
+
+ApplicationContainer Topo::InstallRMCAT_SCREAM (const std::string& flowId,
+                                                Ptr<Node> sender,
+                                                Ptr<Node> receiver,
+                                                uint16_t serverPort)
+{
+    auto controller = std::make_shared<rmcat::ScreamController> ();
+    return InstallRMCAT_SenderBased (flowId, controller, sender, receiver, serverPort);
+}
+
+ApplicationContainer Topo::InstallRMCAT_REMB (const std::string& flowId,
+                                              Ptr<Node> sender,
+                                              Ptr<Node> receiver,
+                                              uint16_t serverPort)
+{
     auto rmcatAppSend = CreateObject<RmcatSender> ();
-    auto rmcatAppRecv = CreateObject<RmcatReceiver> ();
-    sender->AddApplication (rmcatAppSend);
-    receiver->AddApplication (rmcatAppRecv);
+    auto rmcatAppRecv = CreateObject<RmcatRembReceiver> ();
+    AddApplication (sender, rmcatAppSend);
+    AddApplication (receiver, rmcatAppRecv);
 
     Ipv4Address serverIP = GetIpv4AddressOfNode (receiver, 1, 0);
     rmcatAppSend->Setup (serverIP, serverPort);
+    // The receiver's estimator needs abs-send-time
+    rmcatAppSend->SetHeaderExtensionsEnabled (true);
 
     /* configure congestion controller */
-    auto controller = std::make_shared<rmcat::NadaController> ();
+    auto controller = std::make_shared<rmcat::RembController> ();
     controller->setLogCallback (logFromController);
     controller->setId (flowId);
     rmcatAppSend->SetController (controller);
@@ -259,11 +352,61 @@ ApplicationContainer Topo::InstallRMCAT (const std::string& ccontroller,
     {
         return InstallRMCAT_CCFS(flowId, sender, receiver, serverPort);
     }
+    if(ccontroller == "gcc" ||
+       ccontroller == "GCC")
+    {
+        return InstallRMCAT_GCC(flowId, sender, receiver, serverPort);
+    }
+    if(ccontroller == "scream" ||
+       ccontroller == "SCREAM")
+    {
+        return InstallRMCAT_SCREAM(flowId, sender, receiver, serverPort);
+    }
+    if(ccontroller == "remb" ||
+       ccontroller == "REMB")
+    {
+        return InstallRMCAT_REMB(flowId, sender, receiver, serverPort);
+    }
 
     return InstallRMCAT_NADA(flowId, sender, receiver, serverPort);
 
 }
 
+bool Topo::IsLocalNode (Ptr<Node> node)
+{
+    return !MpiInterface::IsEnabled () ||
+           node->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
+void Topo::AddApplication (Ptr<Node> node, Ptr<Application> app)
+{
+    if (IsLocalNode (node)) {
+        node->AddApplication (app);
+    }
+}
+
+void Topo::AddStaticRoute (Ptr<Node> node,
+                           Ptr<NetDevice> device,
+                           Ipv4Address network,
+                           Ipv4Mask mask,
+                           Ipv4Address nextHop)
+{
+    auto ipv4 = node->GetObject<Ipv4> ();
+    NS_ASSERT (ipv4);
+    const auto interface = ipv4->GetInterfaceForDevice (device);
+    NS_ASSERT (interface >= 0);
+    Ipv4StaticRoutingHelper routingHlpr;
+    auto routing = routingHlpr.GetStaticRouting (ipv4);
+    NS_ASSERT (routing);
+    routing->AddNetworkRouteTo (network, mask, nextHop, interface);
+}
+
+const Ipv4RoutingHelper& Topo::GetStaticRoutingHelper ()
+{
+    static const Ipv4StaticRoutingHelper routingHlpr;
+    return routingHlpr;
+}
+
 void Topo::logFromController (const std::string& msg) {
     NS_LOG_INFO ("controller_log: " << msg);
 }
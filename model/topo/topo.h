@@ -42,12 +42,60 @@
 #include "ns3/traffic-control-helper.h"
 
 #include "ns3/rmcat-constants.h"
+#include "ns3/sender-based-controller.h"
+#include <memory>
 
 namespace ns3 {
 
 class Topo
 {
+public:
+    /**
+     * Tell whether a node is simulated by this process. Always true unless
+     * running a distributed (MPI) simulation, where each rank only
+     * simulates the nodes whose system id matches its own
+     *
+     * @param [in] node The node to check
+     * @retval true if the node's applications run in this process
+     */
+    static bool IsLocalNode (Ptr<Node> node);
+
+    /**
+     * Attach an application to a node, provided the node is simulated by
+     * this process (see #IsLocalNode). Otherwise, the application is left
+     * detached and never runs
+     *
+     * @param [in,out] node The node the application belongs to
+     * @param [in,out] app The application to attach
+     */
+    static void AddApplication (Ptr<Node> node, Ptr<Application> app);
+
 protected:
+    /**
+     * Add a static route to a node. Topologies here are simple enough for
+     * their routes to be known when nodes are wired, so they install them
+     * directly rather than paying for a global routing computation.
+     * The node must use static routing (see #GetStaticRoutingHelper).
+     *
+     * @param [in,out] node Node whose routing table is to be updated
+     * @param [in]     device Outgoing device (must have an IPv4 interface)
+     * @param [in]     network Destination network
+     * @param [in]     mask Destination network mask. Use
+     *                      Ipv4Mask::GetZero () for a default route
+     * @param [in]     nextHop Gateway to forward packets to
+     */
+    static void AddStaticRoute (Ptr<Node> node,
+                                Ptr<NetDevice> device,
+                                Ipv4Address network,
+                                Ipv4Mask mask,
+                                Ipv4Address nextHop);
+
+    /**
+     * Routing helper to be passed to the InternetStackHelper of nodes
+     * whose routes are set with #AddStaticRoute
+     */
+    static const Ipv4RoutingHelper& GetStaticRoutingHelper ();
+
     /**
      * Install two applications (sender and receiver) implementing a TCP flow.
      * The sender of application data (resp. receiver) will be installed at the
@@ -132,14 +180,31 @@ protected:
     static void logFromController (const std::string& msg);
 
 private:
+    static ApplicationContainer InstallRMCAT_SenderBased (const std::string& flowId,
+                                                          std::shared_ptr<rmcat::SenderBasedController> controller,
+                                                          Ptr<Node> sender,
+                                                          Ptr<Node> receiver,
+                                                          uint16_t serverPort);
     static ApplicationContainer InstallRMCAT_NADA(const std::string& flowId,
                                                    Ptr<Node> sender,
                                                    Ptr<Node> receiver,
                                                    uint16_t serverPort);
+    static ApplicationContainer InstallRMCAT_GCC(const std::string& flowId,
+                                                 Ptr<Node> sender,
+                                                 Ptr<Node> receiver,
+                                                 uint16_t serverPort);
+    static ApplicationContainer InstallRMCAT_SCREAM(const std::string& flowId,
+                                                    Ptr<Node> sender,
+                                                    Ptr<Node> receiver,
+                                                    uint16_t serverPort);
     static ApplicationContainer InstallRMCAT_CCFS(const std::string& flowId,
                                                   Ptr<Node> sender,
                                                   Ptr<Node> receiver,
                                                   uint16_t serverPort);
+    static ApplicationContainer InstallRMCAT_REMB(const std::string& flowId,
+                                                  Ptr<Node> sender,
+                                                  Ptr<Node> receiver,
+                                                  uint16_t serverPort);
 };
 
 }
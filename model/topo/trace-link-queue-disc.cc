@@ -0,0 +1,303 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Trace-driven bottleneck queue disc implementation for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#include "trace-link-queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("TraceLinkQueueDisc");
+
+namespace ns3 {
+
+DeliveryTrace::DeliveryTrace ()
+: m_data{NULL}
+, m_size{0}
+, m_pos{0}
+, m_offsetMs{0}
+, m_periodMs{0}
+{}
+
+DeliveryTrace::~DeliveryTrace ()
+{
+    Close ();
+}
+
+bool DeliveryTrace::Open (const std::string& path)
+{
+    Close ();
+    const int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat (fd, &st) != 0 || st.st_size <= 0) {
+        ::close (fd);
+        return false;
+    }
+    void* data = ::mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd); // the mapping stays valid
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    m_data = static_cast<const char*> (data);
+    m_size = st.st_size;
+    m_pos = 0;
+    m_offsetMs = 0;
+
+    // The trace repeats with a period equal to its last timestamp
+    size_t pos = 0;
+    uint64_t firstMs = 0;
+    if (!Parse (pos, firstMs) || !ParseLast (m_periodMs) || m_periodMs == 0) {
+        Close ();
+        return false;
+    }
+    return true;
+}
+
+void DeliveryTrace::Close ()
+{
+    if (m_data != NULL) {
+        ::munmap (const_cast<char*> (m_data), m_size);
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_pos = 0;
+    m_offsetMs = 0;
+    m_periodMs = 0;
+}
+
+uint64_t DeliveryTrace::Next ()
+{
+    NS_ASSERT (m_data != NULL);
+    uint64_t valueMs = 0;
+    if (!Parse (m_pos, valueMs)) {
+        // End of the trace: start over
+        m_pos = 0;
+        m_offsetMs += m_periodMs;
+        const bool res = Parse (m_pos, valueMs);
+        NS_ASSERT (res); // checked by Open
+        (void) res; // unused in optimized builds
+    }
+    return m_offsetMs + valueMs;
+}
+
+bool DeliveryTrace::Parse (size_t& pos, uint64_t& valueMs) const
+{
+    // Blank and malformed lines are skipped
+    while (pos < m_size) {
+        if (ParseLine (pos, valueMs)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DeliveryTrace::ParseLine (size_t& pos, uint64_t& valueMs) const
+{
+    while (pos < m_size && (m_data[pos] == '\r' || m_data[pos] == ' ' || m_data[pos] == '\t')) {
+        ++pos;
+    }
+    uint64_t value = 0;
+    const auto begin = pos;
+    while (pos < m_size && m_data[pos] >= '0' && m_data[pos] <= '9') {
+        value = value * 10 + (m_data[pos] - '0');
+        ++pos;
+    }
+    const bool valid = (pos != begin);
+    // Skip the rest of the line, and its end
+    while (pos < m_size && m_data[pos] != '\n') {
+        ++pos;
+    }
+    if (pos < m_size) {
+        ++pos;
+    }
+    if (valid) {
+        valueMs = value;
+    }
+    return valid;
+}
+
+bool DeliveryTrace::ParseLast (uint64_t& valueMs) const
+{
+    // Walk the lines backwards, up to the last valid one
+    size_t end = m_size;
+    while (end > 0) {
+        size_t begin = end - 1;
+        while (begin > 0 && m_data[begin - 1] != '\n') {
+            --begin;
+        }
+        size_t pos = begin;
+        if (ParseLine (pos, valueMs)) {
+            return true;
+        }
+        end = begin;
+    }
+    return false;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TraceLinkQueueDisc);
+
+TypeId TraceLinkQueueDisc::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::TraceLinkQueueDisc")
+        .SetParent<QueueDisc> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<TraceLinkQueueDisc> ()
+        .AddAttribute ("TraceFile",
+                       "Delivery trace file, in Mahimahi's format",
+                       StringValue (""),
+                       MakeStringAccessor (&TraceLinkQueueDisc::m_traceFile),
+                       MakeStringChecker ())
+        .AddAttribute ("MaxBytes",
+                       "Maximum number of bytes in the queue",
+                       UintegerValue (1500 * 1000),
+                       MakeUintegerAccessor (&TraceLinkQueueDisc::m_maxBytes),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("OpportunityBytes",
+                       "Bytes that can be delivered at each delivery opportunity",
+                       UintegerValue (1500),
+                       MakeUintegerAccessor (&TraceLinkQueueDisc::m_opportunityBytes),
+                       MakeUintegerChecker<uint32_t> (1))
+    ;
+    return tid;
+}
+
+TraceLinkQueueDisc::TraceLinkQueueDisc ()
+: QueueDisc{}
+, m_traceFile{}
+, m_maxBytes{1500 * 1000}
+, m_opportunityBytes{1500}
+, m_trace{}
+, m_packets{}
+, m_bytes{0}
+, m_nextOpportunityMs{0}
+, m_lastOpportunityMs{0}
+, m_credit{0}
+, m_runEvent{}
+{}
+
+TraceLinkQueueDisc::~TraceLinkQueueDisc ()
+{}
+
+void TraceLinkQueueDisc::DoDispose (void)
+{
+    Simulator::Cancel (m_runEvent);
+    m_packets.clear ();
+    m_trace.Close ();
+    QueueDisc::DoDispose ();
+}
+
+bool TraceLinkQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+    if (m_bytes + item->GetPacketSize () > m_maxBytes) {
+        NS_LOG_LOGIC ("Queue full, dropping packet");
+        Drop (item);
+        return false;
+    }
+
+    if (m_packets.empty ()) {
+        // Opportunities that found the link idle are lost
+        const uint64_t nowMs = Simulator::Now ().GetMilliSeconds ();
+        if (m_lastOpportunityMs < nowMs) {
+            m_credit = 0;
+        }
+        while (m_nextOpportunityMs < nowMs) {
+            m_nextOpportunityMs = m_trace.Next ();
+        }
+    }
+
+    m_packets.push_back (item);
+    m_bytes += item->GetPacketSize ();
+    return true;
+}
+
+void TraceLinkQueueDisc::UpdateCredit (uint64_t nowMs)
+{
+    while (m_nextOpportunityMs <= nowMs) {
+        m_credit += m_opportunityBytes;
+        m_lastOpportunityMs = m_nextOpportunityMs;
+        m_nextOpportunityMs = m_trace.Next ();
+    }
+}
+
+Ptr<QueueDiscItem> TraceLinkQueueDisc::DoDequeue (void)
+{
+    if (m_packets.empty ()) {
+        return 0;
+    }
+
+    const auto now = Simulator::Now ();
+    UpdateCredit (now.GetMilliSeconds ());
+
+    const auto item = m_packets.front ();
+    if (item->GetPacketSize () > m_credit) {
+        // Wait for the next opportunity
+        if (!m_runEvent.IsRunning ()) {
+            const auto wait = MilliSeconds (m_nextOpportunityMs) - now;
+            m_runEvent = Simulator::Schedule (wait, &TraceLinkQueueDisc::Run, this);
+        }
+        return 0;
+    }
+
+    m_credit -= item->GetPacketSize ();
+    m_bytes -= item->GetPacketSize ();
+    m_packets.pop_front ();
+    return item;
+}
+
+Ptr<const QueueDiscItem> TraceLinkQueueDisc::DoPeek (void) const
+{
+    if (m_packets.empty ()) {
+        return 0;
+    }
+    return m_packets.front ();
+}
+
+bool TraceLinkQueueDisc::CheckConfig (void)
+{
+    if (GetNQueueDiscClasses () > 0 || GetNPacketFilters () > 0 || GetNInternalQueues () > 0) {
+        NS_LOG_ERROR ("TraceLinkQueueDisc needs no classes, packet filters or internal queues");
+        return false;
+    }
+    if (!m_trace.Open (m_traceFile)) {
+        NS_LOG_ERROR ("Cannot open delivery trace " << m_traceFile);
+        return false;
+    }
+    return true;
+}
+
+void TraceLinkQueueDisc::InitializeParams (void)
+{
+    m_nextOpportunityMs = m_trace.Next ();
+    m_lastOpportunityMs = 0;
+    m_credit = 0;
+}
+
+}
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Trace-driven bottleneck queue disc for rmcat ns3 module.
+ *
+ * @version 0.1.1
+ */
+
+#ifndef TRACE_LINK_QUEUE_DISC_H
+#define TRACE_LINK_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/event-id.h"
+#include <deque>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Packet delivery trace in Mahimahi's format: one line per delivery
+ * opportunity, containing the time (in ms) at which one MTU-sized packet
+ * can be delivered. Several opportunities can share the same time, and
+ * the trace repeats itself once exhausted, with a period equal to its
+ * last timestamp. Lines that do not start with a number are skipped.
+ *
+ * The file is memory-mapped and walked by a cursor, so that long traces
+ * are neither loaded nor parsed beforehand.
+ */
+class DeliveryTrace
+{
+public:
+    /** Class constructor */
+    DeliveryTrace ();
+
+    /** Class destructor */
+    ~DeliveryTrace ();
+
+    /**
+     * Map a trace file and place the cursor at its first opportunity
+     *
+     * @param [in] path Path to the trace file
+     * @retval false if the file cannot be mapped, or is not a valid trace
+     */
+    bool Open (const std::string& path);
+
+    /** Unmap the trace file, if any */
+    void Close ();
+
+    /**
+     * Time of the next delivery opportunity, in ms. The cursor advances
+     * past it
+     */
+    uint64_t Next ();
+
+private:
+    DeliveryTrace (const DeliveryTrace&);
+    DeliveryTrace& operator= (const DeliveryTrace&);
+
+    /** Parse the first valid line from pos on; false at the end of the file */
+    bool Parse (size_t& pos, uint64_t& valueMs) const;
+    /** Parse the line at pos, which then points to the next line */
+    bool ParseLine (size_t& pos, uint64_t& valueMs) const;
+    bool ParseLast (uint64_t& valueMs) const;
+
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;         // cursor: start of the next line to parse
+    uint64_t m_offsetMs;  // start time of the current trace repetition
+    uint64_t m_periodMs;
+};
+
+/**
+ * Queue disc serving packets according to a #DeliveryTrace, so that the
+ * link it is installed on behaves as a link with time-varying capacity
+ * (e.g., a cellular link recorded with Mahimahi). Each delivery opportunity
+ * lets up to "OpportunityBytes" bytes out; opportunities that find the queue
+ * empty are lost. Time 0 in the trace is the start of the simulation.
+ *
+ * The device it is installed on must be (much) faster than the trace,
+ * and its device queue should be small, so that the queue only builds
+ * up here.
+ */
+class TraceLinkQueueDisc : public QueueDisc
+{
+public:
+    static TypeId GetTypeId (void);
+
+    /** Class constructor */
+    TraceLinkQueueDisc ();
+
+    /** Class destructor */
+    virtual ~TraceLinkQueueDisc ();
+
+protected:
+    virtual void DoDispose (void);
+
+private:
+    virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+    virtual Ptr<QueueDiscItem> DoDequeue (void);
+    virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+    virtual bool CheckConfig (void);
+    virtual void InitializeParams (void);
+
+    /** Collect the delivery opportunities up to now */
+    void UpdateCredit (uint64_t nowMs);
+
+    std::string m_traceFile;
+    uint32_t m_maxBytes;
+    uint32_t m_opportunityBytes;
+    DeliveryTrace m_trace;
+    std::deque<Ptr<QueueDiscItem> > m_packets;
+    uint32_t m_bytes;          // bytes in m_packets
+    uint64_t m_nextOpportunityMs;
+    uint64_t m_lastOpportunityMs;
+    uint32_t m_credit;         // bytes that can still be delivered
+    EventId m_runEvent;
+};
+
+}
+
+#endif /* TRACE_LINK_QUEUE_DISC_H */
@@ -159,19 +159,29 @@ void WifiTopo::Build (uint64_t bandwidthBps,
 
     // install protocol stack
     InternetStackHelper stack;
+    stack.SetRoutingHelper (GetStaticRoutingHelper ());
     stack.Install (m_wifiStaNodes);
     stack.Install (m_wiredNodes);
 
     Ipv4AddressHelper address;
 
     address.SetBase ("10.1.1.0", "255.255.255.0");
-    address.Assign (m_wiredDevices);
+    auto wiredInterfaces = address.Assign (m_wiredDevices);
 
     address.SetBase ("10.1.2.0", "255.255.255.0");
     address.Assign (m_staDevices);
-    address.Assign (m_apDevices);
+    auto apInterfaces = address.Assign (m_apDevices);
 
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    // The AP is directly connected to both subnets: stations and n1 just
+    // need a default route through it
+    for (uint32_t i = 0; i < nWifi; ++i) {
+        AddStaticRoute (m_wifiStaNodes.Get (i), m_staDevices.Get (i),
+                        Ipv4Address::GetAny (), Ipv4Mask::GetZero (),
+                        apInterfaces.GetAddress (0));
+    }
+    AddStaticRoute (m_wiredNodes.Get (1), m_wiredDevices.Get (1),
+                    Ipv4Address::GetAny (), Ipv4Mask::GetZero (),
+                    wiredInterfaces.GetAddress (0));
 
     // Disable tc now, some bug in ns3 cause extra delay
     TrafficControlHelper tch;
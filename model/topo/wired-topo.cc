@@ -26,21 +26,131 @@
  */
 
 #include "wired-topo.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("WiredTopo");
 
 namespace ns3 {
 
+/**
+ * Packet tag recording the time at which a packet entered the bottleneck
+ * queue (i.e., either the queue disc or the device queue)
+ */
+class BottleneckTimestampTag : public Tag
+{
+public:
+    static TypeId GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::BottleneckTimestampTag")
+            .SetParent<Tag> ()
+            .SetGroupName ("Network")
+            .AddConstructor<BottleneckTimestampTag> ()
+        ;
+        return tid;
+    }
+    virtual TypeId GetInstanceTypeId (void) const { return GetTypeId (); }
+    virtual uint32_t GetSerializedSize (void) const { return sizeof (uint64_t); }
+    virtual void Serialize (TagBuffer buf) const { buf.WriteU64 (m_enqueueUs); }
+    virtual void Deserialize (TagBuffer buf) { m_enqueueUs = buf.ReadU64 (); }
+    virtual void Print (std::ostream& os) const { os << "enqueueUs=" << m_enqueueUs; }
+
+    uint64_t m_enqueueUs = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BottleneckTimestampTag);
+
+static void BottleneckEnqueue (Ptr<const Packet> packet)
+{
+    // The timestamp is only needed for the sojourn log below
+    if (!g_log.IsEnabled (LOG_INFO)) {
+        return;
+    }
+    BottleneckTimestampTag tag;
+    tag.m_enqueueUs = Simulator::Now ().GetMicroSeconds ();
+    packet->AddPacketTag (tag);
+}
+
+static void BottleneckLogSojourn (const std::string& name, Ptr<Packet> packet)
+{
+    // Removing the tag also makes sure a packet requeued by a queue disc
+    // (and thus dequeued again later on) is only logged on its first dequeue
+    BottleneckTimestampTag tag;
+    if (!packet->RemovePacketTag (tag)) {
+        return;
+    }
+    const auto nowUs = Simulator::Now ().GetMicroSeconds ();
+    NS_LOG_INFO ("queue_log: " << name
+                 << " ts: " << nowUs / 1000
+                 << " size: " << packet->GetSize ()
+                 << " sojourn: " << static_cast<double> (nowUs - tag.m_enqueueUs) / 1000.); // in ms
+}
+
+static void BottleneckDequeue (const std::string& name, Ptr<const Packet> packet)
+{
+    BottleneckLogSojourn (name, ConstCast<Packet> (packet));
+}
+
+static void BottleneckQueueDiscEnqueue (Ptr<const QueueItem> item)
+{
+    BottleneckEnqueue (item->GetPacket ());
+}
+
+static void BottleneckQueueDiscDequeue (const std::string& name, Ptr<const QueueItem> item)
+{
+    BottleneckLogSojourn (name, item->GetPacket ());
+}
+
 WiredTopo::WiredTopo ()
 : m_numApps{0},
+  m_leftSystemId{0},
+  m_rightSystemId{0},
+  m_hostPoolSize{0},
+  m_bottleneckQueueType{BOTTLENECK_QUEUE_DROPTAIL},
+  m_bottleneckTrace{},
+  m_numSubnets{0},
+  m_numPoolFlows{0},
+  m_hostPool{},
+  m_usedPorts{},
   m_bufSize{0}
-{}
+{
+    m_inetStackHlpr.SetRoutingHelper (GetStaticRoutingHelper ());
+}
 
 WiredTopo::~WiredTopo ()
 {}
 
+void WiredTopo::SetPartition (uint32_t leftSystemId, uint32_t rightSystemId)
+{
+    // Nodes get their system id when created
+    NS_ASSERT (m_bottleneckNodes.GetN () == 0);
+    m_leftSystemId = leftSystemId;
+    m_rightSystemId = rightSystemId;
+}
+
+void WiredTopo::SetHostPool (uint32_t nHosts)
+{
+    NS_ASSERT (m_bottleneckNodes.GetN () == 0);
+    m_hostPoolSize = nHosts;
+}
+
+void WiredTopo::SetBottleneckQueue (BottleneckQueueType type)
+{
+    NS_ASSERT (m_bottleneckNodes.GetN () == 0);
+    m_bottleneckQueueType = type;
+}
+
+void WiredTopo::SetBottleneckTrace (const std::string& traceFile)
+{
+    NS_ASSERT (m_bottleneckNodes.GetN () == 0);
+    m_bottleneckTrace = traceFile;
+}
+
 void WiredTopo::Build (uint64_t bandwidthBps, uint32_t msDelay, uint32_t msQDelay)
 {
-    // Set up bottleneck link
-    m_bottleneckNodes.Create (2);
+    // Set up bottleneck link. If the two sides are simulated by different
+    // ranks, the helper creates a remote channel for it
+    m_bottleneckNodes.Create (1, m_leftSystemId);
+    m_bottleneckNodes.Create (1, m_rightSystemId);
     PointToPointHelper bottleneckLinkHlpr;
     bottleneckLinkHlpr.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (bandwidthBps)));
 
@@ -50,19 +160,53 @@ void WiredTopo::Build (uint64_t bandwidthBps, uint32_t msDelay, uint32_t msQDela
     // At least one full packet with default size must fit
     NS_ASSERT (m_bufSize >= DEFAULT_PACKET_SIZE + IPV4_UDP_OVERHEAD);
 
-    bottleneckLinkHlpr.SetQueue ("ns3::DropTailQueue",
-                                 "Mode", StringValue ("QUEUE_MODE_BYTES"),
-                                 "MaxBytes", UintegerValue (m_bufSize));
+    switch (m_bottleneckQueueType) {
+        case BOTTLENECK_QUEUE_DROPTAIL:
+            bottleneckLinkHlpr.SetQueue ("ns3::DropTailQueue",
+                                         "Mode", StringValue ("QUEUE_MODE_BYTES"),
+                                         "MaxBytes", UintegerValue (m_bufSize));
+            break;
+        case BOTTLENECK_QUEUE_ECN_STEP:
+            bottleneckLinkHlpr.SetQueue ("ns3::EcnMarkingQueue",
+                                         "Mode", StringValue ("QUEUE_MODE_BYTES"),
+                                         "MaxBytes", UintegerValue (m_bufSize));
+            break;
+        default:
+            // The queue disc holds the queue. A bigger device queue would
+            // add unmanaged delay on top of it
+            bottleneckLinkHlpr.SetQueue ("ns3::DropTailQueue",
+                                         "Mode", StringValue ("QUEUE_MODE_PACKETS"),
+                                         "MaxPackets", UintegerValue (1));
+            break;
+    }
 
     m_bottleneckDevices = bottleneckLinkHlpr.Install (m_bottleneckNodes);
 
+    if (!m_bottleneckTrace.empty ()) {
+        // The trace alone determines the forward capacity; the queue
+        // builds up in the trace-driven queue disc
+        NS_ASSERT (m_bottleneckQueueType == BOTTLENECK_QUEUE_DROPTAIL);
+        auto fwdDevice = m_bottleneckDevices.Get (0);
+        fwdDevice->SetAttribute ("DataRate", DataRateValue (DataRate (1u << 30))); // 1 Gbps
+        auto fwdQueue = DynamicCast<PointToPointNetDevice> (fwdDevice)->GetQueue ();
+        fwdQueue->SetAttribute ("Mode", StringValue ("QUEUE_MODE_PACKETS"));
+        fwdQueue->SetAttribute ("MaxPackets", UintegerValue (1));
+    }
+
     //Uncomment the line below to ease troubleshooting
     //bottleneckLinkHlpr.EnablePcapAll ("rmcat-wired-capture", true);
 
     m_inetStackHlpr.Install (m_bottleneckNodes);
     Ipv4AddressHelper address;
     address.SetBase ("12.0.1.0", "255.255.255.0");
-    address.Assign (m_bottleneckDevices);
+    auto interfaces = address.Assign (m_bottleneckDevices);
+
+    // Left subnets are 10.0.0.0/8, right subnets are 11.0.0.0/8.
+    // Access subnets are directly connected to A (resp. B)
+    AddStaticRoute (m_bottleneckNodes.Get (0), m_bottleneckDevices.Get (0),
+                    Ipv4Address ("11.0.0.0"), Ipv4Mask ("255.0.0.0"), interfaces.GetAddress (1));
+    AddStaticRoute (m_bottleneckNodes.Get (1), m_bottleneckDevices.Get (1),
+                    Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), interfaces.GetAddress (0));
 
     // Set up helpers for applications
     NS_ASSERT (m_numApps == 0);
@@ -77,13 +221,77 @@ void WiredTopo::Build (uint64_t bandwidthBps, uint32_t msDelay, uint32_t msQDela
                             "Mode", StringValue ("QUEUE_MODE_BYTES"),
                             "MaxBytes", UintegerValue (m_bufSize));
 
-    // Disable tc now, some bug in ns3 causes extra delay
+    // Remove the default queue disc installed along with the IP addresses:
+    // with a full-sized device queue, its buffer adds extra delay. Queue
+    // management schemes get a queue disc of their own
     TrafficControlHelper tch;
     tch.Uninstall (m_bottleneckDevices);
+    InstallBottleneckQueueDisc ();
+    TraceBottleneckSojourn ();
 
     Packet::EnablePrinting ();
 }
 
+void WiredTopo::InstallBottleneckQueueDisc ()
+{
+    m_bottleneckQueueDiscs.assign (m_bottleneckDevices.GetN (), Ptr<QueueDisc> ());
+    TrafficControlHelper tch;
+    if (!m_bottleneckTrace.empty ()) {
+        tch.SetRootQueueDisc ("ns3::TraceLinkQueueDisc",
+                              "TraceFile", StringValue (m_bottleneckTrace),
+                              "MaxBytes", UintegerValue (m_bufSize));
+        m_bottleneckQueueDiscs[0] = tch.Install (m_bottleneckDevices.Get (0)).Get (0);
+        return;
+    }
+
+    switch (m_bottleneckQueueType) {
+        case BOTTLENECK_QUEUE_CODEL:
+            tch.SetRootQueueDisc ("ns3::CoDelQueueDisc",
+                                  "Mode", StringValue ("QUEUE_MODE_BYTES"),
+                                  "MaxBytes", UintegerValue (m_bufSize));
+            break;
+        case BOTTLENECK_QUEUE_FQCODEL: {
+            // FQ-CoDel's limit is in packets
+            const auto maxPackets = std::max (m_bufSize / (DEFAULT_PACKET_SIZE + IPV4_UDP_OVERHEAD), 1u);
+            const auto handle = tch.SetRootQueueDisc ("ns3::FqCoDelQueueDisc",
+                                                      "PacketLimit", UintegerValue (maxPackets));
+            tch.AddPacketFilter (handle, "ns3::FqCoDelIpv4PacketFilter");
+            break;
+        }
+        case BOTTLENECK_QUEUE_PIE:
+            tch.SetRootQueueDisc ("ns3::PieQueueDisc",
+                                  "Mode", StringValue ("QUEUE_MODE_BYTES"),
+                                  "QueueLimit", UintegerValue (m_bufSize));
+            break;
+        default:
+            // The device queue is the bottleneck queue
+            return;
+    }
+    const auto qdiscs = tch.Install (m_bottleneckDevices);
+    for (uint32_t i = 0; i < qdiscs.GetN (); ++i) {
+        m_bottleneckQueueDiscs[i] = qdiscs.Get (i);
+    }
+}
+
+void WiredTopo::TraceBottleneckSojourn ()
+{
+    NS_ASSERT (m_bottleneckDevices.GetN () == 2);
+    const std::string names[] = { "bottleneck_fwd", "bottleneck_bwd" };
+    for (uint32_t i = 0; i < 2; ++i) {
+        auto qdisc = m_bottleneckQueueDiscs[i];
+        if (qdisc) {
+            qdisc->TraceConnectWithoutContext ("Enqueue", MakeCallback (&BottleneckQueueDiscEnqueue));
+            qdisc->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&BottleneckQueueDiscDequeue, names[i]));
+        } else {
+            auto device = DynamicCast<PointToPointNetDevice> (m_bottleneckDevices.Get (i));
+            NS_ASSERT (device);
+            auto queue = device->GetQueue ();
+            queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&BottleneckEnqueue));
+            queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&BottleneckDequeue, names[i]));
+        }
+    }
+}
+
 ApplicationContainer WiredTopo::InstallTCP (const std::string& flowId,
                                             uint16_t serverPort,
                                             bool newNode)
@@ -91,6 +299,7 @@ ApplicationContainer WiredTopo::InstallTCP (const std::string& flowId,
     auto appNodes = SetupAppNodes (0, newNode);
     auto sender = appNodes.Get (0);
     auto receiver = appNodes.Get (1);
+    ReservePort (receiver, serverPort);
 
     return Topo::InstallTCP (flowId, sender, receiver, serverPort);
 }
@@ -109,6 +318,7 @@ ApplicationContainer WiredTopo::InstallCBR (uint16_t serverPort,
     if (forward) {
         std::swap (sender, receiver);
     }
+    ReservePort (receiver, serverPort);
 
     return Topo::InstallCBR (sender,
                              receiver,
@@ -130,6 +340,7 @@ ApplicationContainer WiredTopo::InstallRMCAT (const std::string& ccontroller,
     if (forward) {
         std::swap (sender, receiver);
     }
+    ReservePort (receiver, serverPort);
 
     return Topo::InstallRMCAT (ccontroller,
                                flowId,
@@ -156,11 +367,15 @@ void WiredTopo::SetupAppNode (Ptr<Node> node, int bottleneckIdx, uint32_t pDelay
     }
     Ipv4AddressHelper address;
     std::ostringstream stringStream;
-    const unsigned x = (m_numApps + 1) / 256;
-    const unsigned y = (m_numApps + 1) % 256;
+    const unsigned x = m_numSubnets / 256;
+    const unsigned y = m_numSubnets % 256;
     stringStream << (10 + bottleneckIdx) << "." << x << "." << y << ".0";
     address.SetBase (stringStream.str ().c_str (), "255.255.255.0");
-    address.Assign (devices);
+    auto interfaces = address.Assign (devices);
+
+    // The access router is the host's only way out
+    AddStaticRoute (node, devices.Get (0), Ipv4Address::GetAny (), Ipv4Mask::GetZero (),
+                    interfaces.GetAddress (1));
 
     TrafficControlHelper tch;
     tch.Uninstall (devices);
@@ -173,20 +388,45 @@ void WiredTopo::SetupAppNode (Ptr<Node> node, int bottleneckIdx, uint32_t pDelay
     //}
 }
 
+NodeContainer WiredTopo::CreateAppNodes (uint32_t pDelayMs)
+{
+    NodeContainer appNodes;
+    appNodes.Create (1, m_leftSystemId);
+    appNodes.Create (1, m_rightSystemId);
+    m_inetStackHlpr.Install (appNodes);
+    ++m_numSubnets;
+    NS_ASSERT (m_numSubnets < 256 * 256);
+    SetupAppNode (appNodes.Get (0), 0, pDelayMs);
+    SetupAppNode (appNodes.Get (1), 1, 0);
+    return appNodes;
+}
+
 NodeContainer WiredTopo::SetupAppNodes (uint32_t pDelayMs, bool newNode)
 {
     if (newNode) {
-        NodeContainer appNodes;
-        appNodes.Create (2);
-        m_inetStackHlpr.Install (appNodes);
-        SetupAppNode (appNodes.Get (0), 0, pDelayMs);
-        SetupAppNode (appNodes.Get (1), 1, 0);
+        if (m_hostPoolSize > 0 && pDelayMs == 0) {
+            // The pool is filled up as flows are added, then reused
+            const auto idx = m_numPoolFlows++ % m_hostPoolSize;
+            if (idx == m_hostPool.size ()) {
+                m_hostPool.push_back (CreateAppNodes (0));
+            }
+            m_appNodes = m_hostPool[idx];
+        } else {
+            m_appNodes = CreateAppNodes (pDelayMs);
+        }
         ++m_numApps;
-        m_appNodes = appNodes;
     }
     // The first time we set up a flow, newNode must be true
     NS_ASSERT (m_numApps > 0);
     return m_appNodes;
 }
 
+void WiredTopo::ReservePort (Ptr<Node> node, uint16_t port)
+{
+    auto& ports = m_usedPorts[node->GetId ()];
+    NS_ASSERT_MSG (ports.count (port) == 0,
+                   "Port " << port << " already in use at node " << node->GetId ());
+    ports.insert (port);
+}
+
 }
@@ -29,6 +29,9 @@
 #define WIRED_TOPO_H
 
 #include "topo.h"
+#include <vector>
+#include <map>
+#include <set>
 
 namespace ns3 {
 
@@ -50,6 +53,28 @@ namespace ns3 {
  * | ln +-----------+                  +-----------+ rn |
  * +----+                                          +----+
  * where n = 256 * x + y
+ *
+ * The topology can be partitioned for a distributed simulation (see
+ * #SetPartition): the left nodes and A, and the right nodes and B, then
+ * belong to different ranks. The bottleneck link A-B is the only link
+ * crossing the partition, so its propagation delay is the lookahead.
+ *
+ * By default, every flow gets its own pair of nodes li, ri. For scenarios
+ * with many flows, a fixed pool of host pairs can be used instead (see
+ * #SetHostPool): flows are then spread over the pool in round-robin
+ * fashion.
+ *
+ * All nodes use static routing: hosts have a default route to their access
+ * router, and A (resp. B) routes 11.0.0.0/8 (resp. 10.0.0.0/8) over the
+ * bottleneck. Routes are installed as nodes are created, so there is no
+ * need to populate global routing tables.
+ *
+ * The bottleneck queue is drop-tail by default; it can perform ECN
+ * marking or active queue management instead (see #SetBottleneckQueue).
+ * The forward capacity can also follow a delivery trace (see
+ * #SetBottleneckTrace).
+ * The sojourn time of every packet in the bottleneck queue is logged
+ * (component "WiredTopo", level info).
  */
 
 class WiredTopo: public Topo
@@ -61,6 +86,64 @@ public:
     /** Class destructor */
     virtual ~WiredTopo ();
 
+    /**
+     * Assign the nodes on each side of the bottleneck to a different logical
+     * process (rank) of ns-3's distributed simulator. Must be called before
+     * #Build . This has no effect on a regular (non-distributed) simulation.
+     *
+     * The helpers from this class only attach applications to nodes owned
+     * by the local rank (see Topo::IsLocalNode), so that the same scenario
+     * description can be run unmodified by every rank
+     *
+     * @param [in] leftSystemId Rank simulating node A and the left nodes
+     * @param [in] rightSystemId Rank simulating node B and the right nodes
+     */
+    void SetPartition (uint32_t leftSystemId, uint32_t rightSystemId);
+
+    /**
+     * Multiplex flows over a fixed pool of (left-right) host pairs, rather
+     * than creating a new node pair, with its own links, internet stack and
+     * subnets, for every flow. Must be called before #Build .
+     *
+     * Several flows share each host, so each flow must use a server port
+     * not yet used by another flow on the same host (typically, one port
+     * range per traffic type, as in the test cases); this is asserted.
+     * Flows requesting a custom propagation delay still get a dedicated
+     * node pair.
+     *
+     * @param [in] nHosts Number of host pairs in the pool, 0 to disable
+     */
+    void SetHostPool (uint32_t nHosts);
+
+    /**
+     * Choose the type of queue at the bottleneck link. Must be called
+     * before #Build . With #BOTTLENECK_QUEUE_ECN_STEP , ECN-capable packets
+     * are marked CE when their sojourn time exceeds a shallow threshold
+     * (see #EcnMarkingQueue).
+     *
+     * #BOTTLENECK_QUEUE_CODEL , #BOTTLENECK_QUEUE_FQCODEL and
+     * #BOTTLENECK_QUEUE_PIE install the corresponding queue disc on the
+     * bottleneck devices; their device queues are then shrunk to a single
+     * packet, so that the queue builds up in the queue disc, where it is
+     * managed. The queue's capacity is the same in all cases.
+     *
+     * @param [in] type Bottleneck queue type, drop-tail by default
+     */
+    void SetBottleneckQueue (BottleneckQueueType type);
+
+    /**
+     * Make the forward direction of the bottleneck link trace-driven:
+     * packets are served at the delivery opportunities listed in a
+     * Mahimahi-format trace (see #TraceLinkQueueDisc), rather than at
+     * the link's fixed rate. Must be called before #Build , and cannot
+     * be combined with #SetBottleneckQueue . The bottleneck bandwidth
+     * passed to #Build then only sizes the queue (and sets the backward
+     * direction's rate).
+     *
+     * @param [in] traceFile Path to the delivery trace, empty to disable
+     */
+    void SetBottleneckTrace (const std::string& traceFile);
+
     /**
      * Build the wired rmcat topology with the attributes passed
      *
@@ -134,15 +217,29 @@ public:
                                        bool forward);
 
 private:
-    void SetupAppNode (Ptr<Node> node, int subnet, uint32_t pDelayMs);
+    void SetupAppNode (Ptr<Node> node, int bottleneckIdx, uint32_t pDelayMs);
     NodeContainer SetupAppNodes (uint32_t pDelayMs, bool newNode);
+    NodeContainer CreateAppNodes (uint32_t pDelayMs);
+    void ReservePort (Ptr<Node> node, uint16_t port);
+    void InstallBottleneckQueueDisc ();
+    void TraceBottleneckSojourn ();
 
 protected:
     unsigned m_numApps;
+    uint32_t m_leftSystemId;
+    uint32_t m_rightSystemId;
+    uint32_t m_hostPoolSize;
+    BottleneckQueueType m_bottleneckQueueType;
+    std::string m_bottleneckTrace;
+    unsigned m_numSubnets;   // Access subnets created on each side
+    unsigned m_numPoolFlows; // Flows placed on the host pool so far
+    std::vector<NodeContainer> m_hostPool;
+    std::map<uint32_t, std::set<uint16_t> > m_usedPorts; // Per node id
     uint32_t m_bufSize;
     NodeContainer m_bottleneckNodes;
     NodeContainer m_appNodes; // Last application node pair created
     NetDeviceContainer m_bottleneckDevices;
+    std::vector<Ptr<QueueDisc> > m_bottleneckQueueDiscs; // Per bottleneck device, null if none
     InternetStackHelper m_inetStackHlpr;
     PointToPointHelper m_appLinkHlpr;
 };
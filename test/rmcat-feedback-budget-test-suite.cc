@@ -0,0 +1,171 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+
+/**
+ * @file
+ * Tests for feedback periods adapted to a media-rate budget.
+ *
+ * @version 0.1.1
+ */
+
+#include "ns3/rmcat-sender.h"
+#include "ns3/rmcat-ccfs-receiver.h"
+#include "ns3/ccfs-controller.h"
+#include "ns3/ccfs-params-profile.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/*
+ * A CCFS flow at a fixed rate over an uncongested link, with a feedback
+ * budget. The average feedback period must be the one the budget yields
+ * for the media rate and packet rate seen at the receiver
+ */
+class CcfsFeedbackBudgetTestCase : public TestCase
+{
+public:
+    CcfsFeedbackBudgetTestCase ();
+    virtual void DoRun ();
+
+private:
+    void OnMediaRx (Ptr<const Packet> packet);
+    void OnFeedbackRx (Ptr<const Packet> packet);
+    bool IsMeasuring () const;
+
+    uint64_t m_mediaBytes;
+    uint32_t m_mediaPackets;
+    uint32_t m_feedbackPackets;
+};
+
+const double FB_TEST_BUDGET = 0.01;
+const float FB_TEST_RATE_BPS = 800 * 1000;
+const uint32_t FB_TEST_MEASURE_START_S = 5;
+const uint32_t FB_TEST_MEASURE_END_S = 25;
+const uint32_t FB_TEST_HEADER_SIZE = 2 + 20 + 8; // PPP, IPv4, UDP
+
+CcfsFeedbackBudgetTestCase::CcfsFeedbackBudgetTestCase ()
+: TestCase{"ccfs-feedback-budget"}
+, m_mediaBytes{0}
+, m_mediaPackets{0}
+, m_feedbackPackets{0}
+{}
+
+bool CcfsFeedbackBudgetTestCase::IsMeasuring () const
+{
+    const auto now = Simulator::Now ();
+    return now >= Seconds (FB_TEST_MEASURE_START_S) && now < Seconds (FB_TEST_MEASURE_END_S);
+}
+
+void CcfsFeedbackBudgetTestCase::OnMediaRx (Ptr<const Packet> packet)
+{
+    if (IsMeasuring ()) {
+        // The receiver accounts for RTP packets, headers included
+        m_mediaBytes += packet->GetSize () - FB_TEST_HEADER_SIZE;
+        ++m_mediaPackets;
+    }
+}
+
+void CcfsFeedbackBudgetTestCase::OnFeedbackRx (Ptr<const Packet> packet)
+{
+    if (IsMeasuring ()) {
+        ++m_feedbackPackets;
+    }
+}
+
+void CcfsFeedbackBudgetTestCase::DoRun ()
+{
+    NodeContainer nodes;
+    nodes.Create (2);
+    PointToPointHelper link;
+    link.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+    link.SetChannelAttribute ("Delay", StringValue ("25ms"));
+    auto devices = link.Install (nodes);
+    InternetStackHelper internet;
+    internet.Install (nodes);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.1.1.0", "255.255.255.0");
+    auto interfaces = address.Assign (devices);
+
+    const uint16_t port = 8000;
+    auto ccfs = std::make_shared<rmcat::CcfsController> ();
+    ccfs->setParams (CreateObject<CcfsParamsProfile> ()->GetParams ());
+    auto sender = CreateObject<RmcatSender> ();
+    nodes.Get (0)->AddApplication (sender);
+    sender->SetController (ccfs);
+    sender->SetControllerName ("CCFS");
+    sender->Setup (interfaces.GetAddress (1), port);
+    // Fixed rate: the feedback budget depends on it
+    sender->SetRinit (FB_TEST_RATE_BPS);
+    sender->SetRmin (FB_TEST_RATE_BPS);
+    sender->SetRmax (FB_TEST_RATE_BPS);
+    sender->SetStartTime (Seconds (0));
+    sender->SetStopTime (Seconds (FB_TEST_MEASURE_END_S));
+
+    auto receiver = CreateObject<RmcatCcfsReceiver> ();
+    nodes.Get (1)->AddApplication (receiver);
+    receiver->Setup (port);
+    receiver->SetFeedbackBudget (FB_TEST_BUDGET);
+    receiver->SetStartTime (Seconds (0));
+    receiver->SetStopTime (Seconds (FB_TEST_MEASURE_END_S));
+
+    devices.Get (1)->TraceConnectWithoutContext ("MacRx",
+        MakeCallback (&CcfsFeedbackBudgetTestCase::OnMediaRx, this));
+    devices.Get (0)->TraceConnectWithoutContext ("MacRx",
+        MakeCallback (&CcfsFeedbackBudgetTestCase::OnFeedbackRx, this));
+
+    Simulator::Stop (Seconds (FB_TEST_MEASURE_END_S));
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    NS_TEST_ASSERT_MSG_GT (m_mediaPackets, 0u, "no media received");
+    NS_TEST_ASSERT_MSG_GT (m_feedbackPackets, 0u, "no feedback received");
+
+    // Same computation as RmcatReceiver::GetFeedbackPeriodUs
+    const double durationS = FB_TEST_MEASURE_END_S - FB_TEST_MEASURE_START_S;
+    const double mediaBps = double (m_mediaBytes) * 8. / durationS;
+    const double packetRate = double (m_mediaPackets) / durationS;
+    const double budgetBps = FB_TEST_BUDGET * mediaBps - 8. * RMCAT_FB_METRIC_SIZE * packetRate;
+    NS_TEST_ASSERT_MSG_GT (budgetBps, 0., "budget too small for the media packet rate");
+    double expectedS = 8. * RMCAT_RFB_OVERHEAD_SIZE / budgetBps;
+    expectedS = std::max (expectedS, double (RMCAT_FEEDBACK_MIN_PERIOD_US) / 1e6);
+    expectedS = std::min (expectedS, double (RMCAT_FEEDBACK_MAX_PERIOD_US) / 1e6);
+
+    const double periodS = durationS / double (m_feedbackPackets);
+    NS_TEST_ASSERT_MSG_EQ_TOL (periodS, expectedS, expectedS * 0.2,
+                               "feedback period does not match the budget");
+}
+
+class RmcatFeedbackBudgetTestSuite : public TestSuite
+{
+public:
+    RmcatFeedbackBudgetTestSuite ();
+};
+
+RmcatFeedbackBudgetTestSuite::RmcatFeedbackBudgetTestSuite ()
+: TestSuite{"rmcat-feedback-budget", SYSTEM}
+{
+    AddTestCase (new CcfsFeedbackBudgetTestCase{}, TestCase::QUICK);
+}
+
+static RmcatFeedbackBudgetTestSuite rmcatFeedbackBudgetTestSuite;
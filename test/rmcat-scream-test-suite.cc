@@ -0,0 +1,127 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+
+/**
+ * @file
+ * Unit tests for the SCReAM window-based congestion controller.
+ *
+ * @version 0.1.1
+ */
+
+#include "ns3/scream-controller.h"
+#include "ns3/test.h"
+#include <deque>
+
+using namespace ns3;
+
+static void DiscardControllerLog (const std::string& msg)
+{}
+
+/*
+ * A flow with a fixed one-way delay of 25 ms and feedback on every packet,
+ * where all feedback is lost between 2 s and 4 s. The window fills up and
+ * holds the sender back, until the controller gives up on the packets in
+ * flight. Once feedback is back, the sender must go back to sending every
+ * packet the source produces
+ */
+class ScreamFeedbackLossTestCase : public TestCase
+{
+public:
+    ScreamFeedbackLossTestCase ();
+    virtual void DoRun ();
+};
+
+ScreamFeedbackLossTestCase::ScreamFeedbackLossTestCase ()
+: TestCase{"scream-feedback-loss"}
+{}
+
+void ScreamFeedbackLossTestCase::DoRun ()
+{
+    const uint64_t owdUs = 25 * 1000;
+    const uint64_t packetIntervalUs = 10 * 1000;
+    const uint32_t packetSize = 1000;
+    const uint64_t lossStartUs = 2000 * 1000;
+    const uint64_t lossEndUs = 4000 * 1000;
+    const uint64_t endUs = 6000 * 1000;
+
+    rmcat::ScreamController controller{};
+    controller.reset ();
+    controller.setLogCallback (DiscardControllerLog);
+
+    struct Feedback {
+        uint64_t arrivalUs;
+        uint16_t sequence;
+        uint64_t rxTimestampUs;
+    };
+    std::deque<Feedback> feedback{};
+    uint16_t sequence = 0;
+    uint32_t sentWhileBlocked = 0;  // between 2.1 s and 2.4 s
+    uint32_t sentDuringLoss = 0;    // between 2.6 s and 4 s
+    uint32_t sentAfterLoss = 0;     // between 5 s and 6 s
+
+    for (uint64_t nowUs = 0; nowUs < endUs; nowUs += 1000) {
+        while (!feedback.empty () && feedback.front ().arrivalUs <= nowUs) {
+            const auto item = feedback.front ();
+            feedback.pop_front ();
+            if (item.arrivalUs >= lossStartUs && item.arrivalUs < lossEndUs) {
+                continue;
+            }
+            const bool res = controller.processFeedback (nowUs, item.sequence,
+                                                         item.rxTimestampUs);
+            NS_TEST_ASSERT_MSG_EQ (res, true, "feedback should be accepted");
+        }
+
+        if (nowUs % packetIntervalUs != 0 || !controller.canSendPacket (nowUs, packetSize)) {
+            continue;
+        }
+        const bool res = controller.processSendPacket (nowUs, sequence, packetSize);
+        NS_TEST_ASSERT_MSG_EQ (res, true, "packet should be accepted");
+        const Feedback item = { nowUs + 2 * owdUs, sequence, nowUs + owdUs };
+        feedback.push_back (item);
+        ++sequence;
+
+        if (nowUs >= 2100 * 1000 && nowUs < 2400 * 1000) {
+            ++sentWhileBlocked;
+        } else if (nowUs >= 2600 * 1000 && nowUs < lossEndUs) {
+            ++sentDuringLoss;
+        } else if (nowUs >= 5000 * 1000) {
+            ++sentAfterLoss;
+        }
+    }
+
+    NS_TEST_ASSERT_MSG_EQ (sentWhileBlocked, 0u,
+                           "a full window should hold the sender back");
+    NS_TEST_ASSERT_MSG_GT (sentDuringLoss, 0u,
+                           "the packets in flight should be given up on");
+    NS_TEST_ASSERT_MSG_EQ (sentAfterLoss, 100u,
+                           "the sender should recover once feedback is back");
+}
+
+class RmcatScreamTestSuite : public TestSuite
+{
+public:
+    RmcatScreamTestSuite ();
+};
+
+RmcatScreamTestSuite::RmcatScreamTestSuite ()
+: TestSuite{"rmcat-scream", UNIT}
+{
+    AddTestCase (new ScreamFeedbackLossTestCase{}, TestCase::QUICK);
+}
+
+static RmcatScreamTestSuite rmcatScreamTestSuite;
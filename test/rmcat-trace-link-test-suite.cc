@@ -0,0 +1,121 @@
+/******************************************************************************
+ * Copyright 2016-2017 Cisco Systems, Inc.                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ *                                                                            *
+ * You may obtain a copy of the License at                                    *
+ *                                                                            *
+ *     http://www.apache.org/licenses/LICENSE-2.0                             *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ ******************************************************************************/
+
+/**
+ * @file
+ * Unit tests for the delivery trace behind the trace-driven bottleneck.
+ *
+ * @version 0.1.1
+ */
+
+#include "ns3/trace-link-queue-disc.h"
+#include "ns3/test.h"
+#include <fstream>
+
+using namespace ns3;
+
+/*
+ * Walks delivery-trace-fixture.txt, which has blank and malformed lines,
+ * over two repetitions of the trace
+ */
+class DeliveryTraceFixtureTestCase : public TestCase
+{
+public:
+    DeliveryTraceFixtureTestCase ();
+    virtual void DoRun ();
+};
+
+DeliveryTraceFixtureTestCase::DeliveryTraceFixtureTestCase ()
+: TestCase{"delivery-trace-fixture"}
+{}
+
+void DeliveryTraceFixtureTestCase::DoRun ()
+{
+    SetDataDir (NS_TEST_SOURCEDIR);
+    DeliveryTrace trace{};
+    const bool res = trace.Open (CreateDataDirFilename ("delivery-trace-fixture.txt"));
+    NS_TEST_ASSERT_MSG_EQ (res, true, "fixture trace should open");
+
+    // The trace repeats with a period of 20 ms, its last timestamp
+    const uint64_t expectedMs[] = { 0, 0, 5, 12, 20,
+                                    20, 20, 25, 32, 40,
+                                    40, 40 };
+    for (const auto expected : expectedMs) {
+        NS_TEST_ASSERT_MSG_EQ (trace.Next (), expected, "wrong delivery opportunity");
+    }
+}
+
+/*
+ * Traces that must be rejected: no file, an empty file, no valid line,
+ * and a last timestamp of 0 (no period to repeat with)
+ */
+class DeliveryTraceInvalidTestCase : public TestCase
+{
+public:
+    DeliveryTraceInvalidTestCase ();
+    virtual void DoRun ();
+
+private:
+    bool OpenTrace (const std::string& name, const std::string& contents);
+};
+
+DeliveryTraceInvalidTestCase::DeliveryTraceInvalidTestCase ()
+: TestCase{"delivery-trace-invalid"}
+{}
+
+bool DeliveryTraceInvalidTestCase::OpenTrace (const std::string& name, const std::string& contents)
+{
+    const auto path = CreateTempDirFilename (name);
+    std::ofstream file{path.c_str ()};
+    file << contents;
+    file.close ();
+    DeliveryTrace trace{};
+    return trace.Open (path);
+}
+
+void DeliveryTraceInvalidTestCase::DoRun ()
+{
+    DeliveryTrace trace{};
+    NS_TEST_ASSERT_MSG_EQ (trace.Open (CreateTempDirFilename ("missing.txt")), false,
+                           "missing trace should be rejected");
+    NS_TEST_ASSERT_MSG_EQ (OpenTrace ("empty.txt", ""), false,
+                           "empty trace should be rejected");
+    NS_TEST_ASSERT_MSG_EQ (OpenTrace ("blank.txt", "\n \n"), false,
+                           "blank trace should be rejected");
+    NS_TEST_ASSERT_MSG_EQ (OpenTrace ("malformed.txt", "abc\ndef"), false,
+                           "trace without timestamps should be rejected");
+    NS_TEST_ASSERT_MSG_EQ (OpenTrace ("zero.txt", "0\n0\n"), false,
+                           "trace with no period should be rejected");
+    // No newline at the end of the file
+    NS_TEST_ASSERT_MSG_EQ (OpenTrace ("nonewline.txt", "3\n7"), true,
+                           "trace without final newline should open");
+}
+
+class RmcatTraceLinkTestSuite : public TestSuite
+{
+public:
+    RmcatTraceLinkTestSuite ();
+};
+
+RmcatTraceLinkTestSuite::RmcatTraceLinkTestSuite ()
+: TestSuite{"rmcat-trace-link", UNIT}
+{
+    AddTestCase (new DeliveryTraceFixtureTestCase{}, TestCase::QUICK);
+    AddTestCase (new DeliveryTraceInvalidTestCase{}, TestCase::QUICK);
+}
+
+static RmcatTraceLinkTestSuite rmcatTraceLinkTestSuite;
@@ -71,6 +71,8 @@ RmcatWifiTestCase::RmcatWifiTestCase (uint64_t capacity, // wired link capacity
 , m_simTime{RMCAT_TC_SIMTIME}
 , m_codecType{SYNCODEC_TYPE_FIXFPS}
 , m_phyMode{WifiMode ("HtMcs11")}
+, m_nack{false}
+, m_fec{false}
 {}
 
 
@@ -179,6 +181,14 @@ void RmcatWifiTestCase::SetUpRMCAT (std::vector<Ptr<RmcatSender> >& send,
         send[i]->SetRmax (RMCAT_TC_RMAX);
         send[i]->SetStartTime (Seconds (0));
         send[i]->SetStopTime (Seconds (m_simTime-1));
+        if (m_nack) {
+            send[i]->SetRtxEnabled (true);
+            auto recv = DynamicCast<RmcatReceiver> (rmcatApps.Get (1));
+            recv->SetNackEnabled (true);
+        }
+        if (m_fec) {
+            send[i]->SetFecEnabled (true);
+        }
     }
 
     // configure start/end times for downlink flows
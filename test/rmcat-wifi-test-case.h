@@ -90,6 +90,12 @@ public:
     void SetPHYMode (ns3::WifiMode phyMode) {m_phyMode = phyMode; };
     void SetCBRRate (uint64_t rCBR) { m_rCBR = rCBR; };
 
+    /* recover RMCAT packet losses via NACK-based retransmissions */
+    void SetNack (bool enable) { m_nack = enable; };
+
+    /* protect RMCAT flows with adaptive XOR parity packets */
+    void SetFec (bool enable) { m_fec = enable; };
+
     /* configure RMCAT flows and
      * their arrival/departure patterns
      */
@@ -161,6 +167,8 @@ private:
 
     SyncodecType m_codecType; // traffic source type
     ns3::WifiMode m_phyMode;  // PHY mode for wireless connections
+    bool m_nack;              // NACK-based retransmissions for RMCAT flows
+    bool m_fec;               // forward error correction for RMCAT flows
 
 };
 
@@ -283,6 +283,32 @@ RmcatWifiTestSuite:: RmcatWifiTestSuite (const std::string &testname, const std:
     tc42d->SetUDPFlows (0, t0s, t0s, true);
     tc42d->SetUDPFlows (nCBR, tstartCBRTC42, tstopCBRTC42, false);
 
+    // Same as 4.2.d, recovering losses with NACK-based retransmissions
+    std::stringstream dnss;
+    dnss << "rmcat-wifi-test-case-4.2.d-n" << nRMCAT*2 << "-nack";
+    RmcatWifiTestCase * tc42dnack = new RmcatWifiTestCase{bw, pdel, qdel, dnss.str (), ccontroller};
+    tc42dnack->SetSimTime (simT);
+    tc42dnack->SetPHYMode (phyMode);
+    tc42dnack->SetCBRRate (rCBR);
+    tc42dnack->SetRMCATFlows (nRMCAT, t0s, t0s, true);
+    tc42dnack->SetRMCATFlows (nRMCAT, t0s, t0s, false);
+    tc42dnack->SetUDPFlows (0, t0s, t0s, true);
+    tc42dnack->SetUDPFlows (nCBR, tstartCBRTC42, tstopCBRTC42, false);
+    tc42dnack->SetNack (true);
+
+    // Same as 4.2.d, recovering losses with parity packets
+    std::stringstream dfss;
+    dfss << "rmcat-wifi-test-case-4.2.d-n" << nRMCAT*2 << "-fec";
+    RmcatWifiTestCase * tc42dfec = new RmcatWifiTestCase{bw, pdel, qdel, dfss.str (), ccontroller};
+    tc42dfec->SetSimTime (simT);
+    tc42dfec->SetPHYMode (phyMode);
+    tc42dfec->SetCBRRate (rCBR);
+    tc42dfec->SetRMCATFlows (nRMCAT, t0s, t0s, true);
+    tc42dfec->SetRMCATFlows (nRMCAT, t0s, t0s, false);
+    tc42dfec->SetUDPFlows (0, t0s, t0s, true);
+    tc42dfec->SetUDPFlows (nCBR, tstartCBRTC42, tstopCBRTC42, false);
+    tc42dfec->SetFec (true);
+
     // -----------------------
     // Test Case 4.2.f: Wireless Bottleneck;
     //     Multiple bi-directional RMCAT flows
@@ -314,6 +340,8 @@ RmcatWifiTestSuite:: RmcatWifiTestSuite (const std::string &testname, const std:
      * to test suite
      */
     AddTestCase (tc42d,TestCase::QUICK);
+    AddTestCase (tc42dnack,TestCase::QUICK);
+    AddTestCase (tc42dfec,TestCase::QUICK);
     AddTestCase (tc42e,TestCase::QUICK);
 }
 
@@ -335,5 +363,9 @@ DEFINE_RMCAT_WIFI_TEST_SUITE("rmcat-wifi-nada", NADA);
 
 DEFINE_RMCAT_WIFI_TEST_SUITE("rmcat-wifi-ccfs", CCFS);
 
+DEFINE_RMCAT_WIFI_TEST_SUITE("rmcat-wifi-gcc", GCC);
+
+DEFINE_RMCAT_WIFI_TEST_SUITE("rmcat-wifi-scream", SCREAM);
+
 
 
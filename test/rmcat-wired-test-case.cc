@@ -66,7 +66,15 @@ RmcatWiredTestCase::RmcatWiredTestCase (uint64_t capacity, // bottleneck capacit
   m_numInitOnFlows{0},
   m_simTime{RMCAT_TC_SIMTIME},
   m_pauseFid{0},
-  m_codecType{SYNCODEC_TYPE_FIXFPS}
+  m_codecType{SYNCODEC_TYPE_FIXFPS},
+  m_queueType{BOTTLENECK_QUEUE_DROPTAIL},
+  m_fseSbd{false},
+  m_probing{false},
+  m_frameGranular{false},
+  m_hdrExt{false},
+  m_fbBudget{0.},
+  m_leftSystemId{0},
+  m_rightSystemId{0}
 { }
 
 
@@ -178,8 +186,19 @@ void RmcatWiredTestCase::SetTCPShortFlows (size_t numFlows,
 void RmcatWiredTestCase::DoSetup ()
 {
     RmcatTestCase::DoSetup ();
+    m_topo.SetBottleneckQueue (m_queueType);
+    m_topo.SetPartition (m_leftSystemId, m_rightSystemId);
+    if (!m_fsePriorities.empty ()) {
+        // Coupled flows are sent by the same host
+        m_topo.SetHostPool (1);
+    }
     m_topo.Build (m_capacity, m_delay, m_qdelay);
     ns3::LogComponentEnable ("RmcatSimTestWired", LOG_LEVEL_INFO);
+    if (m_queueType != BOTTLENECK_QUEUE_DROPTAIL) {
+        // Per-packet sojourn times at the bottleneck. Only for test cases
+        // on the queue type, to keep the other logs small
+        ns3::LogComponentEnable ("WiredTopo", LOG_LEVEL_INFO);
+    }
 }
 
 /*
@@ -225,9 +244,6 @@ void RmcatWiredTestCase::DoRun ()
     SetUpPath (m_timesBw, m_capacitiesBw, false);
     SetUpRMCAT (sendBw, ptimersBw, rtimersBw, false);
 
-    /* Populate routing table */
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-
     /* Kick off simulation */
     NS_LOG_INFO ("Run Simulation.");
     Simulator::Stop (Seconds (m_simTime));
@@ -324,6 +340,15 @@ void RmcatWiredTestCase::SetUpRMCAT (std::vector<Ptr<RmcatSender> >& send,
         ss0 << "bwd_";
     }
 
+    std::shared_ptr<rmcat::FlowStateExchange> fse;
+    if (fwd && !m_fsePriorities.empty ()) {
+        NS_ASSERT (m_fsePriorities.size () == numFlows);
+        fse = std::make_shared<rmcat::FlowStateExchange> ();
+        if (m_fseSbd) {
+            fse->enableSharedBottleneckDetection ();
+        }
+    }
+
     for (size_t i = 0; i < numFlows; ++i) {
         // configure per-flow RTT
         if (fwd && m_pDelays.size () > 0) {
@@ -340,12 +365,36 @@ void RmcatWiredTestCase::SetUpRMCAT (std::vector<Ptr<RmcatSender> >& send,
                                                               fwd);               // direction indicator
 
         send[i] = DynamicCast<RmcatSender> (rmcatApps.Get (0));
+        send[i]->SetFrameGranularEnqueue (m_frameGranular);
         send[i]->SetCodecType (m_codecType);
         send[i]->SetRinit (RMCAT_TC_RINIT);
         send[i]->SetRmin (RMCAT_TC_RMIN);
         send[i]->SetRmax (RMCAT_TC_RMAX);
         send[i]->SetStartTime (Seconds (0));
         send[i]->SetStopTime (Seconds (m_simTime-1));
+        if (fse) {
+            send[i]->SetFlowStateExchange (fse, m_fsePriorities[i]);
+        }
+        send[i]->SetProbingEnabled (m_probing);
+        if (m_hdrExt) {
+            // not turned off otherwise: REMB flows need them
+            send[i]->SetHeaderExtensionsEnabled (true);
+        }
+        if (m_fbBudget > 0.) {
+            auto recv = DynamicCast<RmcatReceiver> (rmcatApps.Get (1));
+            recv->SetFeedbackBudget (m_fbBudget);
+        }
+        if (fwd && !m_layerMinRates.empty ()) {
+            NS_ASSERT (m_layerMinRates.size () == m_layerMaxRates.size ());
+            for (size_t l = 0; l < m_layerMinRates.size (); ++l) {
+                syncodecs::Codec* codec = new syncodecs::SimpleFpsBasedCodec{SYNCODEC_DEFAULT_FPS};
+                if (!m_frameGranular) {
+                    codec = new syncodecs::ShapedPacketizer{codec, DEFAULT_PACKET_SIZE};
+                }
+                send[i]->AddLayer (std::shared_ptr<syncodecs::Codec>{codec},
+                                   m_layerMinRates[l], m_layerMaxRates[l]);
+            }
+        }
     }
 
     /* configure start/end times for forward flows */
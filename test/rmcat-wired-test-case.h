@@ -72,8 +72,42 @@ public:
     void SetCapacity (uint64_t capacity) {m_capacity = capacity; };
     void SetSimTime (uint32_t simTime) {m_simTime = simTime; };
     void SetCodec (SyncodecType codecType) { m_codecType = codecType; };
+    void SetBottleneckQueue (BottleneckQueueType queueType) { m_queueType = queueType; };
     void SetPropDelays (const std::vector<uint32_t>& pDelays) { m_pDelays = pDelays; } ;
 
+    /* couple the forward RMCAT flows (sent from a single host) via a
+     * Flow State Exchange, with the given per-flow priorities */
+    void SetCoupledFlows (const std::vector<float>& priorities) { m_fsePriorities = priorities; };
+
+    /* group the coupled flows by shared bottleneck detection (rfc8382),
+     * rather than assuming they share the bottleneck */
+    void SetSharedBottleneckDetection (bool enable) { m_fseSbd = enable; };
+
+    /* send the probe clusters the congestion controller asks for */
+    void SetProbing (bool enable) { m_probing = enable; };
+
+    /* enqueue whole frames in one event, rather than packet by packet */
+    void SetFrameGranular (bool enable) { m_frameGranular = enable; };
+
+    /* tag RTP packets with abs-send-time and transport-wide sequence numbers */
+    void SetHeaderExtensions (bool enable) { m_hdrExt = enable; };
+
+    /* adapt the feedback period so that feedback takes this share of the media rate */
+    void SetFeedbackBudget (double rateFraction) { m_fbBudget = rateFraction; };
+
+    /* assign the left and right sides of the bottleneck to these system ids */
+    void SetPartition (uint32_t leftSystemId, uint32_t rightSystemId) {
+        m_leftSystemId = leftSystemId;
+        m_rightSystemId = rightSystemId;
+    };
+
+    /* make the forward RMCAT flows layered (simulcast) sources, with
+     * one fixed-fps codec per layer, with the given rate ranges (bps) */
+    void SetLayers (const std::vector<float>& minRates, const std::vector<float>& maxRates) {
+        m_layerMinRates = minRates;
+        m_layerMaxRates = maxRates;
+    };
+
     /* configure time-varying BW */
     void SetBW (const std::vector<uint32_t>& times,
                 const std::vector<uint64_t>& capacities,
@@ -142,6 +176,13 @@ private:
     /* per-flow one-way propagation delay (in ms) */
     std::vector<uint32_t> m_pDelays;
 
+    /* per-flow priorities of coupled forward RMCAT flows, empty if not coupled */
+    std::vector<float> m_fsePriorities;
+
+    /* per-layer rate ranges of layered forward RMCAT flows, empty if not layered */
+    std::vector<float> m_layerMinRates;
+    std::vector<float> m_layerMaxRates;
+
     /* start/end times for each RMCAT flow */
     std::vector<uint32_t> m_startTimesFw;
     std::vector<uint32_t> m_endTimesFw;
@@ -162,6 +203,14 @@ private:
     std::vector<uint32_t> m_resumeTimes;
 
     SyncodecType m_codecType;
+    BottleneckQueueType m_queueType;
+    bool m_fseSbd;
+    bool m_probing;
+    bool m_frameGranular;
+    bool m_hdrExt;
+    double m_fbBudget;
+    uint32_t m_leftSystemId;
+    uint32_t m_rightSystemId;
 
 };
 
@@ -117,6 +117,60 @@ RmcatWiredTestSuite::RmcatWiredTestSuite  (const std::string &testname, const st
     tc51g->SetBW (timeTC51, bwTC51, true); // FWD path
     tc51g->SetCodec (SYNCODEC_TYPE_HYBRID); // hybrid (trace/statistics) video source
 
+    // Same as 5.1-fixfps, probing for bandwidth rather than waiting for the codec to ramp up.
+    // Only GCC requests probe clusters, the other controllers would run 5.1-fixfps again
+    RmcatWiredTestCase * tc51probe = NULL;
+    if (ccontroller == "GCC") {
+        tc51probe = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-fixfps-probing", ccontroller};
+        tc51probe->SetSimTime (100); // simulation time: 100s
+        tc51probe->SetBW (timeTC51, bwTC51, true); // FWD path
+        tc51probe->SetProbing (true);
+    }
+
+    // Same as 5.1-fixfps, with the two sides of the bottleneck on different system ids.
+    // Without MPI this runs on the default simulator and must behave like 5.1-fixfps
+    RmcatWiredTestCase * tc51part = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-fixfps-partitioned", ccontroller};
+    tc51part->SetSimTime (100); // simulation time: 100s
+    tc51part->SetBW (timeTC51, bwTC51, true); // FWD path
+    tc51part->SetPartition (0, 1);
+
+    // Same as 5.1-fixfps, with a feedback period adapted to the media rate
+    RmcatWiredTestCase * tc51fb = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-fixfps-fbbudget", ccontroller};
+    tc51fb->SetSimTime (100); // simulation time: 100s
+    tc51fb->SetBW (timeTC51, bwTC51, true); // FWD path
+    tc51fb->SetFeedbackBudget (0.05); // 5% of the media rate
+
+    // Same as 5.1-trace, enqueuing whole frames rather than packet by packet
+    RmcatWiredTestCase * tc51frame = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-trace-framegranular", ccontroller};
+    tc51frame->SetSimTime (100); // simulation time: 100s
+    tc51frame->SetBW (timeTC51, bwTC51, true); // FWD path
+    tc51frame->SetCodec (SYNCODEC_TYPE_TRACE); // trace-based video source
+    tc51frame->SetFrameGranular (true);
+
+    // Same as 5.1-fixfps, with a three-layer simulcast source
+    std::vector<float> layerMinTC51; // in bps
+    std::vector<float> layerMaxTC51; // in bps
+    layerMinTC51.push_back (150 * (1u << 10)); layerMaxTC51.push_back (300 * (1u << 10));
+    layerMinTC51.push_back (300 * (1u << 10)); layerMaxTC51.push_back (500 * (1u << 10));
+    layerMinTC51.push_back (500 * (1u << 10)); layerMaxTC51.push_back (700 * (1u << 10));
+
+    // CCFS does not support layered sources, so it skips both simulcast test cases
+    RmcatWiredTestCase * tc51layers = NULL;
+    RmcatWiredTestCase * tc51twseq = NULL;
+    if (ccontroller != "CCFS") {
+        tc51layers = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-simulcast", ccontroller};
+        tc51layers->SetSimTime (100); // simulation time: 100s
+        tc51layers->SetBW (timeTC51, bwTC51, true); // FWD path
+        tc51layers->SetLayers (layerMinTC51, layerMaxTC51);
+
+        // Same as 5.1-simulcast, with feedback on transport-wide sequence numbers
+        tc51twseq = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.1-simulcast-twseq", ccontroller};
+        tc51twseq->SetSimTime (100); // simulation time: 100s
+        tc51twseq->SetBW (timeTC51, bwTC51, true); // FWD path
+        tc51twseq->SetLayers (layerMinTC51, layerMaxTC51);
+        tc51twseq->SetHeaderExtensions (true);
+    }
+
     // -----------------------
     // Test Case 5.2: Variable Available Capacity with Multiple Flows
     // -----------------------
@@ -169,6 +223,25 @@ RmcatWiredTestSuite::RmcatWiredTestSuite  (const std::string &testname, const st
     tc54->SetSimTime (simT); // default simulation time: 120s
     tc54->SetRMCATFlows (3, tstartTC54, tstopTC54, true);    // Forward path
 
+    // Same as TC5.4, but the three flows are sent by the same host and
+    // coupled (rfc8699), the first one with twice the priority of the others
+    std::vector<float> prioFse;
+    prioFse.push_back (2.); prioFse.push_back (1.); prioFse.push_back (1.);
+    RmcatWiredTestCase * tc54fse = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.4-fse-fixfps", ccontroller};
+    tc54fse->SetCapacity (3.5 * (1u << 20));  // bottleneck capacity: 3.5 Mbps
+    tc54fse->SetSimTime (simT); // default simulation time: 120s
+    tc54fse->SetRMCATFlows (3, tstartTC54, tstopTC54, true);    // Forward path
+    tc54fse->SetCoupledFlows (prioFse);
+
+    // Same as above, but the flows are only coupled once shared bottleneck
+    // detection (rfc8382) finds out they traverse the same bottleneck
+    RmcatWiredTestCase * tc54sbd = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-5.4-fse-sbd-fixfps", ccontroller};
+    tc54sbd->SetCapacity (3.5 * (1u << 20));  // bottleneck capacity: 3.5 Mbps
+    tc54sbd->SetSimTime (simT); // default simulation time: 120s
+    tc54sbd->SetRMCATFlows (3, tstartTC54, tstopTC54, true);    // Forward path
+    tc54sbd->SetCoupledFlows (prioFse);
+    tc54sbd->SetSharedBottleneckDetection (true);
+
     // -----------------------
     // Test Case 5.5: Round Trip Time Fairness
     // -----------------------
@@ -240,6 +313,34 @@ RmcatWiredTestSuite::RmcatWiredTestSuite  (const std::string &testname, const st
     tc58->SetRMCATFlows (3, t0s, t0s, true);  // Forward path
     tc58->SetPauseResumeTimes (fid8, tpauseTC58, tresumeTC58, true);
 
+    // -----------------------
+    // ECN: Variable Available Capacity (same as TC5.1) with an
+    // ECN-marking bottleneck instead of a drop-tail one
+    // -----------------------
+    RmcatWiredTestCase * tcEcn = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-ecn-step-fixfps", ccontroller};
+    tcEcn->SetSimTime (100); // simulation time: 100s
+    tcEcn->SetBW (timeTC51, bwTC51, true); // FWD path
+    tcEcn->SetBottleneckQueue (BOTTLENECK_QUEUE_ECN_STEP);
+
+    // -----------------------
+    // AQM: Variable Available Capacity (same as TC5.1) with
+    // the bottleneck queue managed by CoDel, FQ-CoDel or PIE
+    // -----------------------
+    RmcatWiredTestCase * tcCodel = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-aqm-codel-fixfps", ccontroller};
+    tcCodel->SetSimTime (100); // simulation time: 100s
+    tcCodel->SetBW (timeTC51, bwTC51, true); // FWD path
+    tcCodel->SetBottleneckQueue (BOTTLENECK_QUEUE_CODEL);
+
+    RmcatWiredTestCase * tcFqCodel = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-aqm-fqcodel-fixfps", ccontroller};
+    tcFqCodel->SetSimTime (100); // simulation time: 100s
+    tcFqCodel->SetBW (timeTC51, bwTC51, true); // FWD path
+    tcFqCodel->SetBottleneckQueue (BOTTLENECK_QUEUE_FQCODEL);
+
+    RmcatWiredTestCase * tcPie = new RmcatWiredTestCase{bw, pdel, qdel, "rmcat-test-case-aqm-pie-fixfps", ccontroller};
+    tcPie->SetSimTime (100); // simulation time: 100s
+    tcPie->SetBW (timeTC51, bwTC51, true); // FWD path
+    tcPie->SetBottleneckQueue (BOTTLENECK_QUEUE_PIE);
+
     // -------------------------------
     // Add test cases to test suite
     // -------------------------------
@@ -251,15 +352,32 @@ RmcatWiredTestSuite::RmcatWiredTestSuite  (const std::string &testname, const st
     AddTestCase (tc51e, TestCase::QUICK);
     AddTestCase (tc51f, TestCase::QUICK);
     AddTestCase (tc51g, TestCase::QUICK);
+    if (tc51probe) {
+        AddTestCase (tc51probe, TestCase::QUICK);
+    }
+    AddTestCase (tc51part, TestCase::QUICK);
+    AddTestCase (tc51fb, TestCase::QUICK);
+    AddTestCase (tc51frame, TestCase::QUICK);
+    if (tc51layers) {
+        AddTestCase (tc51layers, TestCase::QUICK);
+        AddTestCase (tc51twseq, TestCase::QUICK);
+    }
 
     AddTestCase (tc52, TestCase::QUICK);
 
     AddTestCase (tc53, TestCase::QUICK);
     AddTestCase (tc54, TestCase::QUICK);
+    AddTestCase (tc54fse, TestCase::QUICK);
+    AddTestCase (tc54sbd, TestCase::QUICK);
     AddTestCase (tc55, TestCase::QUICK);
     AddTestCase (tc56, TestCase::QUICK);
     AddTestCase (tc57, TestCase::QUICK);
     AddTestCase (tc58, TestCase::QUICK);
+
+    AddTestCase (tcEcn, TestCase::QUICK);
+    AddTestCase (tcCodel, TestCase::QUICK);
+    AddTestCase (tcFqCodel, TestCase::QUICK);
+    AddTestCase (tcPie, TestCase::QUICK);
 }
 
 
@@ -280,3 +398,9 @@ DEFINE_RMCAT_WIRED_TEST_SUITE("rmcat-wired-nada", NADA);
 
 DEFINE_RMCAT_WIRED_TEST_SUITE("rmcat-wired-ccfs", CCFS);
 
+DEFINE_RMCAT_WIRED_TEST_SUITE("rmcat-wired-gcc", GCC);
+
+DEFINE_RMCAT_WIRED_TEST_SUITE("rmcat-wired-scream", SCREAM);
+
+DEFINE_RMCAT_WIRED_TEST_SUITE("rmcat-wired-remb", REMB);
+
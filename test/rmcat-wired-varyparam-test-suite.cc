@@ -133,3 +133,7 @@ DEFINE_RMCAT_VPARAM_TEST_SUITE("rmcat-vparam-nada", NADA);
 
 DEFINE_RMCAT_VPARAM_TEST_SUITE("rmcat-vparam-ccfs", CCFS);
 
+DEFINE_RMCAT_VPARAM_TEST_SUITE("rmcat-vparam-gcc", GCC);
+
+DEFINE_RMCAT_VPARAM_TEST_SUITE("rmcat-vparam-scream", SCREAM);
+